@@ -0,0 +1,456 @@
+// Giophantus benchmark suite: field, ring and scheme operations for every parameter set
+//
+// giophantus_bench [--json] [--filter SUBSTRING] [--min-time SECONDS]
+//
+// Each benchmark is calibrated until one timed run lasts at least --min-time (0.2 s by default);
+// the best of three runs is reported as ns/op, TSC cycles/op and ops/sec.
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <x86intrin.h>
+#define GIOPHANTUS_HAVE_RDTSC 1
+#endif
+
+#include "giophantus/giophantus.h"
+
+using namespace giophantus;
+
+namespace {
+
+// Keeps the compiler from discarding a computed value
+template <class T>
+void keep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Coroutine started eagerly and never awaited
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::abort(); }
+    };
+};
+
+std::uint64_t read_cycles() {
+#ifdef GIOPHANTUS_HAVE_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct Options {
+    bool json = false;
+    std::string filter;
+    double min_time = 0.2;
+};
+
+struct Result {
+    std::string name;
+    std::string params;
+    std::uint64_t iterations;
+    double ns_per_op;
+    double cycles_per_op;
+    double ops_per_sec;
+};
+
+// body(iterations) runs the operation iterations times; ops_per_iteration > 1 for batch
+// benchmarks, whose figures are then per message
+class Harness {
+public:
+    explicit Harness(const Options& options) : options(options) {}
+
+    void run(const std::string& name, const std::string& params, std::size_t ops_per_iteration,
+             const std::function<void(std::uint64_t)>& body) {
+        const std::string full = name + "/" + params;
+        if (!options.filter.empty() && full.find(options.filter) == std::string::npos) {
+            return;
+        }
+
+        body(1); // warm caches, arenas and lazily built tables
+        std::uint64_t iterations = 1;
+        double seconds = 0;
+        while (true) {
+            seconds = time(body, iterations).first;
+            if (seconds >= options.min_time || iterations >= (std::uint64_t{1} << 40)) {
+                break;
+            }
+            const double scale = seconds > 0 ? 1.4 * options.min_time / seconds : 100.0;
+            iterations = static_cast<std::uint64_t>(static_cast<double>(iterations) * std::min(std::max(scale, 2.0), 100.0));
+        }
+
+        double best_seconds = seconds;
+        std::uint64_t best_cycles = ~std::uint64_t{0};
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            const auto [s, c] = time(body, iterations);
+            best_seconds = std::min(best_seconds, s);
+            best_cycles = std::min(best_cycles, c);
+        }
+
+        const double ops = static_cast<double>(iterations * ops_per_iteration);
+        Result r{name, params, iterations, best_seconds * 1e9 / ops, static_cast<double>(best_cycles) / ops, ops / best_seconds};
+        if (!options.json) {
+            std::printf("%-28s %-10s %14.1f ns/op %14.1f cycles/op %14.0f ops/s\n", r.name.c_str(), r.params.c_str(),
+                        r.ns_per_op, r.cycles_per_op, r.ops_per_sec);
+            std::fflush(stdout);
+        }
+        results.push_back(r);
+    }
+
+    void print_json() const {
+        char date[32];
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        std::printf("{\n  \"context\": {\n");
+        std::printf("    \"date\": \"%s\",\n", date);
+        std::printf("    \"simd_backend\": \"%s\",\n", simd::kernels().name);
+        std::printf("    \"aes_ni\": %s,\n", csprng::aes_ni_available() ? "true" : "false");
+        std::printf("    \"constant_time\": %s,\n", CONSTANT_TIME ? "true" : "false");
+        std::printf("    \"instrumented\": %s,\n", INSTRUMENT ? "true" : "false");
+        std::printf("    \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+        std::printf("    \"cycles\": \"%s\"\n", read_cycles() != 0 ? "tsc" : "unavailable");
+        std::printf("  },\n  \"benchmarks\": [\n");
+        for (std::size_t k = 0; k < results.size(); ++k) {
+            const Result& r = results[k];
+            std::printf("    {\"name\": \"%s\", \"params\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, "
+                        "\"cycles_per_op\": %.3f, \"ops_per_sec\": %.3f}%s\n",
+                        r.name.c_str(), r.params.c_str(), static_cast<unsigned long long>(r.iterations), r.ns_per_op,
+                        r.cycles_per_op, r.ops_per_sec, k + 1 < results.size() ? "," : "");
+        }
+        std::printf("  ]\n}\n");
+    }
+
+private:
+    const Options& options;
+    std::vector<Result> results;
+
+    static std::pair<double, std::uint64_t> time(const std::function<void(std::uint64_t)>& body, std::uint64_t iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::uint64_t c0 = read_cycles();
+        body(iterations);
+        const std::uint64_t c1 = read_cycles();
+        const auto stop = std::chrono::steady_clock::now();
+        return {std::chrono::duration<double>(stop - start).count(), c1 - c0};
+    }
+};
+
+// Field operations over a block of residues, reported per element
+template <Fq Q>
+void bench_field(Harness& h, const std::string& params) {
+    using Field = FieldArithmetic<Q>;
+    constexpr std::size_t COUNT = 1024;
+    std::vector<Fq> a(COUNT), b(COUNT), c(COUNT);
+    RandomPolynomialGenerator rng(1);
+    std::vector<std::uint8_t> bytes(4 * COUNT);
+    rng.random_bytes(bytes.data(), bytes.size());
+    for (std::size_t i = 0; i < COUNT; ++i) {
+        std::uint32_t x;
+        std::memcpy(&x, &bytes[4 * i], 4);
+        a[i] = Field::mod(x);
+        b[i] = Field::mod(x * 2654435761u);
+    }
+
+    h.run("field_add", params, COUNT, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            for (std::size_t i = 0; i < COUNT; ++i) {
+                c[i] = Field::add(a[i], b[i]);
+            }
+            keep(c[0]);
+        }
+    });
+    h.run("field_mul", params, COUNT, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            for (std::size_t i = 0; i < COUNT; ++i) {
+                c[i] = Field::mul(a[i], b[i]);
+            }
+            keep(c[0]);
+        }
+    });
+}
+
+template <class Ring>
+void bench_ring_mul(Harness& h, const std::string& name, const std::string& params) {
+    RandomPolynomialGenerator rng(2);
+    const Ring a = rng.uniform<Ring>();
+    const Ring b = rng.uniform<Ring>();
+    Ring c;
+    h.run(name, params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            Ring::mul_into(c, a, b);
+            keep(c[0]);
+        }
+    });
+}
+
+template <class Params>
+void bench_params(Harness& h, const std::string& params) {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+    constexpr std::size_t N = Params::N;
+    constexpr Fq Q = Params::Q;
+    constexpr std::size_t BATCH = 64;
+
+    RandomPolynomialGenerator rng(3);
+    const Ring a = rng.uniform<Ring>();
+    const Ring b = rng.uniform<Ring>();
+    Ring c;
+
+    h.run("ring_add", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            Ring::add_into(c, a, b);
+            keep(c[0]);
+        }
+    });
+    bench_ring_mul<Rq<N, Q, MulBackend::Schoolbook>>(h, "ring_mul/schoolbook", params);
+    bench_ring_mul<Rq<N, Q, MulBackend::Ntt>>(h, "ring_mul/ntt", params);
+    const SparseRq<Ring> secret(rng.generate<Ring>(Params::noise_bound), Params::noise_bound);
+    h.run("ring_mul/sparse", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            SparseRq<Ring>::mul_into(c, a, secret);
+            keep(c[0]);
+        }
+    });
+    // a * b + a * d + L * e, eagerly and as one expression sharing the transform of a
+    const Ring d = rng.uniform<Ring>();
+    const Ring e = rng.generate<Ring>(Params::noise_bound);
+    h.run("ring_expr/eager", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            Ring scaled = e;
+            scaled *= Params::noise_bound;
+            c = a * b + a * d + scaled;
+            keep(c[0]);
+        }
+    });
+    h.run("ring_expr/fused", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            compute_into(c, lazy(a) * b + lazy(a) * d + Params::noise_bound * lazy(e));
+            keep(c[0]);
+        }
+    });
+    h.run("sample_uniform", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            rng.fill(c, Q);
+            keep(c[0]);
+        }
+    });
+
+    h.run("keygen", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            auto key = GiophantusKeyGen::generate<Params>(rng);
+            keep(key.X[0][0]);
+        }
+    });
+    h.run("keygen/unchecked", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            auto key = GiophantusKeyGen::generate_unchecked<Params>(rng);
+            keep(key.X[0][0]);
+        }
+    });
+
+    const auto key = GiophantusKeyGen::generate<Params>(rng);
+    const EncryptionContext<Params> context(key.X);
+    std::vector<Ring> messages(BATCH);
+    for (Ring& m : messages) {
+        rng.fill(m, Params::noise_bound);
+    }
+    std::vector<Ciphertext> ciphertexts(BATCH);
+    std::vector<Ring> decrypted(BATCH);
+
+    h.run("encrypt", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            context.encrypt_many(std::span<const Ring>(messages.data(), 1), std::span<Ciphertext>(ciphertexts.data(), 1), rng);
+            keep(ciphertexts[0][0][0]);
+        }
+    });
+    h.run("decrypt", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            GiophantusCipher::decrypt_into(decrypted[0], key, ciphertexts[0]);
+            keep(decrypted[0][0]);
+        }
+    });
+    // c(ux, uy), the dense Horner path of CONSTANT_TIME decryption
+    const Ring ux = key.ux.ring(), uy = key.uy.ring();
+    h.run("evaluate/horner", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            ciphertexts[0].evaluate_into(decrypted[0], ux, uy);
+            keep(decrypted[0][0]);
+        }
+    });
+    std::vector<Fq> points(BATCH), values(BATCH);
+    for (std::size_t k = 0; k < BATCH; ++k) {
+        points[k] = messages[0][k % Params::N] + static_cast<Fq>(k);
+    }
+    h.run("evaluate_many/points", params, BATCH, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            ux.evaluate_many(points, values);
+            keep(values[0]);
+        }
+    });
+    const DecryptionContext<Params> decryption(key);
+    h.run("decrypt/context", params, 1, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            decryption.decrypt_into(decrypted[0], ciphertexts[0]);
+            keep(decrypted[0][0]);
+        }
+    });
+    h.run("encrypt_many", params, BATCH, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            context.encrypt_many(messages, ciphertexts, rng);
+            keep(ciphertexts[0][0][0]);
+        }
+    });
+
+    ThreadPool& pool = ThreadPool::shared();
+    h.run("keygen_many/pool", params, BATCH, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            auto keys = GiophantusKeyGen::generate_many<Params>(BATCH, pool);
+            keep(keys[0].X[0][0]);
+        }
+    });
+    h.run("encrypt_many/pool", params, BATCH, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            context.encrypt_many(messages, ciphertexts, pool);
+            keep(ciphertexts[0][0][0]);
+        }
+    });
+    h.run("decrypt_many/pool", params, BATCH, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            GiophantusCipher::decrypt_many<Params>(key, ciphertexts, decrypted, pool);
+            keep(decrypted[0][0]);
+        }
+    });
+
+    // BATCH concurrent awaits, resumed on the workers; they batch as the pool falls behind
+    AsyncEncryptor<Params> async_encryptor(key.X, pool);
+    h.run("async_encrypt/pool", params, BATCH, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            std::atomic<std::size_t> finished{0};
+            const auto request = [&](std::size_t k) -> DetachedTask {
+                ciphertexts[k] = co_await async_encrypt(async_encryptor, messages[k]);
+                finished.fetch_add(1, std::memory_order_release);
+            };
+            for (std::size_t k = 0; k < BATCH; ++k) {
+                request(k);
+            }
+            while (finished.load(std::memory_order_acquire) < BATCH) {
+                std::this_thread::yield();
+            }
+            keep(ciphertexts[0][0][0]);
+        }
+    });
+
+    GpuEncryptionContext<Params> gpu(key.X, BATCH);
+    if (gpu.on_device()) {
+        h.run("encrypt_many/gpu", params, BATCH, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it < n; ++it) {
+                gpu.encrypt_many(messages, ciphertexts, rng);
+                keep(ciphertexts[0][0][0]);
+            }
+        });
+    }
+}
+
+// Hybrid streams through the chunk pipeline, per MiB of payload
+template <class Params>
+void bench_stream(Harness& h, const std::string& params) {
+    RandomPolynomialGenerator rng(7);
+    const auto key = GiophantusKeyGen::generate<Params>(rng);
+    constexpr std::size_t STREAM_MIB = 8;
+    std::vector<std::uint8_t> pk(GiophantusPke<Params>::PUBLIC_KEY_BYTES), sk(GiophantusPke<Params>::SECRET_KEY_BYTES);
+    ByteCodec::encode(pk.data(), key.X);
+    ByteCodec::encode(sk.data(), key);
+    std::vector<std::uint8_t> payload(STREAM_MIB << 20), sealed, opened;
+    rng.random_bytes(payload.data(), payload.size());
+    auto reader = [](const std::vector<std::uint8_t>& bytes, std::size_t& position) -> StreamReader {
+        return [&bytes, &position](std::uint8_t* out, std::size_t capacity, std::size_t& length) {
+            length = std::min(capacity, bytes.size() - position);
+            std::memcpy(out, bytes.data() + position, length);
+            position += length;
+            return true;
+        };
+    };
+    auto writer = [](std::vector<std::uint8_t>& bytes) -> StreamWriter {
+        return [&bytes](const std::uint8_t* data, std::size_t length) {
+            bytes.insert(bytes.end(), data, data + length);
+            return true;
+        };
+    };
+    h.run("stream_seal/MiB", params, STREAM_MIB, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            std::size_t position = 0;
+            sealed.clear();
+            HybridStream<Params>::encrypt(pk.data(), reader(payload, position), writer(sealed), rng);
+            keep(sealed.back());
+        }
+    });
+    h.run("stream_open/MiB", params, STREAM_MIB, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it < n; ++it) {
+            std::size_t position = 0;
+            opened.clear();
+            HybridStream<Params>::decrypt(sk.data(), reader(sealed, position), writer(opened));
+            keep(opened.back());
+        }
+    });
+}
+
+int usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [--json] [--filter SUBSTRING] [--min-time SECONDS]\n", program);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options.min_time = std::atof(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    Harness h(options);
+    bench_field<MODULO>(h, "q=17");
+    bench_field<0x7fffffffu>(h, "q=2^31-1");
+
+    bench_ring_mul<Rq<257, 65521, MulBackend::Schoolbook>>(h, "ring_mul/schoolbook", "257/65521");
+    bench_ring_mul<Rq<257, 65521, MulBackend::Ntt>>(h, "ring_mul/ntt", "257/65521");
+
+    bench_params<Param128>(h, "param128");
+    bench_params<Param192>(h, "param192");
+    bench_params<Param256>(h, "param256");
+    bench_params<IEC602>(h, "IEC602");
+    bench_params<IEC868>(h, "IEC868");
+    bench_params<IEC1134>(h, "IEC1134");
+    bench_stream<IEC602>(h, "IEC602");
+    bench_stream<IEC1134>(h, "IEC1134");
+
+    if (options.json) {
+        h.print_json();
+    }
+    return 0;
+}
@@ -0,0 +1,258 @@
+// dudect-style timing leak test for secret-key operations
+//
+// giophantus_dudect [--target NAME] [--measurements N] [--threshold T]
+//
+// Every measurement times one operation under either a fixed secret (class 0: ux = uy = 0, or
+// zero operands) or a freshly drawn one (class 1), the class picked at random. Welch's t-test
+// compares the two timing distributions, raw and cropped at several upper percentiles as in
+// dudect (Reparaz, Balasch, Verbauwhede, 2017). |t| above the threshold (4.5 by default) fails.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <x86intrin.h>
+#define GIOPHANTUS_HAVE_RDTSC 1
+#endif
+
+#include "giophantus/giophantus.h"
+
+using namespace giophantus;
+
+namespace {
+
+std::uint64_t read_cycles() {
+#ifdef GIOPHANTUS_HAVE_RDTSC
+    _mm_lfence();
+    const std::uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Online mean and variance (Welford) of the two classes
+class WelchTest {
+public:
+    void push(double x, int cls) {
+        n[cls] += 1;
+        const double delta = x - mean[cls];
+        mean[cls] += delta / n[cls];
+        m2[cls] += delta * (x - mean[cls]);
+    }
+
+    double t() const {
+        if (n[0] < 2 || n[1] < 2) {
+            return 0;
+        }
+        const double v0 = m2[0] / (n[0] - 1);
+        const double v1 = m2[1] / (n[1] - 1);
+        const double denominator = std::sqrt(v0 / n[0] + v1 / n[1]);
+        return denominator > 0 ? (mean[0] - mean[1]) / denominator : 0;
+    }
+
+    double count() const {
+        return n[0] + n[1];
+    }
+
+private:
+    double n[2] = {};
+    double mean[2] = {};
+    double m2[2] = {};
+};
+
+// One target: prepare(cls, slot) sets up the input of a measurement outside the timed region,
+// run(slot) is the timed operation
+struct Target {
+    std::string name;
+    std::function<void(int, std::size_t)> prepare;
+    std::function<void(std::size_t)> run;
+};
+
+constexpr std::size_t SLOTS = 8;
+
+template <class Params>
+Target decrypt_target(const std::string& name, bool context) {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+
+    struct State {
+        RandomPolynomialGenerator rng{1};
+        std::vector<GiophantusKey<Params>> keys = std::vector<GiophantusKey<Params>>(SLOTS);
+        std::vector<DecryptionContext<Params>> contexts;
+        std::vector<Ciphertext> ciphertexts = std::vector<Ciphertext>(SLOTS);
+        std::vector<std::size_t> cipher_of = std::vector<std::size_t>(SLOTS);
+        Ring out;
+    };
+    auto state = std::make_shared<State>();
+    for (Ciphertext& c : state->ciphertexts) {
+        c = state->rng.template generate_terms<Ciphertext>(Params::Q);
+    }
+    for (std::size_t k = 0; k < SLOTS; ++k) {
+        state->contexts.emplace_back(state->keys[k]);
+    }
+
+    // Class 0 keeps the all-zero secret; class 1 draws a new one. The ciphertext is random in both.
+    auto prepare = [state, context](int cls, std::size_t slot) {
+        GiophantusKey<Params>& key = state->keys[slot];
+        if (cls == 0) {
+            key.ux = typename Params::Secret();
+            key.uy = typename Params::Secret();
+        } else {
+            key.ux = typename Params::Secret(state->rng.template generate<Ring>(Params::noise_bound));
+            key.uy = typename Params::Secret(state->rng.template generate<Ring>(Params::noise_bound));
+        }
+        if (context) {
+            state->contexts[slot] = DecryptionContext<Params>(key);
+        }
+        std::uint8_t pick;
+        state->rng.random_bytes(&pick, 1);
+        state->cipher_of[slot] = pick % SLOTS;
+    };
+    auto run = [state, context](std::size_t slot) {
+        const Ciphertext& c = state->ciphertexts[state->cipher_of[slot]];
+        if (context) {
+            state->contexts[slot].decrypt_into(state->out, c);
+        } else {
+            GiophantusCipher::decrypt_into(state->out, state->keys[slot], c);
+        }
+    };
+    return {name, prepare, run};
+}
+
+// Field multiplications over a block of operands that are all zero (class 0) or random (class 1)
+template <Fq Q>
+Target field_target(const std::string& name) {
+    using Field = FieldArithmetic<Q>;
+    constexpr std::size_t COUNT = 256;
+
+    struct State {
+        RandomPolynomialGenerator rng{2};
+        std::vector<Fq> a = std::vector<Fq>(SLOTS * COUNT), b = std::vector<Fq>(SLOTS * COUNT);
+        volatile Fq sink = 0;
+    };
+    auto state = std::make_shared<State>();
+    auto prepare = [state](int cls, std::size_t slot) {
+        std::uint8_t bytes[4 * COUNT];
+        state->rng.random_bytes(bytes, sizeof(bytes));
+        for (std::size_t i = 0; i < COUNT; ++i) {
+            std::uint32_t x;
+            std::memcpy(&x, bytes + 4 * i, 4);
+            state->a[slot * COUNT + i] = cls == 0 ? 0 : Field::mod(x);
+            state->b[slot * COUNT + i] = Field::mod(x * 2654435761u);
+        }
+    };
+    auto run = [state](std::size_t slot) {
+        Fq acc = 0;
+        for (std::size_t i = 0; i < COUNT; ++i) {
+            acc = Field::add(acc, Field::mul(state->a[slot * COUNT + i], state->b[slot * COUNT + i]));
+        }
+        state->sink = acc;
+    };
+    return {name, prepare, run};
+}
+
+int usage(const char* program, const std::vector<Target>& targets) {
+    std::fprintf(stderr, "usage: %s [--target NAME] [--measurements N] [--threshold T]\ntargets:", program);
+    for (const Target& t : targets) {
+        std::fprintf(stderr, " %s", t.name.c_str());
+    }
+    std::fprintf(stderr, "\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<Target> targets;
+    targets.push_back(decrypt_target<IEC602>("decrypt/context/IEC602", true));
+    targets.push_back(decrypt_target<IEC602>("decrypt/IEC602", false));
+    targets.push_back(decrypt_target<Param128>("decrypt/param128", false));
+    targets.push_back(field_target<0x7fffffffu>("field_mul/q=2^31-1"));
+    targets.push_back(field_target<65521>("field_mul/q=65521"));
+
+    std::string selected = "decrypt/context/IEC602";
+    std::size_t measurements = 20000;
+    double threshold = 4.5;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            selected = argv[++i];
+        } else if (std::strcmp(argv[i], "--measurements") == 0 && i + 1 < argc) {
+            measurements = static_cast<std::size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::atof(argv[++i]);
+        } else {
+            return usage(argv[0], targets);
+        }
+    }
+    const auto target = std::find_if(targets.begin(), targets.end(), [&](const Target& t) { return t.name == selected; });
+    if (target == targets.end() || measurements < 2 * SLOTS) {
+        return usage(argv[0], targets);
+    }
+
+    // Measurements go in batches of SLOTS: inputs are prepared first, then timed back to back
+    RandomPolynomialGenerator coin(3);
+    auto batch = [&](std::vector<double>& times, std::vector<int>& classes) {
+        std::uint8_t bits;
+        coin.random_bytes(&bits, 1);
+        for (std::size_t s = 0; s < SLOTS; ++s) {
+            classes[s] = bits >> s & 1;
+            target->prepare(classes[s], s);
+        }
+        for (std::size_t s = 0; s < SLOTS; ++s) {
+            const std::uint64_t start = read_cycles();
+            target->run(s);
+            times[s] = static_cast<double>(read_cycles() - start);
+        }
+    };
+
+    // A first tenth of the run warms up and fixes the crop percentiles
+    std::vector<double> times(SLOTS);
+    std::vector<int> classes(SLOTS);
+    std::vector<double> warmup;
+    while (warmup.size() < measurements / 10) {
+        batch(times, classes);
+        warmup.insert(warmup.end(), times.begin(), times.end());
+    }
+    std::sort(warmup.begin(), warmup.end());
+    constexpr int CROPS = 10;
+    std::vector<double> crop(CROPS);
+    for (int k = 0; k < CROPS; ++k) {
+        const double percentile = 1 - std::pow(0.5, 10.0 * (k + 1) / CROPS);
+        crop[k] = warmup[static_cast<std::size_t>(percentile * static_cast<double>(warmup.size() - 1))];
+    }
+
+    WelchTest raw;
+    std::vector<WelchTest> cropped(CROPS);
+    for (std::size_t done = 0; done < measurements; done += SLOTS) {
+        batch(times, classes);
+        for (std::size_t s = 0; s < SLOTS; ++s) {
+            raw.push(times[s], classes[s]);
+            for (int k = 0; k < CROPS; ++k) {
+                if (times[s] < crop[k]) {
+                    cropped[k].push(times[s], classes[s]);
+                }
+            }
+        }
+    }
+
+    double worst = std::fabs(raw.t());
+    std::printf("%-24s %10.0f measurements  raw t = %8.3f\n", target->name.c_str(), raw.count(), raw.t());
+    for (int k = 0; k < CROPS; ++k) {
+        std::printf("%-24s %10.0f measurements  crop < %.0f cycles: t = %8.3f\n", "", cropped[k].count(), crop[k], cropped[k].t());
+        worst = std::max(worst, std::fabs(cropped[k].t()));
+    }
+    const bool leak = worst > threshold;
+    std::printf("max |t| = %.3f (threshold %.1f, %s build): %s\n", worst, threshold, CONSTANT_TIME ? "constant-time" : SPARSE_SECRETS ? "sparse-secrets" : "default",
+                leak ? "timing leak suspected" : "no leak detected");
+    return leak ? 1 : 0;
+}
@@ -0,0 +1,310 @@
+// Known-answer test runner over the NIST submission vectors (PQCencryptKAT_*.rsp)
+//
+// giophantus_kat [--backend NAME|all] [FILE.rsp ...]
+//
+// Every record is replayed through the C API: the DRBG is seeded with its seed, then keypair,
+// encrypt and encrypt_open must reproduce pk, sk, c and msg byte for byte. The parameter set
+// follows from the length of the first pk. Without files the vectors extracted from
+// Giophantus.zip at configure time are used. With --backend all (the default) the run repeats
+// under every SIMD backend the CPU supports; keygen, encryption and decryption throughput is
+// reported per file and backend.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "giophantus/api.h"
+#include "giophantus/key_store.h"
+#include "giophantus/simd.h"
+
+namespace {
+
+using Keypair = int (*)(unsigned char*, unsigned char*);
+using Encrypt = int (*)(unsigned char*, unsigned long long*, const unsigned char*, unsigned long long, const unsigned char*);
+
+struct ParameterSet {
+    const char* name;
+    std::size_t public_key;
+    std::size_t secret_key;
+    std::size_t ciphertext;
+    std::size_t message;
+    Keypair keypair;
+    Encrypt encrypt;
+    Encrypt encrypt_open;
+};
+
+const ParameterSet PARAMETER_SETS[] = {
+    {"IEC602", GIOPHANTUS_IEC602_PUBLICKEYBYTES, GIOPHANTUS_IEC602_SECRETKEYBYTES, GIOPHANTUS_IEC602_BYTES,
+     GIOPHANTUS_IEC602_MESSAGEBYTES, giophantus_iec602_keypair, giophantus_iec602_encrypt, giophantus_iec602_encrypt_open},
+    {"IEC868", GIOPHANTUS_IEC868_PUBLICKEYBYTES, GIOPHANTUS_IEC868_SECRETKEYBYTES, GIOPHANTUS_IEC868_BYTES,
+     GIOPHANTUS_IEC868_MESSAGEBYTES, giophantus_iec868_keypair, giophantus_iec868_encrypt, giophantus_iec868_encrypt_open},
+    {"IEC1134", GIOPHANTUS_IEC1134_PUBLICKEYBYTES, GIOPHANTUS_IEC1134_SECRETKEYBYTES, GIOPHANTUS_IEC1134_BYTES,
+     GIOPHANTUS_IEC1134_MESSAGEBYTES, giophantus_iec1134_keypair, giophantus_iec1134_encrypt, giophantus_iec1134_encrypt_open},
+};
+
+// One response record; hex fields point into the mapped file
+struct Field {
+    const char* hex = nullptr;
+    std::size_t length = 0;
+};
+
+struct Record {
+    unsigned long long count = 0;
+    Field seed, msg, pk, sk, c;
+    unsigned long long mlen = 0, clen = 0;
+};
+
+int hex_digit(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'A' && ch <= 'F') {
+        return ch - 'A' + 10;
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    return -1;
+}
+
+// Decodes field into out; false on an odd length, a stray character or a size mismatch
+bool decode_hex(std::vector<std::uint8_t>& out, const Field& field, std::size_t expected) {
+    if (field.length != 2 * expected) {
+        return false;
+    }
+    out.resize(expected);
+    int bad = 0;
+    for (std::size_t i = 0; i < expected; ++i) {
+        const int hi = hex_digit(field.hex[2 * i]);
+        const int lo = hex_digit(field.hex[2 * i + 1]);
+        bad |= hi | lo;
+        out[i] = static_cast<std::uint8_t>(hi << 4 | lo);
+    }
+    return bad >= 0;
+}
+
+// Sequential "name = value" scanner over a mapped .rsp file. Records are separated by the next
+// "count" line; '#' lines and blank lines are skipped.
+class ResponseReader {
+public:
+    ResponseReader(const std::uint8_t* data, std::size_t size)
+        : cursor(reinterpret_cast<const char*>(data)), end(reinterpret_cast<const char*>(data) + size) {}
+
+    // Next record, or false at the end of the file
+    bool next(Record& record) {
+        record = Record();
+        bool started = false;
+        while (cursor < end) {
+            const char* line = cursor;
+            const char* eol = static_cast<const char*>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+            if (eol == nullptr) {
+                eol = end;
+            }
+            const char* stop = eol;
+            while (stop > line && (stop[-1] == '\r' || stop[-1] == ' ')) {
+                --stop;
+            }
+            const char* equals = stop > line ? static_cast<const char*>(std::memchr(line, '=', static_cast<std::size_t>(stop - line))) : nullptr;
+            if (*line == '#' || equals == nullptr) {
+                cursor = eol + (eol < end);
+                continue;
+            }
+            const char* name_end = equals;
+            while (name_end > line && name_end[-1] == ' ') {
+                --name_end;
+            }
+            const char* value = equals + 1;
+            while (value < stop && *value == ' ') {
+                ++value;
+            }
+            const std::string_view name(line, static_cast<std::size_t>(name_end - line));
+            const Field field{value, static_cast<std::size_t>(stop - value)};
+            if (name == "count") {
+                if (started) {
+                    return true;
+                }
+                started = true;
+                record.count = parse_number(field);
+            } else if (name == "seed") {
+                record.seed = field;
+            } else if (name == "mlen") {
+                record.mlen = parse_number(field);
+            } else if (name == "msg") {
+                record.msg = field;
+            } else if (name == "pk") {
+                record.pk = field;
+            } else if (name == "sk") {
+                record.sk = field;
+            } else if (name == "clen") {
+                record.clen = parse_number(field);
+            } else if (name == "c") {
+                record.c = field;
+            }
+            cursor = eol + (eol < end);
+        }
+        return started;
+    }
+
+private:
+    const char* cursor;
+    const char* end;
+
+    static unsigned long long parse_number(const Field& field) {
+        unsigned long long value = 0;
+        for (std::size_t i = 0; i < field.length && field.hex[i] >= '0' && field.hex[i] <= '9'; ++i) {
+            value = value * 10 + static_cast<unsigned long long>(field.hex[i] - '0');
+        }
+        return value;
+    }
+};
+
+struct Totals {
+    std::size_t records = 0;
+    std::size_t failures = 0;
+    double parse = 0, keygen = 0, encrypt = 0, decrypt = 0;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Replays every record of one mapped file; prints each mismatch
+Totals run_file(const char* path, const giophantus::MappedFile& file, const ParameterSet*& set) {
+    Totals totals;
+    ResponseReader reader(file.data(), file.size());
+    Record record;
+    std::vector<std::uint8_t> seed, msg, expected_pk, expected_sk, expected_c;
+    std::vector<std::uint8_t> pk, sk, c, recovered;
+
+    auto start = std::chrono::steady_clock::now();
+    while (reader.next(record)) {
+        if (set == nullptr) {
+            for (const ParameterSet& candidate : PARAMETER_SETS) {
+                if (record.pk.length == 2 * candidate.public_key) {
+                    set = &candidate;
+                }
+            }
+            if (set == nullptr) {
+                std::fprintf(stderr, "%s: count %llu: pk length matches no parameter set\n", path, record.count);
+                totals.failures += 1;
+                return totals;
+            }
+        }
+        const bool parsed = decode_hex(seed, record.seed, 48) && record.mlen == set->message &&
+                            decode_hex(msg, record.msg, set->message) && decode_hex(expected_pk, record.pk, set->public_key) &&
+                            decode_hex(expected_sk, record.sk, set->secret_key) && record.clen == set->ciphertext &&
+                            decode_hex(expected_c, record.c, set->ciphertext);
+        totals.parse += seconds_since(start);
+        totals.records += 1;
+        if (!parsed) {
+            std::fprintf(stderr, "%s: count %llu: malformed record\n", path, record.count);
+            totals.failures += 1;
+            start = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        pk.assign(set->public_key, 0);
+        sk.assign(set->secret_key, 0);
+        c.assign(set->ciphertext, 0);
+        recovered.assign(set->message, 0);
+        unsigned long long clen = 0, mlen = 0;
+
+        giophantus_randombytes_init(seed.data(), nullptr, 256);
+        start = std::chrono::steady_clock::now();
+        const bool keypair_ok = set->keypair(pk.data(), sk.data()) == GIOPHANTUS_OK;
+        totals.keygen += seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        const bool encrypt_ok = set->encrypt(c.data(), &clen, msg.data(), msg.size(), pk.data()) == GIOPHANTUS_OK;
+        totals.encrypt += seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        const bool decrypt_ok = set->encrypt_open(recovered.data(), &mlen, expected_c.data(), expected_c.size(), expected_sk.data()) == GIOPHANTUS_OK;
+        totals.decrypt += seconds_since(start);
+
+        const char* mismatch = !keypair_ok || pk != expected_pk ? "pk"
+                               : sk != expected_sk              ? "sk"
+                               : !encrypt_ok || clen != c.size() || c != expected_c ? "c"
+                               : !decrypt_ok || mlen != msg.size() || recovered != msg ? "msg"
+                                                                                        : nullptr;
+        if (mismatch != nullptr) {
+            std::fprintf(stderr, "%s: count %llu: %s differs\n", path, record.count, mismatch);
+            totals.failures += 1;
+        }
+        start = std::chrono::steady_clock::now();
+    }
+    totals.parse += seconds_since(start);
+    return totals;
+}
+
+int usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [--backend NAME|all] [FILE.rsp ...]\n", program);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string backend = "all";
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+            backend = argv[++i];
+        } else if (argv[i][0] == '-') {
+            return usage(argv[0]);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+#ifdef GIOPHANTUS_KAT_DIR
+    if (paths.empty()) {
+        paths = {GIOPHANTUS_KAT_DIR "/IEC602/PQCencryptKAT_15014.rsp", GIOPHANTUS_KAT_DIR "/IEC868/PQCencryptKAT_21664.rsp",
+                 GIOPHANTUS_KAT_DIR "/IEC1134/PQCencryptKAT_28338.rsp"};
+    }
+#endif
+    if (paths.empty()) {
+        return usage(argv[0]);
+    }
+
+    std::vector<const simd::Kernels*> backends;
+    for (simd::Backend b : {simd::Backend::Scalar, simd::Backend::Sse42, simd::Backend::Avx2, simd::Backend::Avx512, simd::Backend::Neon}) {
+        const simd::Kernels* table = simd::find(b);
+        if (table != nullptr && (backend == "all" || backend == table->name)) {
+            backends.push_back(table);
+        }
+    }
+    if (backends.empty()) {
+        std::fprintf(stderr, "backend %s is not available on this CPU\n", backend.c_str());
+        return 2;
+    }
+
+    std::size_t failures = 0;
+    for (const std::string& path : paths) {
+        giophantus::MappedFile file;
+        if (!file.open(path.c_str())) {
+            std::fprintf(stderr, "%s: cannot open\n", path.c_str());
+            failures += 1;
+            continue;
+        }
+        for (const simd::Kernels* table : backends) {
+            simd::select(table->backend);
+            const ParameterSet* set = nullptr;
+            const Totals totals = run_file(path.c_str(), file, set);
+            failures += totals.failures;
+            if (set == nullptr || totals.records == 0) {
+                std::fprintf(stderr, "%s: no records\n", path.c_str());
+                failures += totals.records == 0;
+                continue;
+            }
+            const double n = static_cast<double>(totals.records);
+            std::printf("%-8s %-8s %4zu vectors %4zu failed  parse %7.1f MB/s  keygen %8.1f/s  encrypt %8.1f/s  decrypt %8.1f/s\n",
+                        set->name, table->name, totals.records, totals.failures,
+                        static_cast<double>(file.size()) / 1e6 / std::max(totals.parse, 1e-9), n / totals.keygen,
+                        n / totals.encrypt, n / totals.decrypt);
+        }
+    }
+    std::printf("%s\n", failures == 0 ? "All known-answer tests passed." : "Known-answer tests FAILED.");
+    return failures == 0 ? 0 : 1;
+}
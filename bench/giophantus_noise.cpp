@@ -0,0 +1,284 @@
+// Decryption failure rate and noise growth over many keygen / encrypt / decrypt trials
+//
+// giophantus_noise [--params NAME|all] [--trials N] [--per-key B] [--threads T]
+//
+// Decryption reads m = w mod L off w = c(ux, uy), which is m + L * e(ux, uy) exactly as long as no
+// coefficient of it reaches q. Every key runs B trials (64 by default) through encrypt_many and
+// DecryptionContext::evaluate_into, the keys spread over a ThreadPool of T workers. The report
+// has the distribution of the coefficients of w by bit width, their mean, deviation and maximum,
+// the failures seen with a 95% upper bound on the rate (3 / n when there are none), a tail
+// estimate from a normal approximation, and the worst case (L - 1) + L * sum (s + 1) N^s
+// (L - 1)^(s + 1) over monomial degrees s <= dc: below q, a set cannot fail at all. Besides the
+// IEC sets there are candidates with a smaller q, cheaper where it saves an NTT prime; the tool
+// only speaks to correctness, not to their security.
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <numbers>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "giophantus/giophantus.h"
+
+using namespace giophantus;
+
+namespace {
+
+// For N = 1201, sums of NTT_ACCUMULATION products mod 2^22 - 3 need only two NTT primes
+using N1201Q22L2 = ParamSet<1201, 4194301u, 2, 16>;
+using N1201Q24L2 = ParamSet<1201, 16777213u, 2, 16>;
+using N1201Q27L4 = ParamSet<1201, 134217689u, 4, 16>;
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct NoiseStats {
+    std::uint64_t trials = 0;
+    std::uint64_t failures = 0;
+    std::uint64_t coefficients = 0;
+    double sum = 0;
+    double sum_squares = 0;
+    Fq max = 0;
+    // Coefficients of w by bit width
+    std::array<std::uint64_t, 33> widths{};
+    // Thread time of the three steps, summed over workers
+    double keygen_seconds = 0, encrypt_seconds = 0, decrypt_seconds = 0;
+
+    void merge(const NoiseStats& other) {
+        trials += other.trials;
+        failures += other.failures;
+        coefficients += other.coefficients;
+        sum += other.sum;
+        sum_squares += other.sum_squares;
+        max = std::max(max, other.max);
+        for (std::size_t b = 0; b < widths.size(); ++b) {
+            widths[b] += other.widths[b];
+        }
+        keygen_seconds += other.keygen_seconds;
+        encrypt_seconds += other.encrypt_seconds;
+        decrypt_seconds += other.decrypt_seconds;
+    }
+};
+
+// One key and `count` messages through it
+template <class Params>
+void run_key(std::size_t count, NoiseStats& stats) {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+    RandomPolynomialGenerator& rng = RandomPolynomialGenerator::local();
+
+    auto start = Clock::now();
+    const GiophantusKey<Params> key = GiophantusKeyGen::generate<Params>(rng);
+    const EncryptionContext<Params> encryption(key.X);
+    const DecryptionContext<Params> decryption(key);
+    stats.keygen_seconds += seconds_since(start);
+
+    std::vector<Ring> messages(count);
+    std::vector<Ciphertext> ciphertexts(count);
+    for (Ring& m : messages) {
+        rng.fill(m, Params::noise_bound);
+    }
+    start = Clock::now();
+    encryption.encrypt_many(messages, ciphertexts, rng);
+    stats.encrypt_seconds += seconds_since(start);
+
+    start = Clock::now();
+    Ring w;
+    for (std::size_t k = 0; k < count; ++k) {
+        decryption.evaluate_into(w, ciphertexts[k]);
+        bool failed = false;
+        for (std::size_t i = 0; i < Params::N; ++i) {
+            const Fq x = w[i];
+            ++stats.widths[std::bit_width(x)];
+            stats.sum += x;
+            stats.sum_squares += static_cast<double>(x) * x;
+            stats.max = std::max(stats.max, x);
+            failed |= x % Params::noise_bound != messages[k][i];
+        }
+        stats.failures += failed;
+    }
+    stats.decrypt_seconds += seconds_since(start);
+    stats.trials += count;
+    stats.coefficients += count * Params::N;
+}
+
+// Largest coefficient w can reach: m below L, and L times e(ux, uy), whose part of degree s has
+// s + 1 monomials of at most N^s (L - 1)^(s + 1) each
+template <class Params>
+double worst_case() {
+    const double n = static_cast<double>(Params::N), l = Params::noise_bound - 1.0;
+    double noise = 0;
+    for (std::size_t s = 0; s <= Params::dc; ++s) {
+        noise += static_cast<double>(s + 1) * std::pow(n, static_cast<double>(s)) * std::pow(l, static_cast<double>(s + 1));
+    }
+    return l + Params::noise_bound * noise;
+}
+
+// log2 of the probability that any of n normal coefficients of mean mu and deviation sigma
+// reaches q; erfc underflows far out, so its asymptotic expansion takes over there
+double log2_tail(double n, double mu, double sigma, double q) {
+    if (sigma <= 0) {
+        return mu >= q ? 0 : -INFINITY;
+    }
+    const double z = (q - mu) / (sigma * std::sqrt(2.0));
+    const double erfc = std::erfc(z);
+    const double log_erfc = erfc > 1e-300 || z <= 0 ? std::log(erfc) : -z * z - std::log(z * std::sqrt(std::numbers::pi));
+    return std::min(0.0, (std::log(n) + log_erfc - std::log(2.0)) / std::log(2.0));
+}
+
+struct Options {
+    std::uint64_t trials = 20000;
+    std::size_t per_key = 64;
+    std::size_t threads = 0;
+};
+
+struct Summary {
+    std::string name;
+    std::size_t primes = 0;
+    bool proven = false;
+    std::uint64_t failures = 0;
+    double failure_bound = 0;
+    double microseconds_per_trial = 0;
+};
+
+template <class Params>
+Summary analyze(const std::string& name, const Options& options, ThreadPool& pool) {
+    const std::size_t keys = static_cast<std::size_t>((options.trials + options.per_key - 1) / options.per_key);
+    std::vector<NoiseStats> per_key(keys);
+    const auto start = Clock::now();
+    pool.parallel_for(keys, [&](std::size_t k) {
+        const std::uint64_t remaining = options.trials - static_cast<std::uint64_t>(k) * options.per_key;
+        run_key<Params>(static_cast<std::size_t>(std::min<std::uint64_t>(options.per_key, remaining)), per_key[k]);
+    });
+    const double wall = seconds_since(start);
+    NoiseStats s;
+    for (const NoiseStats& k : per_key) {
+        s.merge(k);
+    }
+
+    const double q = Params::Q;
+    const double mean = s.sum / static_cast<double>(s.coefficients);
+    const double sigma = std::sqrt(std::max(0.0, s.sum_squares / static_cast<double>(s.coefficients) - mean * mean));
+    const double worst = worst_case<Params>();
+    const std::size_t primes = ntt_prime_count(Params::N, Params::Q);
+    const double n = static_cast<double>(s.trials);
+    const double rate = static_cast<double>(s.failures) / n;
+    const double bound = s.failures == 0 ? 3 / n : rate + 1.96 * std::sqrt(rate * (1 - rate) / n);
+
+    std::printf("%s: N = %zu, q = %u (2^%.2f), L = %u, %zu NTT prime%s\n", name.c_str(), Params::N, Params::Q, std::log2(q),
+                Params::noise_bound, primes, primes == 1 ? "" : "s");
+    std::printf("  %llu trials under %zu keys in %.2f s: %.0f trials/s, %.0f keys/s\n", static_cast<unsigned long long>(s.trials), keys,
+                wall, n / wall, static_cast<double>(keys) / wall);
+    std::printf("  thread time per op: keygen %.1f us, encrypt %.1f us, decrypt %.1f us\n", 1e6 * s.keygen_seconds / static_cast<double>(keys),
+                1e6 * s.encrypt_seconds / n, 1e6 * s.decrypt_seconds / n);
+    std::printf("  w = c(ux, uy): mean %.4g (2^%.2f), sigma %.4g, max %u (2^%.2f, %.3g of q)\n", mean, std::log2(std::max(mean, 1.0)), sigma,
+                s.max, std::log2(std::max<double>(s.max, 1)), s.max / q);
+    for (std::size_t b = 0; b < s.widths.size(); ++b) {
+        if (s.widths[b] != 0) {
+            char range[32];
+            if (b == 0) {
+                std::snprintf(range, sizeof(range), "0");
+            } else {
+                // b < 33, the bit widths of a 32-bit coefficient
+                std::snprintf(range, sizeof(range), "[2^%u, 2^%u)", static_cast<unsigned>(b - 1), static_cast<unsigned>(b));
+            }
+            std::printf("    %-14s %12.8f%%\n", range, 100.0 * static_cast<double>(s.widths[b]) / static_cast<double>(s.coefficients));
+        }
+    }
+    std::printf("  worst case %.4g (2^%.2f): %s\n", worst, std::log2(worst),
+                worst < q ? "below q, decryption cannot fail" : "reaches q, failures are possible");
+    std::printf("  failures %llu: rate %.3g, below %.3g at 95%%; normal tail 2^%.1f per decryption\n",
+                static_cast<unsigned long long>(s.failures), rate, bound, log2_tail(static_cast<double>(Params::N), mean, sigma, q));
+    // Keygen amortized over the trials of a key
+    const double microseconds = 1e6 * (s.keygen_seconds + s.encrypt_seconds + s.decrypt_seconds) / n;
+    return {name, primes, worst < q, s.failures, worst < q ? 0.0 : bound, microseconds};
+}
+
+struct Candidate {
+    std::string name;
+    std::function<Summary(const Options&, ThreadPool&)> run;
+};
+
+template <class Params>
+Candidate candidate(const std::string& name) {
+    return {name, [name](const Options& options, ThreadPool& pool) { return analyze<Params>(name, options, pool); }};
+}
+
+int usage(const char* program, const std::vector<Candidate>& candidates) {
+    std::fprintf(stderr, "usage: %s [--params NAME|all] [--trials N] [--per-key B] [--threads T]\nparams:", program);
+    for (const Candidate& c : candidates) {
+        std::fprintf(stderr, " %s", c.name.c_str());
+    }
+    std::fprintf(stderr, "\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<Candidate> candidates;
+    candidates.push_back(candidate<IEC602>("IEC602"));
+    candidates.push_back(candidate<IEC868>("IEC868"));
+    candidates.push_back(candidate<IEC1134>("IEC1134"));
+    candidates.push_back(candidate<N1201Q27L4>("N1201-q27-L4"));
+    candidates.push_back(candidate<N1201Q24L2>("N1201-q24-L2"));
+    candidates.push_back(candidate<N1201Q22L2>("N1201-q22-L2"));
+    candidates.push_back(candidate<Param128>("param128"));
+
+    std::string selected = "all";
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--params") == 0 && i + 1 < argc) {
+            selected = argv[++i];
+        } else if (std::strcmp(argv[i], "--trials") == 0 && i + 1 < argc) {
+            options.trials = static_cast<std::uint64_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--per-key") == 0 && i + 1 < argc) {
+            options.per_key = static_cast<std::size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<std::size_t>(std::atoll(argv[++i]));
+        } else {
+            return usage(argv[0], candidates);
+        }
+    }
+    const bool known = selected == "all" || std::any_of(candidates.begin(), candidates.end(), [&](const Candidate& c) { return c.name == selected; });
+    if (!known || options.trials == 0 || options.per_key == 0) {
+        return usage(argv[0], candidates);
+    }
+
+    ThreadPool pool(options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<Summary> summaries;
+    for (const Candidate& c : candidates) {
+        if (selected == "all" || c.name == selected) {
+            summaries.push_back(c.run(options, pool));
+            std::printf("\n");
+        }
+    }
+
+    // Cheapest first. A set that never failed but is not proven is only as good as the trial count.
+    std::sort(summaries.begin(), summaries.end(),
+              [](const Summary& a, const Summary& b) { return a.microseconds_per_trial < b.microseconds_per_trial; });
+    std::printf("%-16s %7s %14s %16s\n", "params", "primes", "us/trial", "failure rate");
+    for (const Summary& s : summaries) {
+        char rate[32];
+        if (s.proven) {
+            std::snprintf(rate, sizeof(rate), "0");
+        } else {
+            std::snprintf(rate, sizeof(rate), "< %.3g", s.failure_bound);
+        }
+        std::printf("%-16s %7zu %14.1f %16s  %s\n", s.name.c_str(), s.primes, s.microseconds_per_trial, rate,
+                    s.proven ? "proven" : s.failures == 0 ? "no failures seen" : "fails");
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+/* Stable C interface: the NIST crypto_encrypt API of the reference, once per parameter set */
+#ifndef GIOPHANTUS_API_H
+#define GIOPHANTUS_API_H
+
+#define GIOPHANTUS_ALGNAME "Giophantus"
+
+/* Byte sizes as in the reference api.h: CRYPTO_SECRETKEYBYTES, CRYPTO_PUBLICKEYBYTES, CRYPTO_BYTES.
+   Messages are exactly MESSAGEBYTES long (MLEN in parameter.h). */
+#define GIOPHANTUS_IEC602_PUBLICKEYBYTES 14412
+#define GIOPHANTUS_IEC602_SECRETKEYBYTES 15014
+#define GIOPHANTUS_IEC602_BYTES 28824
+#define GIOPHANTUS_IEC602_MESSAGEBYTES 16
+
+#define GIOPHANTUS_IEC868_PUBLICKEYBYTES 20796
+#define GIOPHANTUS_IEC868_SECRETKEYBYTES 21664
+#define GIOPHANTUS_IEC868_BYTES 41592
+#define GIOPHANTUS_IEC868_MESSAGEBYTES 24
+
+#define GIOPHANTUS_IEC1134_PUBLICKEYBYTES 27204
+#define GIOPHANTUS_IEC1134_SECRETKEYBYTES 28338
+#define GIOPHANTUS_IEC1134_BYTES 54408
+#define GIOPHANTUS_IEC1134_MESSAGEBYTES 32
+
+/* Return codes of iec.h */
+#define GIOPHANTUS_OK 0
+#define GIOPHANTUS_NG 1
+
+#if defined(_WIN32) && defined(GIOPHANTUS_SHARED)
+#ifdef GIOPHANTUS_BUILDING
+#define GIOPHANTUS_EXPORT __declspec(dllexport)
+#else
+#define GIOPHANTUS_EXPORT __declspec(dllimport)
+#endif
+#elif defined(__GNUC__) && defined(GIOPHANTUS_SHARED)
+#define GIOPHANTUS_EXPORT __attribute__((visibility("default")))
+#else
+#define GIOPHANTUS_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* randombytes() of the NIST rng.c, shared by key generation and the encryption padding of every
+   parameter set. It starts from operating system entropy; randombytes_init makes it
+   deterministic, the way the KAT generator uses it. security_strength is ignored. */
+GIOPHANTUS_EXPORT void giophantus_randombytes_init(const unsigned char* entropy_input,
+                                                   const unsigned char* personalization_string,
+                                                   int security_strength);
+GIOPHANTUS_EXPORT int giophantus_randombytes(unsigned char* x, unsigned long long xlen);
+
+#define GIOPHANTUS_DECLARE_PARAMS(name)                                                                          \
+    GIOPHANTUS_EXPORT int giophantus_##name##_keypair(unsigned char* pk, unsigned char* sk);                     \
+    GIOPHANTUS_EXPORT int giophantus_##name##_encrypt(unsigned char* c, unsigned long long* clen,                \
+                                                      const unsigned char* m, unsigned long long mlen,           \
+                                                      const unsigned char* pk);                                  \
+    GIOPHANTUS_EXPORT int giophantus_##name##_encrypt_open(unsigned char* m, unsigned long long* mlen,           \
+                                                           const unsigned char* c, unsigned long long clen,      \
+                                                           const unsigned char* sk);
+
+GIOPHANTUS_DECLARE_PARAMS(iec602)
+GIOPHANTUS_DECLARE_PARAMS(iec868)
+GIOPHANTUS_DECLARE_PARAMS(iec1134)
+
+#undef GIOPHANTUS_DECLARE_PARAMS
+
+#ifdef __cplusplus
+}
+#endif
+
+/* Drop-in replacement for one reference build: define GIOPHANTUS_NIST_API to IEC602, IEC868 or
+   IEC1134 before including this header to get the api.h and rng.h names for that set */
+#ifdef GIOPHANTUS_NIST_API
+#define GIOPHANTUS_NIST_CAT(a, b, c) a##b##c
+#define GIOPHANTUS_NIST_SIZE(set, what) GIOPHANTUS_NIST_CAT(GIOPHANTUS_, set, what)
+#define GIOPHANTUS_NIST_LOWER_IEC602 iec602
+#define GIOPHANTUS_NIST_LOWER_IEC868 iec868
+#define GIOPHANTUS_NIST_LOWER_IEC1134 iec1134
+#define GIOPHANTUS_NIST_FN2(lower, what) giophantus_##lower##what
+#define GIOPHANTUS_NIST_FN1(lower, what) GIOPHANTUS_NIST_FN2(lower, what)
+#define GIOPHANTUS_NIST_FN(set, what) GIOPHANTUS_NIST_FN1(GIOPHANTUS_NIST_CAT(GIOPHANTUS_NIST_LOWER_, set, ), what)
+
+#define CRYPTO_ALGNAME GIOPHANTUS_ALGNAME
+#define CRYPTO_PUBLICKEYBYTES GIOPHANTUS_NIST_SIZE(GIOPHANTUS_NIST_API, _PUBLICKEYBYTES)
+#define CRYPTO_SECRETKEYBYTES GIOPHANTUS_NIST_SIZE(GIOPHANTUS_NIST_API, _SECRETKEYBYTES)
+#define CRYPTO_BYTES GIOPHANTUS_NIST_SIZE(GIOPHANTUS_NIST_API, _BYTES)
+#define crypto_encrypt_keypair GIOPHANTUS_NIST_FN(GIOPHANTUS_NIST_API, _keypair)
+#define crypto_encrypt GIOPHANTUS_NIST_FN(GIOPHANTUS_NIST_API, _encrypt)
+#define crypto_encrypt_open GIOPHANTUS_NIST_FN(GIOPHANTUS_NIST_API, _encrypt_open)
+#define randombytes_init giophantus_randombytes_init
+#define randombytes giophantus_randombytes
+#endif
+
+#endif
@@ -0,0 +1,143 @@
+// Per-thread scratch arena for transform buffers and ring temporaries
+#ifndef GIOPHANTUS_ARENA_H
+#define GIOPHANTUS_ARENA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "giophantus/instrument.h"
+
+namespace giophantus {
+
+// Scratch Arena
+// Per-thread bump allocator for transform buffers and ring temporaries. Callers open an
+// ArenaScope, take what they need and get it all back when the scope closes, so after the first
+// operation has sized the arena the same sequence of calls never touches the heap again.
+class ScratchArena {
+public:
+    static constexpr std::size_t ALIGNMENT = 64;
+    static constexpr std::size_t BLOCK_BYTES = std::size_t{1} << 20;
+
+    struct Mark {
+        std::size_t block;
+        std::size_t offset;
+    };
+
+    ScratchArena() = default;
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    ~ScratchArena() {
+        for (Block& b : blocks) {
+            ::operator delete(b.base, std::align_val_t{ALIGNMENT});
+        }
+    }
+
+    static ScratchArena& local() {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+    // Heap blocks obtained by all arenas so far; constant in steady state
+    static std::size_t total_allocations() {
+        return allocation_count.load(std::memory_order_relaxed);
+    }
+
+    Mark mark() const {
+        return {current, offset};
+    }
+
+    void rewind(Mark m) {
+        current = m.block;
+        offset = m.offset;
+    }
+
+    // Makes sure an empty arena can serve bytes without growing
+    void reserve(std::size_t bytes) {
+        if (current == 0 && offset == 0 && (blocks.empty() || blocks[0].size < bytes)) {
+            replace_block(0, bytes);
+        }
+    }
+
+    // count default-initialized objects of a trivially destructible type, 64-byte aligned
+    template <class T>
+    T* allocate(std::size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena memory is released without destructors");
+        T* p = static_cast<T*>(allocate_bytes(count * sizeof(T)));
+        std::uninitialized_default_construct_n(p, count);
+        return p;
+    }
+
+private:
+    struct Block {
+        void* base;
+        std::size_t size;
+    };
+
+    std::vector<Block> blocks;
+    std::size_t current = 0;
+    std::size_t offset = 0;
+
+    static inline std::atomic<std::size_t> allocation_count{0};
+
+    void replace_block(std::size_t index, std::size_t bytes) {
+        const std::size_t size = std::max(bytes, BLOCK_BYTES);
+        void* base = ::operator new(size, std::align_val_t{ALIGNMENT});
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        instrument::count(instrument::Counter::ArenaBlocks);
+        if (index == blocks.size()) {
+            blocks.push_back({base, size});
+        } else {
+            ::operator delete(blocks[index].base, std::align_val_t{ALIGNMENT});
+            blocks[index] = {base, size};
+        }
+    }
+
+    void* allocate_bytes(std::size_t bytes) {
+        instrument::count(instrument::Counter::ArenaAllocations);
+        instrument::count(instrument::Counter::ArenaBytes, bytes);
+        bytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        if (blocks.empty()) {
+            replace_block(0, bytes);
+        }
+        if (offset + bytes > blocks[current].size) {
+            // Later blocks are only refilled while nothing of theirs is live
+            ++current;
+            offset = 0;
+            if (current == blocks.size() || blocks[current].size < bytes) {
+                replace_block(current, bytes);
+            }
+        }
+        void* p = static_cast<char*>(blocks[current].base) + offset;
+        offset += bytes;
+        return p;
+    }
+};
+
+// Returns everything allocated from the arena during its lifetime
+class ArenaScope {
+public:
+    explicit ArenaScope(ScratchArena& arena = ScratchArena::local()) : arena(arena), start(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(start); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    template <class T>
+    T* allocate(std::size_t count) {
+        return arena.template allocate<T>(count);
+    }
+
+private:
+    ScratchArena& arena;
+    ScratchArena::Mark start;
+};
+
+} // namespace giophantus
+
+#endif
@@ -0,0 +1,207 @@
+// Awaitable encryption and decryption: requests run on a ThreadPool, batched per key
+#ifndef GIOPHANTUS_ASYNC_H
+#define GIOPHANTUS_ASYNC_H
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "giophantus/key.h"
+#include "giophantus/scheme.h"
+#include "giophantus/thread_pool.h"
+
+namespace giophantus {
+
+// Executors take the handle of a coroutine to resume: an event loop posts it to its queue. The
+// default resumes it right away, on the pool worker that finished the batch.
+struct InlineExecutor {
+    void operator()(std::coroutine_handle<> handle) const {
+        handle.resume();
+    }
+};
+
+struct AsyncStats {
+    std::uint64_t requests = 0; // completed
+    std::uint64_t batches = 0;  // batch calls they were served by
+};
+
+// One suspended request. It lives in the awaiter, inside the frame of the awaiting coroutine,
+// so queueing it allocates nothing.
+template <class In, class Out>
+struct AsyncRequest {
+    using Input = In;
+
+    const In* input = nullptr;
+    Out output{};
+    AsyncRequest* next = nullptr;
+    // Hands the coroutine to its executor
+    void (*resume)(AsyncRequest&) = nullptr;
+};
+
+// Requests queue on a list; the first one onto an empty list submits a flush to the pool, and
+// everything queued until that flush starts goes into its batch. A busy pool thus grows the
+// batches instead of the queue of tasks. Flushes can overlap: a request arriving while one runs
+// starts the next. A batch runs serially on its flush task: waiting on a parallel_for there would
+// run other flushes on the same stack, resuming unrelated coroutines nested inside this one.
+template <class Derived, class In, class Out>
+class AsyncBatcher {
+public:
+    using Request = AsyncRequest<In, Out>;
+
+    explicit AsyncBatcher(ThreadPool& pool) : pool(pool) {}
+
+    AsyncBatcher(const AsyncBatcher&) = delete;
+    AsyncBatcher& operator=(const AsyncBatcher&) = delete;
+
+    AsyncStats stats() const {
+        AsyncStats s;
+        s.requests = requests.load(std::memory_order_relaxed);
+        s.batches = batches.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void enqueue(Request& request) {
+        bool schedule;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            request.next = nullptr;
+            (tail ? tail->next : head) = &request;
+            tail = &request;
+            schedule = !flush_queued;
+            flush_queued = true;
+        }
+        if (schedule) {
+            pool.submit([this] { flush(); });
+        }
+    }
+
+protected:
+    ThreadPool& pool;
+
+private:
+    std::mutex mutex;
+    Request* head = nullptr;
+    Request* tail = nullptr;
+    bool flush_queued = false;
+    std::atomic<std::uint64_t> requests{0}, batches{0};
+
+    void flush() {
+        Request* list;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            list = head;
+            head = tail = nullptr;
+            flush_queued = false;
+        }
+        std::vector<In> inputs;
+        for (Request* r = list; r; r = r->next) {
+            inputs.push_back(*r->input);
+        }
+        std::vector<Out> outputs(inputs.size());
+        static_cast<Derived*>(this)->run_batch(inputs, outputs);
+        requests.fetch_add(inputs.size(), std::memory_order_relaxed);
+        batches.fetch_add(1, std::memory_order_relaxed);
+
+        std::size_t k = 0;
+        for (Request* r = list; r; ++k) {
+            // Resuming may end the coroutine and with it the request
+            Request* next = r->next;
+            r->output = std::move(outputs[k]);
+            r->resume(*r);
+            r = next;
+        }
+    }
+};
+
+// co_await of one request: queued on suspension, resumed through the executor with its result
+template <class Batcher, class Executor>
+class BatchAwaiter : private Batcher::Request {
+    using Request = typename Batcher::Request;
+
+public:
+    BatchAwaiter(Batcher& batcher, const typename Request::Input& input, Executor executor) : batcher(batcher), executor(std::move(executor)) {
+        this->input = &input;
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        handle = h;
+        this->resume = [](Request& r) {
+            BatchAwaiter& self = static_cast<BatchAwaiter&>(r);
+            self.executor(self.handle);
+        };
+        batcher.enqueue(*this);
+    }
+
+    auto await_resume() {
+        return std::move(this->output);
+    }
+
+private:
+    Batcher& batcher;
+    Executor executor;
+    std::coroutine_handle<> handle;
+};
+
+// Encryption under one public key. Every batch is one EncryptionContext::encrypt_many on the
+// flush task, so concurrent requests share the cached transforms of X and its groups of GROUP.
+template <class Params>
+class AsyncEncryptor : public AsyncBatcher<AsyncEncryptor<Params>, typename Params::Ring, typename Params::Ciphertext> {
+    using Base = AsyncBatcher<AsyncEncryptor<Params>, typename Params::Ring, typename Params::Ciphertext>;
+    friend Base;
+
+public:
+    explicit AsyncEncryptor(const typename Params::PublicPoly& X, ThreadPool& pool = ThreadPool::shared()) : Base(pool), context(X) {}
+
+private:
+    const EncryptionContext<Params> context;
+
+    void run_batch(std::span<const typename Params::Ring> messages, std::span<typename Params::Ciphertext> ciphertexts) {
+        context.encrypt_many(messages, ciphertexts, RandomPolynomialGenerator::local());
+    }
+};
+
+// Decryption under one secret key, a batch decrypted in turn on the flush task
+template <class Params>
+class AsyncDecryptor : public AsyncBatcher<AsyncDecryptor<Params>, typename Params::Ciphertext, typename Params::Ring> {
+    using Base = AsyncBatcher<AsyncDecryptor<Params>, typename Params::Ciphertext, typename Params::Ring>;
+    friend Base;
+
+public:
+    explicit AsyncDecryptor(const GiophantusKey<Params>& key, ThreadPool& pool = ThreadPool::shared()) : Base(pool), context(key) {}
+
+private:
+    const DecryptionContext<Params> context;
+
+    void run_batch(std::span<const typename Params::Ciphertext> ciphertexts, std::span<typename Params::Ring> messages) {
+        for (std::size_t k = 0; k < ciphertexts.size(); ++k) {
+            context.decrypt_into(messages[k], ciphertexts[k]);
+        }
+    }
+};
+
+// Ciphertext c = co_await async_encrypt(encryptor, m, executor). The argument has to outlive the
+// co_await, as every argument of the expression does; the encryptor has to outlive its requests.
+template <class Params, class Executor = InlineExecutor>
+BatchAwaiter<AsyncEncryptor<Params>, Executor> async_encrypt(AsyncEncryptor<Params>& encryptor, const typename Params::Ring& message,
+                                                             Executor executor = {}) {
+    return {encryptor, message, std::move(executor)};
+}
+
+template <class Params, class Executor = InlineExecutor>
+BatchAwaiter<AsyncDecryptor<Params>, Executor> async_decrypt(AsyncDecryptor<Params>& decryptor, const typename Params::Ciphertext& c,
+                                                             Executor executor = {}) {
+    return {decryptor, c, std::move(executor)};
+}
+
+} // namespace giophantus
+
+#endif
@@ -0,0 +1,282 @@
+// Bivariate polynomials Pq(d) over Rq
+#ifndef GIOPHANTUS_BIVARIATE_H
+#define GIOPHANTUS_BIVARIATE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "giophantus/arena.h"
+#include "giophantus/ring.h"
+#include "giophantus/sparse.h"
+#include "giophantus/thread_pool.h"
+
+namespace giophantus {
+
+// Number of monomials x^i y^j with i + j <= d
+constexpr std::size_t nterm(std::size_t d) {
+    return (d + 1) * (d + 2) / 2;
+}
+
+// Bivariate polynomial in Rq[x, y] of total degree <= D (Pq(d) in the reference iec.h).
+// The NTERM(D) ring coefficients sit back to back in one aligned buffer, in POLYFOR order
+// (i outer, j inner), so substitution and products walk it front to back.
+template <class Ring, std::size_t D>
+class Pq {
+public:
+    static constexpr std::size_t total_degree = D;
+    static constexpr std::size_t terms = nterm(D);
+
+    // Position of the x^i y^j coefficient: rows i' < i hold D + 1 - i' terms each
+    static constexpr std::size_t index(std::size_t i, std::size_t j) {
+        return i * (D + 1) - i * (i - 1) / 2 + j;
+    }
+
+    // (i, j) of every slot, the inverse of index()
+    static constexpr std::array<std::array<std::size_t, 2>, terms> exponents = [] {
+        std::array<std::array<std::size_t, 2>, terms> table{};
+        for (std::size_t i = 0; i <= D; ++i) {
+            for (std::size_t j = 0; i + j <= D; ++j) {
+                table[index(i, j)] = {i, j};
+            }
+        }
+        return table;
+    }();
+
+private:
+    alignas(64) std::array<Ring, terms> coeffs{};
+
+public:
+    const Ring& operator()(std::size_t i, std::size_t j) const { return coeffs[index(i, j)]; }
+    Ring& operator()(std::size_t i, std::size_t j) { return coeffs[index(i, j)]; }
+
+    const Ring& operator[](std::size_t k) const { return coeffs[k]; }
+    Ring& operator[](std::size_t k) { return coeffs[k]; }
+
+    auto begin() const { return coeffs.begin(); }
+    auto end() const { return coeffs.end(); }
+    auto begin() { return coeffs.begin(); }
+    auto end() { return coeffs.end(); }
+
+    Pq& operator+=(const Pq& other) {
+        for (std::size_t k = 0; k < terms; ++k) {
+            coeffs[k] += other.coeffs[k];
+        }
+        return *this;
+    }
+
+    Pq& operator-=(const Pq& other) {
+        for (std::size_t k = 0; k < terms; ++k) {
+            coeffs[k] -= other.coeffs[k];
+        }
+        return *this;
+    }
+
+    // Every ring coefficient times a scalar (Pq_smul scales by L)
+    Pq& operator*=(Fq scalar) {
+        for (Ring& c : coeffs) {
+            c *= scalar;
+        }
+        return *this;
+    }
+
+    Pq operator+(const Pq& other) const {
+        Pq result = *this;
+        return result += other;
+    }
+
+    Pq operator-(const Pq& other) const {
+        Pq result = *this;
+        return result -= other;
+    }
+
+    bool operator==(const Pq& other) const {
+        return coeffs == other.coeffs;
+    }
+
+    bool operator!=(const Pq& other) const {
+        return !(*this == other);
+    }
+
+    // out = f(x, y) in Rq by nested Horner: f = g_0(y) + x (g_1(y) + x (...)), g_i(y) the terms
+    // x^i y^j. x and y are transformed once; every step transforms the running value, and the
+    // last step of each g_i shares its inverse transform with the x step it feeds, so a linear f
+    // costs 5 transforms and a quadratic one 10, against 20 through the monomials x^i y^j.
+    void evaluate_into(Ring& out, const Ring& x, const Ring& y) const {
+        using Multiplier = typename Ring::Multiplier;
+        constexpr std::size_t W = Multiplier::transform_words;
+
+        if constexpr (D == 0) {
+            out = coeffs[0];
+        } else {
+            ArenaScope scope;
+            std::uint32_t* tx = scope.allocate<std::uint32_t>(4 * W);
+            std::uint32_t* ty = tx + W;
+            std::uint32_t* ta = ty + W;
+            std::uint32_t* acc = ta + W;
+            Multiplier::forward(tx, x.data());
+            Multiplier::forward(ty, y.data());
+            // acc += r * t
+            const auto product = [&](const Ring& r, const std::uint32_t* t) {
+                Multiplier::forward(ta, r.data());
+                Multiplier::mul_acc(acc, ta, t);
+            };
+
+            // Built aside, so out may alias x, y or a coefficient
+            Ring* result = scope.allocate<Ring>(2);
+            Ring* inner = result + 1;
+            *result = (*this)(D, 0);
+            for (std::size_t i = D; i-- > 0;) {
+                // inner = (g_i(y) - f_i0) / y
+                *inner = (*this)(i, D - i);
+                for (std::size_t j = D - i - 1; j > 0; --j) {
+                    Multiplier::clear(acc);
+                    product(*inner, ty);
+                    Multiplier::inverse(inner->data(), acc);
+                    *inner += (*this)(i, j);
+                }
+                Multiplier::clear(acc);
+                product(*result, tx);
+                product(*inner, ty);
+                Multiplier::inverse(result->data(), acc);
+                *result += (*this)(i, 0);
+            }
+            out = *result;
+        }
+    }
+
+    // f(x, y) for small x and y, the same Horner scheme with the products as row additions:
+    // NTERM(D) - 1 of them, two for a linear f
+    void evaluate_into(Ring& out, const SparseRq<Ring>& x, const SparseRq<Ring>& y) const {
+        if constexpr (D == 0) {
+            out = coeffs[0];
+        } else {
+            ArenaScope scope;
+            Ring* result = scope.allocate<Ring>(3);
+            Ring* inner = result + 1;
+            Ring* next = result + 2;
+            *result = (*this)(D, 0);
+            for (std::size_t i = D; i-- > 0;) {
+                *inner = (*this)(i, D - i);
+                for (std::size_t j = D - i; j-- > 0;) {
+                    *next = (*this)(i, j);
+                    y.mul_acc(*next, *inner);
+                    std::swap(inner, next);
+                }
+                *next = *inner;
+                x.mul_acc(*next, *result);
+                std::swap(result, next);
+            }
+            out = *result;
+        }
+    }
+
+    Ring evaluate(const SparseRq<Ring>& x, const SparseRq<Ring>& y) const {
+        Ring result;
+        evaluate_into(result, x, y);
+        return result;
+    }
+
+    Ring evaluate(const Ring& x, const Ring& y) const {
+        Ring result;
+        evaluate_into(result, x, y);
+        return result;
+    }
+
+    static void add_into(Pq& out, const Pq& a, const Pq& b) {
+        for (std::size_t k = 0; k < terms; ++k) {
+            Ring::add_into(out.coeffs[k], a.coeffs[k], b.coeffs[k]);
+        }
+    }
+};
+
+// Output term (i, j) of a Pq product from the transformed input terms ta, tb
+template <class Ring, std::size_t A, std::size_t B>
+void pq_product_term(Ring& out, std::size_t i, std::size_t j, const std::uint32_t* ta, const std::uint32_t* tb, std::uint32_t* acc) {
+    using Multiplier = typename Ring::Multiplier;
+    constexpr std::size_t W = Multiplier::transform_words;
+    // Each output term sums at most one product per term of the smaller input
+    static_assert(std::min(Pq<Ring, A>::terms, Pq<Ring, B>::terms) <= NTT_ACCUMULATION, "Pq product term exceeds NTT_ACCUMULATION");
+
+    Multiplier::clear(acc);
+    for (std::size_t ai = 0; ai <= std::min(i, A); ++ai) {
+        for (std::size_t aj = 0; aj <= j && ai + aj <= A; ++aj) {
+            const std::size_t bi = i - ai;
+            const std::size_t bj = j - aj;
+            if (bi + bj <= B) {
+                Multiplier::mul_acc(acc, ta + Pq<Ring, A>::index(ai, aj) * W, tb + Pq<Ring, B>::index(bi, bj) * W);
+            }
+        }
+    }
+    Multiplier::inverse(out.data(), acc);
+}
+
+// c = a * b with total degree A + B. Every input term is transformed once; each output term
+// accumulates its partial products in the transform domain before one inverse transform.
+// With a pool the transforms and the NTERM(A + B) output terms run as independent tasks.
+template <class Ring, std::size_t A, std::size_t B>
+void mul_into(Pq<Ring, A + B>& c, const Pq<Ring, A>& a, const Pq<Ring, B>& b, ThreadPool* pool = nullptr) {
+    using Multiplier = typename Ring::Multiplier;
+    using Left = Pq<Ring, A>;
+    using Right = Pq<Ring, B>;
+    using Product = Pq<Ring, A + B>;
+    constexpr std::size_t W = Multiplier::transform_words;
+
+    // The input transforms live in the caller's arena and are only read by the tasks
+    ArenaScope scope;
+    std::uint32_t* ta = scope.allocate<std::uint32_t>((Left::terms + Right::terms + 1) * W);
+    std::uint32_t* tb = ta + Left::terms * W;
+
+    if (pool == nullptr || pool->size() < 2) {
+        std::uint32_t* acc = tb + Right::terms * W;
+        for (std::size_t k = 0; k < Left::terms; ++k) {
+            Multiplier::forward(ta + k * W, a[k].data());
+        }
+        for (std::size_t k = 0; k < Right::terms; ++k) {
+            Multiplier::forward(tb + k * W, b[k].data());
+        }
+        for (std::size_t k = 0; k < Product::terms; ++k) {
+            const auto [i, j] = Product::exponents[k];
+            pq_product_term<Ring, A, B>(c[k], i, j, ta, tb, acc);
+        }
+        return;
+    }
+
+    pool->parallel_for(Left::terms + Right::terms, [&](std::size_t k) {
+        if (k < Left::terms) {
+            Multiplier::forward(ta + k * W, a[k].data());
+        } else {
+            Multiplier::forward(tb + (k - Left::terms) * W, b[k - Left::terms].data());
+        }
+    });
+    pool->parallel_for(Product::terms, [&](std::size_t k) {
+        ArenaScope task_scope;
+        const auto [i, j] = Product::exponents[k];
+        pq_product_term<Ring, A, B>(c[k], i, j, ta, tb, task_scope.allocate<std::uint32_t>(W));
+    });
+}
+
+template <class Ring, std::size_t A, std::size_t B>
+Pq<Ring, A + B> multiply(const Pq<Ring, A>& a, const Pq<Ring, B>& b, ThreadPool* pool) {
+    Pq<Ring, A + B> c;
+    mul_into(c, a, b, pool);
+    return c;
+}
+
+// Ring dimension from which Pq products are split across the shared pool (the 256-bit set, N = 2267)
+constexpr std::size_t PARALLEL_PQ_DIMENSION = 2048;
+
+template <class Ring, std::size_t A, std::size_t B>
+Pq<Ring, A + B> operator*(const Pq<Ring, A>& a, const Pq<Ring, B>& b) {
+    if constexpr (Ring::dimension >= PARALLEL_PQ_DIMENSION) {
+        return multiply(a, b, &ThreadPool::shared());
+    } else {
+        return multiply(a, b, nullptr);
+    }
+}
+
+} // namespace giophantus
+
+#endif
@@ -0,0 +1,321 @@
+// Octet-string encodings of ring elements, bivariate polynomials, keys and ciphertexts
+#ifndef GIOPHANTUS_CODEC_H
+#define GIOPHANTUS_CODEC_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "giophantus/bivariate.h"
+#include "giophantus/key.h"
+#include "giophantus/params.h"
+
+namespace giophantus {
+
+// Byte sizes of the reference encodings (iec.h): Rl packs four coefficients of [0, L) per byte,
+// Rq stores every coefficient as 4 bytes little endian, and Pq(d) concatenates its NTERM(d) terms.
+// Two bits hold a secret coefficient only for L <= 4, so sets with a larger L have no encoding.
+template <class Params>
+struct ByteLayout {
+    static_assert(Params::noise_bound <= 4, "the Rl encoding packs two-bit coefficients");
+
+    static constexpr std::size_t rl = (Params::N + 3) / 4;
+    static constexpr std::size_t rq = 4 * Params::N;
+
+    static constexpr std::size_t pq(std::size_t d) {
+        return nterm(d) * rq;
+    }
+
+    static constexpr std::size_t public_key = pq(Params::dx);
+    // ux || uy || pk, so decryption can re-encrypt without the public key at hand
+    static constexpr std::size_t secret_key = 2 * rl + public_key;
+    static constexpr std::size_t ciphertext = pq(Params::dx + Params::dr);
+    // FO payload: the message padded with random bytes up to one Rl encoding
+    static constexpr std::size_t payload = rl;
+    static constexpr std::size_t message = static_cast<std::size_t>(Params::block_size);
+    // Bytes the seed expander yields for one encryption: r in Pq(dr), e at one byte per coefficient
+    static constexpr std::size_t seed = pq(Params::dr) + nterm(Params::dc) * Params::N;
+};
+
+class ByteCodec {
+public:
+    // Rl2OS: coefficients in [0, 4), the first one in the two high bits of each byte
+    template <class Ring>
+    static void encode_small(std::uint8_t* out, const Ring& f) {
+        constexpr std::size_t n = Ring::dimension;
+        for (std::size_t i = 0; i < n / 4; ++i) {
+            out[i] = static_cast<std::uint8_t>(f[4 * i] << 6 | f[4 * i + 1] << 4 | f[4 * i + 2] << 2 | f[4 * i + 3]);
+        }
+        if constexpr (n % 4 != 0) {
+            std::uint8_t tail = 0;
+            for (std::size_t k = 0; k < n % 4; ++k) {
+                tail |= static_cast<std::uint8_t>(f[n - n % 4 + k] << (6 - 2 * k));
+            }
+            out[n / 4] = tail;
+        }
+    }
+
+    // OS2Rl; bits past the last coefficient are ignored
+    template <class Ring>
+    static void decode_small(Ring& f, const std::uint8_t* in) {
+        constexpr std::size_t n = Ring::dimension;
+        for (std::size_t i = 0; i < n; ++i) {
+            f[i] = in[i / 4] >> (6 - 2 * (i % 4)) & 3;
+        }
+    }
+
+    // Packed secrets with two bits a coefficient are stored in the Rl2OS layout already; narrower
+    // ones are widened to it, and wider ones do not fit a two-bit slot
+    template <class Ring, Fq L>
+    static void encode_small(std::uint8_t* out, const Rl<Ring, L>& f) {
+        static_assert(L <= 4, "Rl2OS packs two-bit coefficients");
+        if constexpr (Rl<Ring, L>::bits == 2) {
+            std::memcpy(out, f.data(), Rl<Ring, L>::size_bytes);
+        } else {
+            for (std::size_t i = 0; i < Ring::dimension; ++i) {
+                out[i / 4] = static_cast<std::uint8_t>((i % 4 == 0 ? 0 : out[i / 4]) | f[i] << (6 - 2 * (i % 4)));
+            }
+        }
+    }
+
+    template <class Ring, Fq L>
+    static void decode_small(Rl<Ring, L>& f, const std::uint8_t* in) {
+        static_assert(L <= 4, "Rl2OS packs two-bit coefficients");
+        if constexpr (Rl<Ring, L>::bits == 2) {
+            f.assign_bytes(in);
+        } else {
+            for (std::size_t i = 0; i < Ring::dimension; ++i) {
+                f.set(i, in[i / 4] >> (6 - 2 * (i % 4)) & 3);
+            }
+        }
+    }
+
+    // Rq2OS
+    template <class Ring>
+    static void encode_ring(std::uint8_t* out, const Ring& f) {
+        for (std::size_t i = 0; i < Ring::dimension; ++i) {
+            const Fq x = f[i];
+            out[4 * i] = static_cast<std::uint8_t>(x);
+            out[4 * i + 1] = static_cast<std::uint8_t>(x >> 8);
+            out[4 * i + 2] = static_cast<std::uint8_t>(x >> 16);
+            out[4 * i + 3] = static_cast<std::uint8_t>(x >> 24);
+        }
+    }
+
+    // OS2Rq; false when a coefficient is not reduced modulo q. The reference takes such words as
+    // they are, which can only end in a rejected FO check.
+    template <class Ring>
+    static bool decode_ring(Ring& f, const std::uint8_t* in) {
+        Fq invalid = 0;
+        for (std::size_t i = 0; i < Ring::dimension; ++i) {
+            const Fq x = static_cast<Fq>(in[4 * i]) | static_cast<Fq>(in[4 * i + 1]) << 8 |
+                         static_cast<Fq>(in[4 * i + 2]) << 16 | static_cast<Fq>(in[4 * i + 3]) << 24;
+            invalid |= static_cast<Fq>(x >= Ring::modulus);
+            f[i] = x;
+        }
+        return invalid == 0;
+    }
+
+    // Pq2OS: terms from the highest x exponent down, (2, 0), (1, 1), (0, 2), (1, 0), (0, 1), (0, 0)
+    // for d = 2, the reverse of the reference exp_table
+    template <class Ring, std::size_t D>
+    static void encode(std::uint8_t* out, const Pq<Ring, D>& f) {
+        for (std::size_t t = 0; t < Pq<Ring, D>::terms; ++t) {
+            const auto [i, j] = wire_order<D>(t);
+            encode_ring(out + t * 4 * Ring::dimension, f(i, j));
+        }
+    }
+
+    template <class Ring, std::size_t D>
+    static bool decode(Pq<Ring, D>& f, const std::uint8_t* in) {
+        bool valid = true;
+        for (std::size_t t = 0; t < Pq<Ring, D>::terms; ++t) {
+            const auto [i, j] = wire_order<D>(t);
+            valid &= decode_ring(f(i, j), in + t * 4 * Ring::dimension);
+        }
+        return valid;
+    }
+
+    // Secret key ux || uy || X, the layout of crypto_encrypt_keypair; L <= 4 (see ByteLayout)
+    template <class Params>
+    static void encode(std::uint8_t* out, const GiophantusKey<Params>& key) {
+        static_assert(Params::noise_bound <= 4, "the Rl encoding packs two-bit coefficients");
+        using Layout = ByteLayout<Params>;
+        encode_small(out, key.ux);
+        encode_small(out + Layout::rl, key.uy);
+        encode(out + 2 * Layout::rl, key.X);
+    }
+
+    template <class Params>
+    static bool decode(GiophantusKey<Params>& key, const std::uint8_t* in) {
+        static_assert(Params::noise_bound <= 4, "the Rl encoding packs two-bit coefficients");
+        using Layout = ByteLayout<Params>;
+        decode_small(key.ux, in);
+        decode_small(key.uy, in + Layout::rl);
+        return decode(key.X, in + 2 * Layout::rl);
+    }
+
+    // Exponents of the t-th encoded term: exp_table lists total degree s ascending as
+    // (0, s), (1, s - 1), ..., (s, 0), and the encoding walks it backwards
+    template <std::size_t D>
+    static constexpr std::array<std::size_t, 2> wire_order(std::size_t t) {
+        std::size_t k = nterm(D) - 1 - t;
+        std::size_t s = 0;
+        while (k > s) {
+            k -= s + 1;
+            ++s;
+        }
+        return {k, s - k};
+    }
+};
+
+// Read-only views over encoded buffers. Coefficients are read straight from the received bytes,
+// so a ciphertext can be checked and decrypted without unpacking it first; the buffer must
+// outlive the view.
+
+// One Rq encoding: N little-endian 32-bit words
+template <class Ring>
+class RingView {
+public:
+    static constexpr std::size_t size_bytes = 4 * Ring::dimension;
+
+    explicit RingView(const std::uint8_t* bytes) : bytes(bytes) {}
+
+    Fq operator[](std::size_t i) const {
+        const std::uint8_t* p = bytes + 4 * i;
+        return static_cast<Fq>(p[0]) | static_cast<Fq>(p[1]) << 8 | static_cast<Fq>(p[2]) << 16 | static_cast<Fq>(p[3]) << 24;
+    }
+
+    const std::uint8_t* data() const { return bytes; }
+
+    // Every coefficient reduced modulo q
+    bool valid() const {
+        Ring scratch;
+        return ByteCodec::decode_ring(scratch, bytes);
+    }
+
+    // The coefficients as an Fq array: the buffer itself on a little-endian host when it is
+    // suitably aligned, otherwise a copy in scratch
+    const Fq* coefficients(Ring& scratch) const {
+        if constexpr (std::endian::native == std::endian::little) {
+            if (reinterpret_cast<std::uintptr_t>(bytes) % alignof(Fq) == 0) {
+                return reinterpret_cast<const Fq*>(bytes);
+            }
+        }
+        ByteCodec::decode_ring(scratch, bytes);
+        return scratch.data();
+    }
+
+    void copy_to(Ring& out) const {
+        ByteCodec::decode_ring(out, bytes);
+    }
+
+private:
+    const std::uint8_t* bytes;
+};
+
+// One Rl encoding: four two-bit coefficients per byte, so only for secrets below 4
+template <class Ring>
+class SmallRingView {
+public:
+    static constexpr std::size_t size_bytes = (Ring::dimension + 3) / 4;
+
+    explicit SmallRingView(const std::uint8_t* bytes) : bytes(bytes) {}
+
+    Fq operator[](std::size_t i) const {
+        return bytes[i / 4] >> (6 - 2 * (i % 4)) & 3;
+    }
+
+    const std::uint8_t* data() const { return bytes; }
+
+    void copy_to(Ring& out) const {
+        ByteCodec::decode_small(out, bytes);
+    }
+
+private:
+    const std::uint8_t* bytes;
+};
+
+// One Pq(D) encoding, terms addressed by exponents like Pq itself
+template <class Ring, std::size_t D>
+class PqView {
+public:
+    using Poly = Pq<Ring, D>;
+    static constexpr std::size_t size_bytes = Poly::terms * RingView<Ring>::size_bytes;
+
+    explicit PqView(const std::uint8_t* bytes) : bytes(bytes) {}
+
+    RingView<Ring> operator()(std::size_t i, std::size_t j) const {
+        return (*this)[Poly::index(i, j)];
+    }
+
+    // Term at slot k of Pq (POLYFOR order), wherever the encoding put it
+    RingView<Ring> operator[](std::size_t k) const {
+        return RingView<Ring>(bytes + position[k] * RingView<Ring>::size_bytes);
+    }
+
+    const std::uint8_t* data() const { return bytes; }
+
+    bool valid() const {
+        Ring scratch;
+        bool result = true;
+        for (std::size_t k = 0; k < Poly::terms; ++k) {
+            result &= ByteCodec::decode_ring(scratch, bytes + k * RingView<Ring>::size_bytes);
+        }
+        return result;
+    }
+
+    void copy_to(Poly& out) const {
+        ByteCodec::decode(out, bytes);
+    }
+
+private:
+    const std::uint8_t* bytes;
+
+    // Encoded position of each Pq slot
+    static constexpr std::array<std::size_t, Poly::terms> position = [] {
+        std::array<std::size_t, Poly::terms> table{};
+        for (std::size_t t = 0; t < Poly::terms; ++t) {
+            const auto [i, j] = ByteCodec::wire_order<D>(t);
+            table[Poly::index(i, j)] = t;
+        }
+        return table;
+    }();
+};
+
+template <class Params>
+using PublicKeyView = PqView<typename Params::Ring, Params::dx>;
+
+template <class Params>
+using CiphertextView = PqView<typename Params::Ring, Params::dx + Params::dr>;
+
+// ux || uy || X as written by ByteCodec::encode(out, key)
+template <class Params>
+class SecretKeyView {
+    static_assert(Params::noise_bound <= 4, "the Rl encoding packs two-bit coefficients");
+
+public:
+    using Ring = typename Params::Ring;
+    static constexpr std::size_t size_bytes = ByteLayout<Params>::secret_key;
+
+    explicit SecretKeyView(const std::uint8_t* bytes) : bytes(bytes) {}
+
+    SmallRingView<Ring> ux() const { return SmallRingView<Ring>(bytes); }
+    SmallRingView<Ring> uy() const { return SmallRingView<Ring>(bytes + ByteLayout<Params>::rl); }
+    PublicKeyView<Params> public_key() const { return PublicKeyView<Params>(bytes + 2 * ByteLayout<Params>::rl); }
+
+    const std::uint8_t* data() const { return bytes; }
+
+    bool copy_to(GiophantusKey<Params>& key) const {
+        return ByteCodec::decode(key, bytes);
+    }
+
+private:
+    const std::uint8_t* bytes;
+};
+
+} // namespace giophantus
+
+#endif
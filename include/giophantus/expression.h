@@ -0,0 +1,384 @@
+// Lazy expressions over Rq: sums, scalar multiples and products evaluated in one fused pass
+#ifndef GIOPHANTUS_EXPRESSION_H
+#define GIOPHANTUS_EXPRESSION_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "giophantus/arena.h"
+#include "giophantus/field.h"
+#include "giophantus/multiply.h"
+#include "giophantus/simd.h"
+
+namespace giophantus {
+
+// Ring Expressions
+// lazy(a) * b + lazy(c) * d - 4 * lazy(e) builds a tree of references instead of ring elements;
+// converting it to its Rq, or compute_into, evaluates the tree at once. Its products accumulate
+// in one transform buffer under one inverse transform, every operand is transformed once however
+// many products share it (a * b + a * c takes three forward transforms and one inverse, against
+// four and two for the eager operators), and the other terms enter the output with one vector
+// kernel call each. Only operands of products that are expressions themselves, as in
+// (a + b) * c, are materialized, in the scratch arena. The tree holds the ring elements by
+// reference, so it must not outlive them: an auto variable over temporaries dangles.
+template <class Element>
+class RingTerm;
+template <class L, class R, bool Negate>
+class RingSum;
+template <class E>
+class RingScaled;
+template <class L, class R>
+class RingProduct;
+
+template <class Derived, class Ring>
+class RingExpression {
+public:
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+    operator Ring() const;
+
+    template <class Other>
+    friend RingSum<Derived, Other, false> operator+(const RingExpression& a, const RingExpression<Other, Ring>& b) {
+        return {a.derived(), b.derived()};
+    }
+    friend RingSum<Derived, RingTerm<Ring>, false> operator+(const RingExpression& a, const Ring& b) {
+        return {a.derived(), RingTerm<Ring>(b)};
+    }
+    friend RingSum<RingTerm<Ring>, Derived, false> operator+(const Ring& a, const RingExpression& b) {
+        return {RingTerm<Ring>(a), b.derived()};
+    }
+
+    template <class Other>
+    friend RingSum<Derived, Other, true> operator-(const RingExpression& a, const RingExpression<Other, Ring>& b) {
+        return {a.derived(), b.derived()};
+    }
+    friend RingSum<Derived, RingTerm<Ring>, true> operator-(const RingExpression& a, const Ring& b) {
+        return {a.derived(), RingTerm<Ring>(b)};
+    }
+    friend RingSum<RingTerm<Ring>, Derived, true> operator-(const Ring& a, const RingExpression& b) {
+        return {RingTerm<Ring>(a), b.derived()};
+    }
+    friend RingScaled<Derived> operator-(const RingExpression& a) {
+        return {a.derived(), Ring::modulus - 1};
+    }
+
+    template <class Other>
+    friend RingProduct<Derived, Other> operator*(const RingExpression& a, const RingExpression<Other, Ring>& b) {
+        return {a.derived(), b.derived()};
+    }
+    friend RingProduct<Derived, RingTerm<Ring>> operator*(const RingExpression& a, const Ring& b) {
+        return {a.derived(), RingTerm<Ring>(b)};
+    }
+    friend RingProduct<RingTerm<Ring>, Derived> operator*(const Ring& a, const RingExpression& b) {
+        return {RingTerm<Ring>(a), b.derived()};
+    }
+    friend RingScaled<Derived> operator*(const RingExpression& a, Fq scalar) {
+        return {a.derived(), scalar};
+    }
+    friend RingScaled<Derived> operator*(Fq scalar, const RingExpression& a) {
+        return {a.derived(), scalar};
+    }
+};
+
+template <class Element>
+class RingTerm : public RingExpression<RingTerm<Element>, Element> {
+public:
+    using Ring = Element;
+    static constexpr bool is_term = true;
+    static constexpr std::size_t linear_terms = 1;
+    static constexpr std::size_t product_terms = 0;
+
+    explicit RingTerm(const Ring& a) : a(a) {}
+
+    const Ring& value() const { return a; }
+
+    template <class Plan>
+    void collect(Plan& plan, Fq scale) const {
+        plan.add_linear(&a, scale);
+    }
+
+private:
+    const Ring& a;
+};
+
+// a + b, or a - b with Negate
+template <class L, class R, bool Negate>
+class RingSum : public RingExpression<RingSum<L, R, Negate>, typename L::Ring> {
+public:
+    using Ring = typename L::Ring;
+    static constexpr bool is_term = false;
+    static constexpr std::size_t linear_terms = L::linear_terms + R::linear_terms;
+    static constexpr std::size_t product_terms = L::product_terms + R::product_terms;
+
+    RingSum(const L& l, const R& r) : l(l), r(r) {}
+
+    template <class Plan>
+    void collect(Plan& plan, Fq scale) const {
+        l.collect(plan, scale);
+        r.collect(plan, Negate ? Ring::Field::sub(0, scale) : scale);
+    }
+
+private:
+    L l;
+    R r;
+};
+
+template <class E>
+class RingScaled : public RingExpression<RingScaled<E>, typename E::Ring> {
+public:
+    using Ring = typename E::Ring;
+    static constexpr bool is_term = false;
+    static constexpr std::size_t linear_terms = E::linear_terms;
+    static constexpr std::size_t product_terms = E::product_terms;
+
+    RingScaled(const E& e, Fq scalar) : e(e), scalar(Ring::Field::mod(scalar)) {}
+
+    template <class Plan>
+    void collect(Plan& plan, Fq scale) const {
+        e.collect(plan, Ring::Field::mul(scale, scalar));
+    }
+
+private:
+    E e;
+    Fq scalar;
+};
+
+template <class Ring, class E>
+void compute_into(Ring& out, const RingExpression<E, Ring>& expression);
+
+template <class L, class R>
+class RingProduct : public RingExpression<RingProduct<L, R>, typename L::Ring> {
+public:
+    using Ring = typename L::Ring;
+    static constexpr bool is_term = false;
+    static constexpr std::size_t linear_terms = 0;
+    static constexpr std::size_t product_terms = 1;
+
+    RingProduct(const L& l, const R& r) : l(l), r(r) {}
+
+    template <class Plan>
+    void collect(Plan& plan, Fq scale) const {
+        const Ring& a = operand(plan, l);
+        const Ring& b = operand(plan, r);
+        plan.add_product(&a, &b, scale);
+    }
+
+private:
+    L l;
+    R r;
+
+    template <class Plan, class E>
+    static const Ring& operand(Plan& plan, const E& e) {
+        if constexpr (E::is_term) {
+            return e.value();
+        } else {
+            Ring* value = plan.temporary();
+            compute_into(*value, e);
+            return *value;
+        }
+    }
+};
+
+// The flattened tree: sum of scale * a over the linear terms plus scale * a * b over the products
+template <class Ring, std::size_t Linear, std::size_t Products>
+class ExpressionPlan {
+    static constexpr std::size_t N = Ring::dimension;
+    static constexpr Fq Q = Ring::modulus;
+    using Multiplier = typename Ring::Multiplier;
+    static constexpr std::size_t W = Multiplier::transform_words;
+
+    struct LinearTerm {
+        const Ring* a;
+        Fq scale;
+    };
+    struct ProductTerm {
+        const Ring* a;
+        const Ring* b;
+        Fq scale;
+    };
+
+public:
+    explicit ExpressionPlan(ArenaScope& scope) : scope(scope) {}
+
+    void add_linear(const Ring* a, Fq scale) {
+        linear[linear_count++] = {a, scale};
+    }
+
+    void add_product(const Ring* a, const Ring* b, Fq scale) {
+        products[product_count++] = {a, b, scale};
+    }
+
+    Ring* temporary() {
+        return scope.template allocate<Ring>(1);
+    }
+
+    bool reads(const Ring& r) const {
+        for (std::size_t k = 0; k < linear_count; ++k) {
+            if (linear[k].a == &r) {
+                return true;
+            }
+        }
+        for (std::size_t k = 0; k < product_count; ++k) {
+            if (products[k].a == &r || products[k].b == &r) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // out must not be read by the plan
+    void evaluate_into(Ring& out) {
+        const simd::Kernels& k = simd::kernels();
+        bool written = false;
+        if constexpr (Products > 0) {
+            fold_scales();
+            accumulate_products(out);
+            written = true;
+        }
+        for (std::size_t t = 0; t < linear_count; ++t) {
+            const auto [a, scale] = linear[t];
+            if (!written) {
+                if (scale == 1) {
+                    out = *a;
+                } else {
+                    k.scalar_mul(out.data(), a->data(), scale, N, Q);
+                }
+                written = true;
+            } else if (scale == 1) {
+                k.add(out.data(), out.data(), a->data(), N, Q);
+            } else if (scale == Q - 1) {
+                k.sub(out.data(), out.data(), a->data(), N, Q);
+            } else {
+                k.scalar_mul_acc(out.data(), a->data(), scale, N, Q);
+            }
+        }
+    }
+
+private:
+    ArenaScope& scope;
+    std::array<LinearTerm, Linear> linear{};
+    std::array<ProductTerm, Products> products{};
+    std::size_t linear_count = 0;
+    std::size_t product_count = 0;
+
+    std::size_t uses(const Ring* a) const {
+        std::size_t count = 0;
+        for (std::size_t p = 0; p < product_count; ++p) {
+            count += (products[p].a == a) + (products[p].b == a);
+        }
+        return count;
+    }
+
+    // A transform cannot be scaled modulo q, so a scaled product multiplies a scaled copy of
+    // one operand: the one fewer products share, and one copy per operand and scale
+    void fold_scales() {
+        std::array<ProductTerm, Products> copies{};
+        std::size_t copy_count = 0;
+        for (std::size_t p = 0; p < product_count; ++p) {
+            ProductTerm& term = products[p];
+            if (term.scale == 1) {
+                continue;
+            }
+            if (uses(term.a) < uses(term.b)) {
+                std::swap(term.a, term.b);
+            }
+            const Ring* scaled = nullptr;
+            for (std::size_t c = 0; c < copy_count; ++c) {
+                if (copies[c].a == term.b && copies[c].scale == term.scale) {
+                    scaled = copies[c].b;
+                }
+            }
+            if (!scaled) {
+                Ring* copy = temporary();
+                simd::kernels().scalar_mul(copy->data(), term.b->data(), term.scale, N, Q);
+                copies[copy_count++] = {term.b, copy, term.scale};
+                scaled = copy;
+            }
+            term.b = scaled;
+            term.scale = 1;
+        }
+    }
+
+    // Operands that appear in several products keep their transform; the rest go through two
+    // scratch buffers. The sum of more than NTT_ACCUMULATION products is inverted in parts.
+    void accumulate_products(Ring& out) {
+        std::array<const Ring*, 2 * Products> shared{};
+        std::array<std::uint32_t*, 2 * Products> transforms{};
+        std::size_t shared_count = 0;
+        std::uint32_t* acc = scope.template allocate<std::uint32_t>(W);
+        std::uint32_t* scratch[2] = {nullptr, nullptr};
+        auto transform = [&](const Ring* a, int slot) -> const std::uint32_t* {
+            if constexpr (Multiplier::coefficient_domain) {
+                return a->data();
+            } else {
+                for (std::size_t s = 0; s < shared_count; ++s) {
+                    if (shared[s] == a) {
+                        return transforms[s];
+                    }
+                }
+                const bool keep = uses(a) > 1;
+                std::uint32_t*& buffer = keep ? transforms[shared_count] : scratch[slot];
+                if (!buffer) {
+                    buffer = scope.template allocate<std::uint32_t>(W);
+                }
+                Multiplier::forward(buffer, a->data());
+                if (keep) {
+                    shared[shared_count++] = a;
+                }
+                return buffer;
+            }
+        };
+
+        Ring* part = nullptr;
+        Multiplier::clear(acc);
+        for (std::size_t p = 0; p < product_count; ++p) {
+            const std::uint32_t* ta = transform(products[p].a, 0);
+            Multiplier::mul_acc(acc, ta, transform(products[p].b, 1));
+            const bool last = p + 1 == product_count;
+            if (last || (p + 1) % NTT_ACCUMULATION == 0) {
+                if (p < NTT_ACCUMULATION) {
+                    Multiplier::inverse(out.data(), acc);
+                } else {
+                    part = part ? part : temporary();
+                    Multiplier::inverse(part->data(), acc);
+                    out += *part;
+                }
+                Multiplier::clear(acc);
+            }
+        }
+    }
+};
+
+// out = the value of expression; out may be one of its operands
+template <class Ring, class E>
+void compute_into(Ring& out, const RingExpression<E, Ring>& expression) {
+    ArenaScope scope;
+    ExpressionPlan<Ring, E::linear_terms, E::product_terms> plan(scope);
+    expression.derived().collect(plan, 1);
+    if (plan.reads(out)) {
+        Ring* result = plan.temporary();
+        plan.evaluate_into(*result);
+        out = *result;
+    } else {
+        plan.evaluate_into(out);
+    }
+}
+
+template <class Derived, class Ring>
+RingExpression<Derived, Ring>::operator Ring() const {
+    Ring result;
+    compute_into(result, *this);
+    return result;
+}
+
+// The entry point: lazy(a) * b + c is an expression, a * b + c two eager operations
+template <class Ring>
+RingTerm<Ring> lazy(const Ring& a) {
+    return RingTerm<Ring>(a);
+}
+
+} // namespace giophantus
+
+#endif
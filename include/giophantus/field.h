@@ -0,0 +1,211 @@
+// Field elements, division-free reduction policies and Montgomery arithmetic
+#ifndef GIOPHANTUS_FIELD_H
+#define GIOPHANTUS_FIELD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "giophantus/instrument.h"
+#include "giophantus/simd.h"
+
+namespace giophantus {
+
+constexpr int MODULO = 17; // Default modulus for the field
+constexpr int DEGREE = 11; // Default polynomial degree limit
+constexpr int NOISE_BOUND = 4; // Default noise magnitude
+
+// Field element: residues are kept in [0, q) with q < 2^31
+using Fq = std::uint32_t;
+
+// Parameter Structure
+struct GiophantusParams {
+    int modulo;
+    int degree;
+    int noise_bound;
+    int block_size;
+};
+
+// Constant-Time Mode
+// Configured with -DGIOPHANTUS_CONSTANT_TIME=ON: every conditional correction on a residue goes
+// through a mask behind an optimization barrier, so the compiler cannot turn it back into a branch.
+// The default build leaves such selections to the compiler, which usually, not always, picks a cmov.
+#ifndef GIOPHANTUS_CONSTANT_TIME
+#define GIOPHANTUS_CONSTANT_TIME 0
+#endif
+
+constexpr bool CONSTANT_TIME = GIOPHANTUS_CONSTANT_TIME != 0;
+
+// x, hidden from the optimizer
+constexpr std::uint32_t value_barrier(std::uint32_t x) {
+#if defined(__GNUC__)
+    if (!std::is_constant_evaluated()) {
+        asm("" : "+r"(x));
+    }
+#endif
+    return x;
+}
+
+// x mod q for x < 2q <= 2^32: x - q wraps past 2^31 exactly when x < q
+constexpr std::uint32_t reduce_once(std::uint32_t x, std::uint32_t q) {
+    if constexpr (CONSTANT_TIME) {
+        const std::uint32_t t = x - q;
+        const std::uint32_t mask = value_barrier(0u - (t >> 31));
+        return t + (q & mask);
+    } else {
+        return x >= q ? x - q : x;
+    }
+}
+
+// Reduction Strategies
+// Each policy maps a 64-bit intermediate to its residue in [0, q) without a hardware division.
+
+// q = 2^k - 1: 2^k = 1 (mod q), so the high bits fold onto the low ones by shift-and-add.
+template <Fq Q>
+struct MersenneReduction {
+    static_assert((Q & (Q + 1)) == 0, "MersenneReduction needs q = 2^k - 1");
+
+    static constexpr int bits = [] {
+        int k = 0;
+        while ((Fq{1} << k) - 1 != Q) {
+            ++k;
+        }
+        return k;
+    }();
+
+    // Any 64-bit input
+    static constexpr Fq reduce(std::uint64_t x) {
+        // ceil(64 / k) folds bring x below 2^k + 1, one conditional subtraction finishes it off
+        for (int i = 0; i < (64 + bits - 1) / bits; ++i) {
+            x = (x & Q) + (x >> bits);
+        }
+        return reduce_once(static_cast<std::uint32_t>(x), Q);
+    }
+};
+
+// General q: floor(x / q) is estimated from the high word of x * floor((2^64 - 1) / q),
+// which undershoots by at most one.
+template <Fq Q>
+struct BarrettReduction {
+    static constexpr std::uint64_t mu = ~std::uint64_t{0} / Q;
+
+    // Any 64-bit input
+    static constexpr Fq reduce(std::uint64_t x) {
+#if defined(__SIZEOF_INT128__)
+        const std::uint64_t quotient = static_cast<std::uint64_t>((static_cast<unsigned __int128>(x) * mu) >> 64);
+        const std::uint64_t r = x - quotient * Q;
+        return reduce_once(static_cast<std::uint32_t>(r), Q);
+#else
+        if constexpr (CONSTANT_TIME) {
+            // Division latency can depend on the dividend: schoolbook high product instead
+            const std::uint64_t x_lo = x & 0xffffffffu, x_hi = x >> 32;
+            const std::uint64_t mu_lo = mu & 0xffffffffu, mu_hi = mu >> 32;
+            const std::uint64_t cross = (x_lo * mu_lo >> 32) + x_hi * mu_lo;
+            const std::uint64_t quotient = x_hi * mu_hi + (cross >> 32) + (((cross & 0xffffffffu) + x_lo * mu_hi) >> 32);
+            return reduce_once(static_cast<std::uint32_t>(x - quotient * Q), Q);
+        } else {
+            return static_cast<Fq>(x % Q);
+        }
+#endif
+    }
+};
+
+// Montgomery arithmetic modulo an odd q < 2^31 with R = 2^32; the modulus is a runtime value
+// so that NTT primes chosen per transform can share it.
+struct Montgomery32 {
+    std::uint32_t q;
+    std::uint32_t qinv; // -q^-1 mod 2^32
+    std::uint32_t r2;   // R^2 mod q
+
+    constexpr explicit Montgomery32(std::uint32_t modulus) : q(modulus), qinv(0), r2(0) {
+        std::uint32_t inv = q; // Newton iteration: each step doubles the correct low bits
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2 - q * inv;
+        }
+        qinv = 0u - inv;
+        const std::uint64_t r = (std::uint64_t{1} << 32) % q;
+        r2 = static_cast<std::uint32_t>(r * r % q);
+    }
+
+    // x * R^-1 mod q for x < q * 2^32
+    constexpr std::uint32_t redc(std::uint64_t x) const {
+        const std::uint32_t m = static_cast<std::uint32_t>(x) * qinv;
+        const std::uint32_t t = static_cast<std::uint32_t>((x + static_cast<std::uint64_t>(m) * q) >> 32);
+        return reduce_once(t, q);
+    }
+
+    // a * b * R^-1 mod q
+    constexpr std::uint32_t mul(std::uint32_t a, std::uint32_t b) const {
+        return redc(static_cast<std::uint64_t>(a) * b);
+    }
+
+    // a * R mod q for any 32-bit a
+    constexpr std::uint32_t to_montgomery(std::uint32_t a) const {
+        return redc(static_cast<std::uint64_t>(a) * r2);
+    }
+
+    // x mod q for x < q * 2^32
+    constexpr std::uint32_t reduce(std::uint64_t x) const {
+        return to_montgomery(redc(x));
+    }
+
+    constexpr std::uint32_t add(std::uint32_t a, std::uint32_t b) const {
+        return reduce_once(a + b, q);
+    }
+
+    constexpr std::uint32_t sub(std::uint32_t a, std::uint32_t b) const {
+        return reduce_once(a + q - b, q);
+    }
+
+    constexpr simd::Modulus kernel_modulus() const {
+        return {q, qinv};
+    }
+};
+
+template <Fq Q>
+struct MontgomeryReduction {
+    static_assert(Q % 2 == 1, "MontgomeryReduction needs an odd modulus");
+
+    static constexpr Montgomery32 montgomery{Q};
+
+    // x < q * 2^32, which covers every product of two reduced operands
+    static constexpr Fq reduce(std::uint64_t x) {
+        return montgomery.reduce(x);
+    }
+};
+
+template <Fq Q>
+using DefaultReduction = std::conditional_t<(Q & (Q + 1)) == 0, MersenneReduction<Q>, BarrettReduction<Q>>;
+
+// Field Arithmetic Utility
+// Operands are expected to be reduced; products go through 64 bits so q = 2^31 - 1 does not overflow.
+template <Fq Q, class Reduction = DefaultReduction<Q>>
+class FieldArithmetic {
+    static_assert(Q > 1 && Q <= 0x7fffffffu, "modulus must fit in 31 bits");
+
+public:
+    static constexpr Fq mod(std::uint64_t a) {
+        if constexpr (INSTRUMENT) {
+            if (!std::is_constant_evaluated()) {
+                instrument::count(instrument::Counter::FieldReductions);
+            }
+        }
+        return Reduction::reduce(a);
+    }
+
+    static constexpr Fq add(Fq a, Fq b) {
+        return reduce_once(a + b, Q);
+    }
+
+    static constexpr Fq sub(Fq a, Fq b) {
+        return reduce_once(a + Q - b, Q);
+    }
+
+    static constexpr Fq mul(Fq a, Fq b) {
+        return mod(static_cast<std::uint64_t>(a) * b);
+    }
+};
+
+} // namespace giophantus
+
+#endif
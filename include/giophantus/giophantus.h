@@ -0,0 +1,30 @@
+// Giophantus cryptosystem: field and ring arithmetic, bivariate polynomials, key generation,
+// encryption and the parallel and scratch-memory infrastructure they run on
+#ifndef GIOPHANTUS_GIOPHANTUS_H
+#define GIOPHANTUS_GIOPHANTUS_H
+
+#include "giophantus/arena.h"
+#include "giophantus/async.h"
+#include "giophantus/bivariate.h"
+#include "giophantus/codec.h"
+#include "giophantus/expression.h"
+#include "giophantus/field.h"
+#include "giophantus/gpu.h"
+#include "giophantus/instrument.h"
+#include "giophantus/key.h"
+#include "giophantus/key_pool.h"
+#include "giophantus/key_store.h"
+#include "giophantus/multiply.h"
+#include "giophantus/params.h"
+#include "giophantus/pke.h"
+#include "giophantus/registry.h"
+#include "giophantus/ring.h"
+#include "giophantus/sampling.h"
+#include "giophantus/small.h"
+#include "giophantus/scheme.h"
+#include "giophantus/sparse.h"
+#include "giophantus/stream.h"
+#include "giophantus/thread_pool.h"
+#include "giophantus/validity.h"
+
+#endif
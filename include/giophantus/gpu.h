@@ -0,0 +1,229 @@
+// Optional CUDA offload of the X * r products of batch encryption
+#ifndef GIOPHANTUS_GPU_H
+#define GIOPHANTUS_GPU_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "giophantus/multiply.h"
+#include "giophantus/params.h"
+#include "giophantus/sampling.h"
+#include "giophantus/scheme.h"
+
+namespace giophantus {
+
+// Ciphertext term out += public key term x * blinding term r
+struct GpuProduct {
+    std::uint32_t out;
+    std::uint32_t x;
+    std::uint32_t r;
+};
+
+// Shape of one parameter set on the device: the zero-padded NTT over the first `primes` NTT
+// primes that the CPU multiplier uses, and which products make up every ciphertext term
+struct GpuLayout {
+    std::size_t n;
+    Fq q;
+    std::size_t transform_size;
+    std::size_t primes;
+    std::size_t x_terms;
+    std::size_t r_terms;
+    std::size_t c_terms;
+    std::vector<GpuProduct> products;
+};
+
+// Device state for one public key: its term transforms, stay resident, and two staging slots,
+// each with pinned host buffers, device buffers for `batch` messages and its own stream. While
+// one slot's copies and kernels run the host fills or drains the other.
+// Built with -DGIOPHANTUS_CUDA=ON; otherwise available() is false and no engine is ever ok().
+class GpuBatchEngine {
+public:
+    static constexpr int SLOTS = 2;
+
+    // Compiled with CUDA and at least one device present
+    static bool available();
+
+    GpuBatchEngine(const GpuLayout& layout, const Fq* x_coefficients, std::size_t batch);
+    ~GpuBatchEngine();
+
+    GpuBatchEngine(const GpuBatchEngine&) = delete;
+    GpuBatchEngine& operator=(const GpuBatchEngine&) = delete;
+
+    // False when the device could not be set up; nothing else may be called then
+    bool ok() const;
+
+    std::size_t batch() const;
+
+    // Pinned staging: r terms of up to batch messages (message, term, coefficient), and the
+    // (X * r) terms the slot produces in the same order
+    std::uint32_t* blinding(int slot);
+    const std::uint32_t* products(int slot) const;
+
+    // Queues upload, transforms, products, inverse transforms and download of count messages
+    bool submit(int slot, std::size_t count);
+    // Blocks until the slot's last submission finished; false on a device error
+    bool wait(int slot);
+
+private:
+    struct Device;
+    std::unique_ptr<Device> device;
+};
+
+// EncryptionContext with the ring products on the GPU. The randomness is drawn from rng
+// exactly as EncryptionContext::encrypt_many draws it, message by message (r, then e), and
+// the device computes the same exact products, so both produce identical ciphertexts. Without
+// a usable device it is EncryptionContext.
+template <class Params>
+class GpuEncryptionContext {
+public:
+    using Ring = typename Params::Ring;
+    using PublicPoly = typename Params::PublicPoly;
+    using Ciphertext = typename Params::Ciphertext;
+    using Blinding = Pq<Ring, Params::dr>;
+    using Noise = Pq<Ring, Params::dc>;
+
+    static constexpr std::size_t DEFAULT_BATCH = 256;
+
+    static GpuLayout layout() {
+        GpuLayout l{Params::N,
+                    Params::Q,
+                    ntt_transform_size(Params::N),
+                    ntt_prime_count(Params::N, Params::Q),
+                    PublicPoly::terms,
+                    Blinding::terms,
+                    Ciphertext::terms,
+                    {}};
+        for (std::size_t c = 0; c < Ciphertext::terms; ++c) {
+            const auto [i, j] = Ciphertext::exponents[c];
+            for (std::size_t x = 0; x < PublicPoly::terms; ++x) {
+                const auto [xi, xj] = PublicPoly::exponents[x];
+                if (xi <= i && xj <= j && (i - xi) + (j - xj) <= Params::dr) {
+                    l.products.push_back({static_cast<std::uint32_t>(c), static_cast<std::uint32_t>(x),
+                                          static_cast<std::uint32_t>(Blinding::index(i - xi, j - xj))});
+                }
+            }
+        }
+        return l;
+    }
+
+    explicit GpuEncryptionContext(const PublicPoly& X, std::size_t batch = DEFAULT_BATCH) : cpu(X) {
+        if (GpuBatchEngine::available()) {
+            std::vector<Fq> coefficients(PublicPoly::terms * Params::N);
+            for (std::size_t k = 0; k < PublicPoly::terms; ++k) {
+                std::copy(X[k].begin(), X[k].end(), coefficients.begin() + k * Params::N);
+            }
+            engine = std::make_unique<GpuBatchEngine>(layout(), coefficients.data(), std::max<std::size_t>(batch, 1));
+            if (!engine->ok()) {
+                engine.reset();
+            }
+        }
+    }
+
+    // Whether batches run on the device
+    bool on_device() const {
+        return engine != nullptr;
+    }
+
+    const EncryptionContext<Params>& host() const {
+        return cpu;
+    }
+
+    // Same contract as EncryptionContext::encrypt_many. After a device error the chunks still
+    // in flight, and every later one, are multiplied on the host from the staged r terms.
+    void encrypt_many(std::span<const Ring> messages, std::span<Ciphertext> ciphertexts, RandomPolynomialGenerator& rng) {
+        assert(messages.size() == ciphertexts.size());
+        if (engine == nullptr) {
+            cpu.encrypt_many(messages, ciphertexts, rng);
+            return;
+        }
+        GIOPHANTUS_PHASE(Encrypt);
+        const std::size_t batch = engine->batch();
+        Chunk chunks[GpuBatchEngine::SLOTS];
+        bool healthy = true;
+
+        // Chunk k goes to slot k % 2: finish what the slot ran before, then sample and submit
+        std::size_t k = 0;
+        for (std::size_t start = 0; start < messages.size(); start += batch, ++k) {
+            const int slot = static_cast<int>(k % GpuBatchEngine::SLOTS);
+            Chunk& chunk = chunks[slot];
+            healthy = finish(slot, chunk, healthy, messages, ciphertexts);
+            chunk.first = start;
+            chunk.count = std::min(batch, messages.size() - start);
+            chunk.noise.resize(chunk.count);
+            std::uint32_t* r = engine->blinding(slot);
+            for (std::size_t m = 0; m < chunk.count; ++m) {
+                Blinding blinding;
+                rng.fill_terms(blinding, Params::Q);
+                rng.fill_terms(chunk.noise[m], Params::noise_bound);
+                for (std::size_t t = 0; t < Blinding::terms; ++t) {
+                    std::copy(blinding[t].begin(), blinding[t].end(), r + (m * Blinding::terms + t) * Params::N);
+                }
+            }
+            healthy = healthy && engine->submit(slot, chunk.count);
+        }
+        for (int slot = 0; slot < GpuBatchEngine::SLOTS; ++slot) {
+            healthy = finish(slot, chunks[slot], healthy, messages, ciphertexts);
+        }
+        if (!healthy) {
+            engine.reset();
+        }
+    }
+
+private:
+    struct Chunk {
+        std::size_t first = 0;
+        std::size_t count = 0;
+        std::vector<Noise> noise;
+    };
+
+    EncryptionContext<Params> cpu;
+    std::vector<GpuProduct> plan = layout().products;
+    std::unique_ptr<GpuBatchEngine> engine;
+
+    // Completes the slot's chunk, c = (X * r) + L * e + m, taking X * r from the device while
+    // it is healthy and computing it from the staged r otherwise; returns the new health
+    bool finish(int slot, Chunk& chunk, bool healthy, std::span<const Ring> messages, std::span<Ciphertext> ciphertexts) {
+        if (chunk.count == 0) {
+            return healthy;
+        }
+        healthy = healthy && engine->wait(slot);
+        const std::uint32_t* products = engine->products(slot);
+        const std::uint32_t* r = engine->blinding(slot);
+        for (std::size_t m = 0; m < chunk.count; ++m) {
+            Ciphertext& c = ciphertexts[chunk.first + m];
+            if (healthy) {
+                for (std::size_t t = 0; t < Ciphertext::terms; ++t) {
+                    const std::uint32_t* term = products + (m * Ciphertext::terms + t) * Params::N;
+                    std::copy(term, term + Params::N, c[t].begin());
+                }
+            } else {
+                c = Ciphertext();
+                for (const GpuProduct& p : plan) {
+                    const std::uint32_t* term = r + (m * Blinding::terms + p.r) * Params::N;
+                    Ring blinding;
+                    std::copy(term, term + Params::N, blinding.begin());
+                    c[p.out] += cpu.public_key()[p.x] * blinding;
+                }
+            }
+            Noise& e = chunk.noise[m];
+            e *= Params::noise_bound;
+            for (std::size_t i = 0; i <= Params::dc; ++i) {
+                for (std::size_t j = 0; i + j <= Params::dc; ++j) {
+                    c(i, j) += e(i, j);
+                }
+            }
+            c(0, 0) += messages[chunk.first + m];
+        }
+        chunk.count = 0;
+        return healthy;
+    }
+};
+
+} // namespace giophantus
+
+#endif
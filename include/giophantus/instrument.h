@@ -0,0 +1,206 @@
+// Optional hot-path counters, phase latency histograms and trace markers
+#ifndef GIOPHANTUS_INSTRUMENT_H
+#define GIOPHANTUS_INSTRUMENT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Configured with -DGIOPHANTUS_INSTRUMENT=ON. Otherwise every hook below is an empty inline
+// function or expands to nothing, and the hot paths compile exactly as without them.
+#ifndef GIOPHANTUS_INSTRUMENT
+#define GIOPHANTUS_INSTRUMENT 0
+#endif
+
+#if GIOPHANTUS_INSTRUMENT && defined(GIOPHANTUS_TRACY)
+#include <tracy/Tracy.hpp>
+#endif
+
+namespace giophantus {
+
+constexpr bool INSTRUMENT = GIOPHANTUS_INSTRUMENT != 0;
+
+namespace instrument {
+
+enum class Counter {
+    RingMultiplies,   // ring products, in the coefficient or the transform domain
+    Transforms,       // forward and inverse NTTs
+    FieldReductions,  // FieldArithmetic::mod and mul; the vector kernels are not counted
+    SamplesDrawn,     // coefficients drawn by RandomPolynomialGenerator
+    ArenaAllocations, // ScratchArena allocations
+    ArenaBytes,       // bytes they requested
+    ArenaBlocks,      // blocks the arenas obtained from the heap
+    Count,
+};
+
+enum class Phase {
+    KeyGen,  // GiophantusKeyGen::generate
+    Encrypt, // one EncryptionContext::encrypt_many call (one message for encrypt())
+    Decrypt, // one decryption
+    Count,
+};
+
+constexpr std::size_t COUNTERS = static_cast<std::size_t>(Counter::Count);
+constexpr std::size_t PHASES = static_cast<std::size_t>(Phase::Count);
+
+// Latency buckets: bucket b < LAST_BUCKET holds durations below 2^(b + 10) ns (1 us, 2 us, ...,
+// about 8.6 s); LAST_BUCKET the rest
+constexpr std::size_t BUCKETS = 24;
+constexpr std::size_t LAST_BUCKET = BUCKETS - 1;
+constexpr unsigned FIRST_BUCKET_BITS = 10;
+
+const char* counter_name(Counter counter);
+const char* phase_name(Phase phase);
+
+struct Snapshot {
+    std::uint64_t counters[COUNTERS] = {};
+    std::uint64_t phase_count[PHASES] = {};
+    std::uint64_t phase_nanoseconds[PHASES] = {};
+    std::uint64_t histogram[PHASES][BUCKETS] = {};
+
+    std::uint64_t operator[](Counter counter) const {
+        return counters[static_cast<std::size_t>(counter)];
+    }
+};
+
+// Totals over every thread so far, including threads that have exited
+Snapshot snapshot();
+
+// Zeroes all totals; counts made concurrently may be lost
+void reset();
+
+// Prometheus text exposition of snapshot(): giophantus_<counter>_total counters and one
+// giophantus_phase_seconds histogram labelled by phase
+std::string prometheus_text();
+
+// Called after every phase with its duration, on the thread that ran it. Install before
+// starting workers; null removes it.
+using PhaseCallback = void (*)(Phase phase, std::uint64_t nanoseconds, void* user);
+void set_phase_callback(PhaseCallback callback, void* user);
+
+// Trace markers: begin(name) and end(name) around every phase and traced region, e.g. to start
+// and stop Tracy zones or emit USDT probes. Without hooks the markers go to the out-of-line
+// functions trace_begin and trace_end, which perf can attach uprobes to. Building with
+// GIOPHANTUS_TRACY turns the markers into Tracy zones instead.
+using TraceHook = void (*)(const char* name);
+void set_trace_hooks(TraceHook begin, TraceHook end);
+void trace_begin(const char* name);
+void trace_end(const char* name);
+
+namespace detail {
+
+// Counts of one thread; only that thread writes them
+struct ThreadCounters {
+    std::atomic<std::uint64_t> counters[COUNTERS] = {};
+    std::atomic<std::uint64_t> phase_count[PHASES] = {};
+    std::atomic<std::uint64_t> phase_nanoseconds[PHASES] = {};
+    std::atomic<std::uint64_t> histogram[PHASES][BUCKETS] = {};
+};
+
+// Registers the calling thread's counters, folded into the totals when it exits
+ThreadCounters* attach_thread();
+void record_phase(Phase phase, std::uint64_t nanoseconds);
+
+inline thread_local ThreadCounters* current = nullptr;
+
+inline ThreadCounters& local() {
+    ThreadCounters* counters = current;
+    return counters != nullptr ? *counters : *(current = attach_thread());
+}
+
+// Single-writer increment: no locked instruction
+inline void bump(std::atomic<std::uint64_t>& slot, std::uint64_t n) {
+    slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+inline void count([[maybe_unused]] Counter counter, [[maybe_unused]] std::uint64_t n = 1) {
+    if constexpr (INSTRUMENT) {
+        detail::bump(detail::local().counters[static_cast<std::size_t>(counter)], n);
+    }
+}
+
+// Times its lifetime as one phase and marks it for tracing
+class ScopedPhase {
+public:
+    explicit ScopedPhase([[maybe_unused]] Phase phase) {
+        if constexpr (INSTRUMENT) {
+            this->phase = phase;
+#ifndef GIOPHANTUS_TRACY
+            trace_begin(phase_name(phase));
+#endif
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedPhase() {
+        if constexpr (INSTRUMENT) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            detail::record_phase(phase, static_cast<std::uint64_t>(elapsed.count()));
+#ifndef GIOPHANTUS_TRACY
+            trace_end(phase_name(phase));
+#endif
+        }
+    }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+    Phase phase{};
+    std::chrono::steady_clock::time_point start{};
+};
+
+// Trace marker around a region that is not a phase
+class TraceScope {
+public:
+    explicit TraceScope([[maybe_unused]] const char* name) {
+        if constexpr (INSTRUMENT) {
+            this->name = name;
+            trace_begin(name);
+        }
+    }
+
+    ~TraceScope() {
+        if constexpr (INSTRUMENT) {
+            trace_end(name);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name = nullptr;
+};
+
+} // namespace instrument
+
+} // namespace giophantus
+
+#define GIOPHANTUS_INSTRUMENT_CAT2(a, b) a##b
+#define GIOPHANTUS_INSTRUMENT_CAT(a, b) GIOPHANTUS_INSTRUMENT_CAT2(a, b)
+
+// GIOPHANTUS_PHASE(KeyGen) times the rest of the enclosing scope as that phase;
+// GIOPHANTUS_TRACE_SCOPE("name") marks it for tracing only
+#if GIOPHANTUS_INSTRUMENT && defined(GIOPHANTUS_TRACY)
+#define GIOPHANTUS_PHASE(phase)                                                                         \
+    ZoneScopedN("giophantus::" #phase);                                                                 \
+    const ::giophantus::instrument::ScopedPhase GIOPHANTUS_INSTRUMENT_CAT(giophantus_phase_, __LINE__)( \
+        ::giophantus::instrument::Phase::phase)
+#define GIOPHANTUS_TRACE_SCOPE(name) ZoneScopedN(name)
+#elif GIOPHANTUS_INSTRUMENT
+#define GIOPHANTUS_PHASE(phase)                                                                         \
+    const ::giophantus::instrument::ScopedPhase GIOPHANTUS_INSTRUMENT_CAT(giophantus_phase_, __LINE__)( \
+        ::giophantus::instrument::Phase::phase)
+#define GIOPHANTUS_TRACE_SCOPE(name) \
+    const ::giophantus::instrument::TraceScope GIOPHANTUS_INSTRUMENT_CAT(giophantus_trace_, __LINE__)(name)
+#else
+#define GIOPHANTUS_PHASE(phase) static_cast<void>(0)
+#define GIOPHANTUS_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif
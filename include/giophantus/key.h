@@ -0,0 +1,27 @@
+// Secret and public key of one parameter set
+#ifndef GIOPHANTUS_KEY_H
+#define GIOPHANTUS_KEY_H
+
+namespace giophantus {
+
+// Encryption/Decryption Keys
+template <class Params>
+class GiophantusKey {
+public:
+    using Ring = typename Params::Ring;
+    using Secret = typename Params::Secret;
+    using PublicPoly = typename Params::PublicPoly;
+
+    // The secrets take bits per coefficient (N / 4 bytes each for L = 4), the public terms a
+    // 32-bit word
+    Secret ux, uy;
+    PublicPoly X;
+
+    GiophantusKey() = default;
+    GiophantusKey(const Secret& ux, const Secret& uy, const PublicPoly& X)
+        : ux(ux), uy(uy), X(X) {}
+};
+
+} // namespace giophantus
+
+#endif
@@ -0,0 +1,236 @@
+// Pool of keys generated ahead of time on background threads
+#ifndef GIOPHANTUS_KEY_POOL_H
+#define GIOPHANTUS_KEY_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "giophantus/key.h"
+#include "giophantus/scheme.h"
+
+namespace giophantus {
+
+// Bounded multi-producer multi-consumer ring (Vyukov). Every cell carries a sequence number:
+// a cell at position p is free for the push of p when it equals p and holds the value for the
+// pop of p when it equals p + 1. Producers and consumers claim positions with one CAS on their
+// own index and never wait for each other.
+template <class T>
+class MpmcRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit MpmcRing(std::size_t capacity) : mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), cells(new Cell[mask + 1]) {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+    // False when full
+    bool try_push(T&& value) {
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+            if (lag == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // False when empty
+    bool try_pop(T& value) {
+        std::size_t position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+            if (lag == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    const std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
+
+struct KeyPoolConfig {
+    std::size_t capacity = 64;      // keys held at most
+    std::size_t low_watermark = 16; // taking the depth below this refills the pool to capacity
+    std::size_t threads = 1;        // background generators
+};
+
+struct KeyPoolStats {
+    std::size_t depth = 0;       // keys ready now
+    std::uint64_t generated = 0; // by the background threads
+    std::uint64_t served = 0;    // handed out from the pool
+    std::uint64_t misses = 0;    // take() calls that found it empty and generated inline
+    std::uint64_t refills = 0;   // times a take crossed the low watermark
+};
+
+// Ephemeral keys without keygen latency: background threads fill the pool up to capacity,
+// sleep, and start again once takes bring it below the low watermark. take() and try_take()
+// are a pop from the ring and a few atomic updates, plus a futex wake when they cross the
+// watermark; they never wait for a generator. The threads are the pool's own, not a
+// ThreadPool's, since they sleep between refills.
+template <class Params>
+class KeyPool {
+public:
+    using Key = GiophantusKey<Params>;
+
+    explicit KeyPool(const KeyPoolConfig& config = {})
+        : capacity(std::max<std::size_t>(config.capacity, 1)),
+          low_watermark(std::min(std::max<std::size_t>(config.low_watermark, 1), capacity)), ring(capacity) {
+        for (std::size_t i = 0; i < std::max<std::size_t>(config.threads, 1); ++i) {
+            threads.emplace_back([this] { run_generator(); });
+        }
+    }
+
+    ~KeyPool() {
+        stopping.store(true);
+        wake_generators();
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    }
+
+    KeyPool(const KeyPool&) = delete;
+    KeyPool& operator=(const KeyPool&) = delete;
+
+    // A pooled key, or a fresh one from the calling thread when the pool is empty
+    Key take() {
+        Key key;
+        if (!try_take(key)) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            key = GiophantusKeyGen::generate<Params>();
+        }
+        return key;
+    }
+
+    // False, leaving key as it was, when no key is ready
+    bool try_take(Key& key) {
+        if (!ring.try_pop(key)) {
+            return false;
+        }
+        ready.fetch_sub(1, std::memory_order_relaxed);
+        served.fetch_add(1, std::memory_order_relaxed);
+        if (stock.fetch_sub(1) == low_watermark) {
+            refills.fetch_add(1, std::memory_order_relaxed);
+            wake_generators();
+        }
+        return true;
+    }
+
+    // Counters are read one by one, so a snapshot under load is only approximately consistent
+    KeyPoolStats stats() const {
+        KeyPoolStats s;
+        s.depth = ready.load(std::memory_order_relaxed);
+        s.generated = generated.load(std::memory_order_relaxed);
+        s.served = served.load(std::memory_order_relaxed);
+        s.misses = misses.load(std::memory_order_relaxed);
+        s.refills = refills.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    std::size_t depth() const {
+        return ready.load(std::memory_order_relaxed);
+    }
+
+private:
+    const std::size_t capacity;
+    const std::size_t low_watermark;
+    MpmcRing<Key> ring;
+    std::vector<std::thread> threads;
+
+    // Keys in the ring plus keys being generated; never above capacity, so pushes succeed
+    std::atomic<std::size_t> stock{0};
+    std::atomic<std::size_t> ready{0};
+    // Bumped to wake sleeping generators
+    std::atomic<std::uint32_t> epoch{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<std::uint64_t> generated{0}, served{0}, misses{0}, refills{0};
+
+    void wake_generators() {
+        epoch.fetch_add(1);
+        epoch.notify_all();
+    }
+
+    bool claim() {
+        std::size_t s = stock.load();
+        while (s < capacity) {
+            if (stock.compare_exchange_weak(s, s + 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run_generator() {
+        while (!stopping.load()) {
+            if (claim()) {
+                Key key = GiophantusKeyGen::generate<Params>();
+                // Counted before the push, so a racing take never brings either below zero or
+                // shows a depth the generated count has not reached
+                generated.fetch_add(1, std::memory_order_relaxed);
+                ready.fetch_add(1, std::memory_order_relaxed);
+                if (!ring.try_push(std::move(key))) {
+                    // Not expected while stock bounds the ring; give the slot back rather than
+                    // leak it, and let the next round generate again
+                    ready.fetch_sub(1, std::memory_order_relaxed);
+                    generated.fetch_sub(1, std::memory_order_relaxed);
+                    stock.fetch_sub(1);
+                }
+                continue;
+            }
+            // Full: sleep until a take crosses the low watermark. The epoch is read before the
+            // depth, so a crossing between the two ends the wait at once.
+            const std::uint32_t seen = epoch.load();
+            if (stopping.load() || stock.load() < low_watermark) {
+                continue;
+            }
+            epoch.wait(seen);
+        }
+    }
+};
+
+} // namespace giophantus
+
+#endif
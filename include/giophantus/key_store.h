@@ -0,0 +1,270 @@
+// Memory-mapped key store: fixed-stride records of encoded keys, optionally with their transforms
+#ifndef GIOPHANTUS_KEY_STORE_H
+#define GIOPHANTUS_KEY_STORE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "giophantus/codec.h"
+#include "giophantus/key.h"
+#include "giophantus/scheme.h"
+
+namespace giophantus {
+
+// Read-only mapping of a whole file (mmap, or MapViewOfFile on Windows)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    const std::uint8_t* data() const { return bytes; }
+    std::size_t size() const { return length; }
+
+private:
+    const std::uint8_t* bytes = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+// File layout, all integers in the writer's byte order:
+//
+//   header     KeyStoreHeader, padded to RECORDS_OFFSET
+//   records    count records of stride bytes, sorted by id:
+//                id          8 bytes, padded to 64
+//                secret key  ByteLayout::secret_key bytes (ux || uy || X), padded to 64
+//                transforms  with KEY_STORE_TRANSFORMS: the EncryptionContext then the
+//                            DecryptionContext tables, as 32-bit words
+//
+// Transforms are the NTT images of this build, so they are only used when the header's
+// transform_words and byte order match; otherwise they are recomputed on first use.
+struct KeyStoreHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t n;
+    std::uint64_t q;
+    std::uint64_t noise_bound;
+    std::uint64_t flags;
+    std::uint64_t transform_words;
+    std::uint64_t count;
+    std::uint64_t stride;
+    std::uint64_t records;
+};
+
+constexpr char KEY_STORE_MAGIC[8] = {'G', 'I', 'O', 'K', 'E', 'Y', 'S', '\0'};
+constexpr std::uint32_t KEY_STORE_VERSION = 1;
+constexpr std::uint32_t KEY_STORE_BYTE_ORDER = 0x01020304;
+constexpr std::uint64_t KEY_STORE_TRANSFORMS = 1;
+constexpr std::size_t KEY_STORE_RECORDS_OFFSET = 4096;
+
+// Keys looked up by id in a mapped store. Opening only validates the header; each key is
+// decoded and given its encryption and decryption contexts the first time it is used.
+template <class Params>
+class KeyStore {
+public:
+    using Layout = ByteLayout<Params>;
+
+    // What a key turns into on first use
+    struct PreparedKey {
+        GiophantusKey<Params> key;
+        EncryptionContext<Params> encryption;
+        DecryptionContext<Params> decryption;
+    };
+
+private:
+    using Multiplier = typename Params::Ring::Multiplier;
+
+    static constexpr std::size_t ALIGN = 64;
+    static constexpr std::size_t KEY_OFFSET = ALIGN;
+    static constexpr std::size_t TRANSFORMS_OFFSET = (KEY_OFFSET + Layout::secret_key + ALIGN - 1) / ALIGN * ALIGN;
+    static constexpr std::size_t TRANSFORM_BYTES =
+        (EncryptionContext<Params>::TRANSFORM_WORDS + DecryptionContext<Params>::TRANSFORM_WORDS) * sizeof(std::uint32_t);
+
+    static constexpr std::size_t stride(bool transforms) {
+        return transforms ? TRANSFORMS_OFFSET + (TRANSFORM_BYTES + ALIGN - 1) / ALIGN * ALIGN : TRANSFORMS_OFFSET;
+    }
+
+    struct Slot {
+        std::once_flag once;
+        std::unique_ptr<PreparedKey> prepared;
+    };
+
+    MappedFile file;
+    KeyStoreHeader header{};
+    bool mapped_transforms = false;
+    std::unique_ptr<Slot[]> slots;
+
+    const std::uint8_t* record(std::size_t index) const {
+        return file.data() + header.records + index * header.stride;
+    }
+
+    static KeyStoreHeader make_header(std::size_t count, bool transforms) {
+        KeyStoreHeader h{};
+        std::memcpy(h.magic, KEY_STORE_MAGIC, sizeof(h.magic));
+        h.version = KEY_STORE_VERSION;
+        h.byte_order = KEY_STORE_BYTE_ORDER;
+        h.n = Params::N;
+        h.q = Params::Q;
+        h.noise_bound = Params::noise_bound;
+        h.flags = transforms ? KEY_STORE_TRANSFORMS : 0;
+        h.transform_words = transforms ? Multiplier::transform_words : 0;
+        h.count = count;
+        h.stride = stride(transforms);
+        h.records = KEY_STORE_RECORDS_OFFSET;
+        return h;
+    }
+
+    void prepare(Slot& slot, std::size_t index) const {
+        const std::uint8_t* r = record(index);
+        GiophantusKey<Params> key;
+        if (!ByteCodec::decode(key, r + KEY_OFFSET)) {
+            return;
+        }
+        if (mapped_transforms) {
+            const auto* tables = reinterpret_cast<const std::uint32_t*>(r + TRANSFORMS_OFFSET);
+            slot.prepared.reset(new PreparedKey{key, EncryptionContext<Params>(key.X, tables),
+                                                DecryptionContext<Params>(key, tables + EncryptionContext<Params>::TRANSFORM_WORDS)});
+        } else {
+            slot.prepared.reset(new PreparedKey{key, EncryptionContext<Params>(key.X), DecryptionContext<Params>(key)});
+        }
+    }
+
+public:
+    // Writes keys[k] under ids[k]; ids must be distinct. With transforms every record also carries
+    // its precomputed tables, which makes first use a matter of page faults.
+    static bool write(const char* path, std::span<const std::uint64_t> ids, std::span<const GiophantusKey<Params>> keys,
+                      bool transforms = false) {
+        if (ids.size() != keys.size()) {
+            return false;
+        }
+        std::vector<std::size_t> order(ids.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return ids[a] < ids[b]; });
+        for (std::size_t k = 1; k < order.size(); ++k) {
+            if (ids[order[k - 1]] == ids[order[k]]) {
+                return false;
+            }
+        }
+
+        std::FILE* out = std::fopen(path, "wb");
+        if (out == nullptr) {
+            return false;
+        }
+        const KeyStoreHeader h = make_header(ids.size(), transforms);
+        std::vector<std::uint8_t> block(std::max<std::size_t>(KEY_STORE_RECORDS_OFFSET, h.stride));
+        std::memcpy(block.data(), &h, sizeof(h));
+        bool ok = std::fwrite(block.data(), 1, KEY_STORE_RECORDS_OFFSET, out) == KEY_STORE_RECORDS_OFFSET;
+
+        for (std::size_t k = 0; ok && k < order.size(); ++k) {
+            const GiophantusKey<Params>& key = keys[order[k]];
+            std::fill(block.begin(), block.end(), 0);
+            std::memcpy(block.data(), &ids[order[k]], sizeof(std::uint64_t));
+            ByteCodec::encode(block.data() + KEY_OFFSET, key);
+            if (transforms) {
+                const EncryptionContext<Params> encryption(key.X);
+                const DecryptionContext<Params> decryption(key);
+                std::uint8_t* tables = block.data() + TRANSFORMS_OFFSET;
+                std::memcpy(tables, encryption.transforms(), EncryptionContext<Params>::TRANSFORM_WORDS * sizeof(std::uint32_t));
+                std::memcpy(tables + EncryptionContext<Params>::TRANSFORM_WORDS * sizeof(std::uint32_t), decryption.transforms(),
+                            DecryptionContext<Params>::TRANSFORM_WORDS * sizeof(std::uint32_t));
+            }
+            ok = std::fwrite(block.data(), 1, h.stride, out) == h.stride;
+        }
+        return std::fclose(out) == 0 && ok;
+    }
+
+    // Maps path; false when it is missing, truncated or written for another parameter set
+    bool open(const char* path) {
+        slots.reset();
+        mapped_transforms = false;
+        if (!file.open(path) || file.size() < KEY_STORE_RECORDS_OFFSET) {
+            file.close();
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        // Records sit at the fixed offset so the mapped transforms stay aligned for 32-bit reads
+        const KeyStoreHeader expected = make_header(header.count, (header.flags & KEY_STORE_TRANSFORMS) != 0);
+        const bool compatible = std::memcmp(header.magic, KEY_STORE_MAGIC, sizeof(header.magic)) == 0 &&
+                                header.version == KEY_STORE_VERSION && header.byte_order == KEY_STORE_BYTE_ORDER &&
+                                header.n == expected.n && header.q == expected.q && header.noise_bound == expected.noise_bound &&
+                                header.stride >= TRANSFORMS_OFFSET && header.records == KEY_STORE_RECORDS_OFFSET &&
+                                header.count <= (file.size() - header.records) / header.stride;
+        if (!compatible) {
+            file.close();
+            return false;
+        }
+        // Tables written by a build with another transform size are ignored
+        mapped_transforms = (header.flags & KEY_STORE_TRANSFORMS) != 0 && header.transform_words == Multiplier::transform_words &&
+                            header.stride == stride(true);
+        slots.reset(new Slot[header.count]);
+        return true;
+    }
+
+    std::size_t size() const {
+        return slots ? header.count : 0;
+    }
+
+    // Whether first use maps the stored tables instead of computing them
+    bool has_transforms() const {
+        return mapped_transforms;
+    }
+
+    std::uint64_t id(std::size_t index) const {
+        std::uint64_t value;
+        std::memcpy(&value, record(index), sizeof(value));
+        return value;
+    }
+
+    // Binary search over the sorted ids; false when id is not stored
+    bool find(std::uint64_t key_id, std::size_t& index) const {
+        std::size_t lo = 0, hi = size();
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (id(mid) < key_id) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        index = lo;
+        return lo < size() && id(lo) == key_id;
+    }
+
+    // The encoded key in place, without preparing it
+    SecretKeyView<Params> secret_key(std::size_t index) const {
+        return SecretKeyView<Params>(record(index) + KEY_OFFSET);
+    }
+
+    // The prepared key, built by the first caller for this id; null when the id is unknown or
+    // the stored key is not reduced modulo q. Safe to call from several threads.
+    const PreparedKey* get(std::uint64_t key_id) {
+        std::size_t index;
+        if (!find(key_id, index)) {
+            return nullptr;
+        }
+        Slot& slot = slots[index];
+        std::call_once(slot.once, [&] { prepare(slot, index); });
+        return slot.prepared.get();
+    }
+};
+
+} // namespace giophantus
+
+#endif
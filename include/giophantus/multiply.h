@@ -0,0 +1,371 @@
+// Ring multiplication backends: schoolbook and multi-prime NTT
+#ifndef GIOPHANTUS_MULTIPLY_H
+#define GIOPHANTUS_MULTIPLY_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "giophantus/arena.h"
+#include "giophantus/field.h"
+#include "giophantus/instrument.h"
+#include "giophantus/simd.h"
+
+namespace giophantus {
+
+// Multiplication Backends
+// A backend maps ring elements to a "transform" buffer in which products can be accumulated;
+// Pq-level code can then share transforms between many ring products and invert once per output.
+enum class MulBackend {
+    Schoolbook,
+    Ntt,
+    Automatic, // schoolbook below NTT_CROSSOVER coefficients, NTT above
+};
+
+constexpr std::size_t NTT_CROSSOVER = 64;
+
+// Quadratic cyclic convolution; the transform is the coefficient vector itself.
+template <std::size_t N, Fq Q, class Reduction = DefaultReduction<Q>>
+struct SchoolbookMultiplier {
+    using Field = FieldArithmetic<Q, Reduction>;
+    static constexpr std::size_t transform_words = N;
+    static constexpr bool coefficient_domain = true;
+
+    // Lazy reduction bound: a 64-bit accumulator that starts below q takes lazy_terms products
+    // of reduced operands, each at most (q - 1)^2, before it can overflow
+    static constexpr std::uint64_t lazy_terms = (~std::uint64_t{0} - (Q - 1)) / (std::uint64_t{Q - 1} * (Q - 1) + (Q == 1));
+    // Rows summed between two reductions of the wide accumulators
+    static constexpr std::size_t lazy_rows = lazy_terms < N ? static_cast<std::size_t>(lazy_terms) : N;
+    // Below LAZY_MIN_ROWS the extra passes over 64-bit accumulators cost more than the per-product
+    // Shoup reductions they replace (q near 2^31 allows only four rows)
+    static constexpr std::size_t LAZY_MIN_ROWS = 16;
+    static constexpr bool lazy = lazy_rows >= LAZY_MIN_ROWS || lazy_rows == N;
+
+    static void clear(std::uint32_t* t) {
+        std::fill(t, t + transform_words, 0);
+    }
+
+    static void forward(std::uint32_t* t, const Fq* a) {
+        std::copy(a, a + N, t);
+    }
+
+    // acc += a * b in Rq: row i adds a[i] * b shifted by i, wrapping t^(i + j) to t^(i + j - N).
+    // Lazily the rows go into 64-bit sums that are reduced every lazy_rows rows and at the end,
+    // N reductions per lazy_rows rows instead of one per product.
+    static void mul_acc(std::uint32_t* acc, const std::uint32_t* a, const std::uint32_t* b) {
+        instrument::count(instrument::Counter::RingMultiplies);
+        const simd::Kernels& k = simd::kernels();
+        if constexpr (lazy) {
+            ArenaScope scope;
+            std::uint64_t* wide = scope.allocate<std::uint64_t>(N);
+            std::copy(acc, acc + N, wide);
+            for (std::size_t i = 0; i < N; ++i) {
+                k.mul_acc_wide(wide + i, b, a[i], N - i);
+                k.mul_acc_wide(wide, b + (N - i), a[i], i);
+                if (lazy_rows < N && (i + 1) % lazy_rows == 0) {
+                    for (std::size_t j = 0; j < N; ++j) {
+                        wide[j] = Field::mod(wide[j]);
+                    }
+                }
+            }
+            for (std::size_t j = 0; j < N; ++j) {
+                acc[j] = Field::mod(wide[j]);
+            }
+        } else {
+            for (std::size_t i = 0; i < N; ++i) {
+                k.scalar_mul_acc(acc + i, b, a[i], N - i, Q);
+                k.scalar_mul_acc(acc, b + (N - i), a[i], i, Q);
+            }
+        }
+    }
+
+    static void inverse(Fq* c, std::uint32_t* t) {
+        std::copy(t, t + N, c);
+    }
+
+    static void mul(Fq* c, const Fq* a, const Fq* b) {
+        std::fill(c, c + N, 0);
+        mul_acc(c, a, b);
+    }
+};
+
+// NTT primes p = k * 2^e + 1 (all below 2^30) with a primitive root g; e >= 23 for each,
+// so any power-of-two transform up to 2^23 points exists modulo every prime.
+struct NttPrime {
+    std::uint32_t p;
+    std::uint32_t g;
+};
+
+constexpr std::array<NttPrime, 3> NTT_PRIMES = {{
+    {998244353u, 3},
+    {469762049u, 3},
+    {754974721u, 11},
+}};
+
+constexpr std::array<Montgomery32, 3> NTT_MODULI = {{
+    Montgomery32(NTT_PRIMES[0].p),
+    Montgomery32(NTT_PRIMES[1].p),
+    Montgomery32(NTT_PRIMES[2].p),
+}};
+
+// Plain modular helpers for table construction only; the transforms themselves never divide.
+constexpr std::uint32_t ntt_mulmod(std::uint32_t a, std::uint32_t b, std::uint32_t p) {
+    return static_cast<std::uint32_t>(static_cast<std::uint64_t>(a) * b % p);
+}
+
+constexpr std::uint32_t ntt_powmod(std::uint32_t a, std::uint64_t e, std::uint32_t p) {
+    std::uint32_t result = 1;
+    for (; e != 0; e >>= 1) {
+        if (e & 1) {
+            result = ntt_mulmod(result, a, p);
+        }
+        a = ntt_mulmod(a, a, p);
+    }
+    return result;
+}
+
+// Twiddle tables for one transform size over the first `prime_count` NTT primes.
+// roots[k][len + j] = w^j * R for the primitive (2 * len)-th root w, so each butterfly stage
+// reads its twiddles from one contiguous run and a Montgomery product yields x * w directly.
+class NttPlan {
+private:
+    static constexpr std::size_t SIMD_STAGE = 8;
+
+    std::size_t n;
+    std::size_t primes;
+    std::vector<std::vector<std::uint32_t>> roots;
+    std::vector<std::vector<std::uint32_t>> inverse_roots;
+    std::vector<std::uint32_t> scale;
+
+public:
+    NttPlan(std::size_t size, std::size_t prime_count)
+        : n(size), primes(prime_count), roots(prime_count), inverse_roots(prime_count), scale(prime_count) {
+        assert(size >= 2 && (size & (size - 1)) == 0);
+        assert(prime_count >= 1 && prime_count <= NTT_PRIMES.size());
+
+        for (std::size_t k = 0; k < primes; ++k) {
+            const std::uint32_t p = NTT_PRIMES[k].p;
+            const Montgomery32& m = NTT_MODULI[k];
+            assert((p - 1) % size == 0);
+            roots[k].assign(n, 0);
+            inverse_roots[k].assign(n, 0);
+
+            for (std::size_t len = 1; len < n; len <<= 1) {
+                const std::uint32_t w = ntt_powmod(NTT_PRIMES[k].g, (p - 1) / (2 * len), p);
+                const std::uint32_t iw = ntt_powmod(w, p - 2, p);
+                std::uint32_t x = 1, ix = 1;
+                for (std::size_t j = 0; j < len; ++j) {
+                    roots[k][len + j] = m.to_montgomery(x);
+                    inverse_roots[k][len + j] = m.to_montgomery(ix);
+                    x = ntt_mulmod(x, w, p);
+                    ix = ntt_mulmod(ix, iw, p);
+                }
+            }
+            // Inputs enter as a * R and a pointwise product of two of them keeps a single R,
+            // so one Montgomery multiply by the plain n^-1 removes both R and the transform's n.
+            scale[k] = ntt_powmod(static_cast<std::uint32_t>(n % p), p - 2, p);
+        }
+    }
+
+    std::size_t size() const { return n; }
+    std::size_t prime_count() const { return primes; }
+
+    // Decimation in frequency: natural order in, bit-reversed order out.
+    // Stages with at least SIMD_STAGE butterflies per block go through the vector kernels.
+    void forward(std::uint32_t* a, std::size_t k) const {
+        const Montgomery32& m = NTT_MODULI[k];
+        const simd::Kernels& kernels = simd::kernels();
+        const std::uint32_t* w = roots[k].data();
+
+        for (std::size_t len = n >> 1; len >= 1; len >>= 1) {
+            for (std::size_t s = 0; s < n; s += 2 * len) {
+                if (len >= SIMD_STAGE) {
+                    kernels.dif_butterflies(a + s, a + s + len, w + len, len, m.kernel_modulus());
+                    continue;
+                }
+                for (std::size_t j = 0; j < len; ++j) {
+                    const std::uint32_t u = a[s + j];
+                    const std::uint32_t v = a[s + j + len];
+                    a[s + j] = m.add(u, v);
+                    a[s + j + len] = m.mul(m.sub(u, v), w[len + j]);
+                }
+            }
+        }
+    }
+
+    // Decimation in time: bit-reversed order in, natural order out, scaled by 1/n.
+    void inverse(std::uint32_t* a, std::size_t k) const {
+        const Montgomery32& m = NTT_MODULI[k];
+        const simd::Kernels& kernels = simd::kernels();
+        const std::uint32_t* w = inverse_roots[k].data();
+
+        for (std::size_t len = 1; len < n; len <<= 1) {
+            for (std::size_t s = 0; s < n; s += 2 * len) {
+                if (len >= SIMD_STAGE) {
+                    kernels.dit_butterflies(a + s, a + s + len, w + len, len, m.kernel_modulus());
+                    continue;
+                }
+                for (std::size_t j = 0; j < len; ++j) {
+                    const std::uint32_t u = a[s + j];
+                    const std::uint32_t v = m.mul(a[s + j + len], w[len + j]);
+                    a[s + j] = m.add(u, v);
+                    a[s + j + len] = m.sub(u, v);
+                }
+            }
+        }
+        kernels.mont_scale(a, a, scale[k], n, m.kernel_modulus());
+    }
+};
+
+// Products a transform buffer may accumulate before its inverse. Every sum of products in the
+// transform domain asserts its bound against it or inverts in parts (ExpressionPlan).
+constexpr std::size_t NTT_ACCUMULATION = 16;
+
+// Number of NTT primes whose product exceeds the largest linear-convolution coefficient of a sum
+// of `products` products, products * N * (q - 1)^2. All three cover it for N <= 2^14 and q < 2^32.
+constexpr std::size_t ntt_prime_count(std::size_t n, Fq q, std::size_t products = NTT_ACCUMULATION) {
+    const std::uint64_t square = static_cast<std::uint64_t>(q - 1) * (q - 1);
+    const std::uint64_t p0 = NTT_PRIMES[0].p;
+    const std::uint64_t p01 = p0 * NTT_PRIMES[1].p;
+
+    if (square <= (p0 - 1) / n / products) {
+        return 1;
+    }
+    if (square <= (p01 - 1) / n / products) {
+        return 2;
+    }
+    return 3;
+}
+
+constexpr std::size_t ntt_transform_size(std::size_t n) {
+    std::size_t size = 2;
+    while (size < 2 * n - 1) {
+        size <<= 1;
+    }
+    return size;
+}
+
+// Rq multiplication through a zero-padded linear convolution over up to three NTT primes,
+// recombined by Garner's CRT directly modulo q and folded back modulo t^N - 1.
+// t^N - 1 with N prime has no usable roots of unity in Fq, hence the detour over auxiliary primes.
+// Transform limbs hold Montgomery residues; a forward transform scales by R, and each
+// mul_acc product removes it again.
+template <std::size_t N, Fq Q, class Reduction = DefaultReduction<Q>>
+struct NttMultiplier {
+    // N * (q - 1)^2 < 2^76 for N <= 2^14, well below the ~2^88 product of the three primes
+    static_assert(N <= (std::size_t{1} << 14), "ring dimension too large for the NTT prime set");
+
+    using Field = FieldArithmetic<Q, Reduction>;
+    static constexpr std::size_t transform_size = ntt_transform_size(N);
+    static constexpr std::size_t prime_count = ntt_prime_count(N, Q);
+    static constexpr std::size_t transform_words = transform_size * prime_count;
+    static constexpr bool coefficient_domain = false;
+
+    static const NttPlan& plan() {
+        static const NttPlan instance(transform_size, prime_count);
+        return instance;
+    }
+
+    static void clear(std::uint32_t* t) {
+        std::fill(t, t + transform_words, 0);
+    }
+
+    static void forward(std::uint32_t* t, const Fq* a) {
+        instrument::count(instrument::Counter::Transforms);
+        const NttPlan& ntt = plan();
+        for (std::size_t k = 0; k < prime_count; ++k) {
+            std::uint32_t* limb = t + k * transform_size;
+            const Montgomery32& m = NTT_MODULI[k];
+            simd::kernels().mont_scale(limb, a, m.r2, N, m.kernel_modulus());
+            std::fill(limb + N, limb + transform_size, 0);
+            ntt.forward(limb, k);
+        }
+    }
+
+    static void pointwise(std::uint32_t* c, const std::uint32_t* a, const std::uint32_t* b) {
+        instrument::count(instrument::Counter::RingMultiplies);
+        const simd::Kernels& kernels = simd::kernels();
+        for (std::size_t k = 0; k < prime_count; ++k) {
+            const std::size_t offset = k * transform_size;
+            kernels.mont_mul(c + offset, a + offset, b + offset, transform_size, NTT_MODULI[k].kernel_modulus());
+        }
+    }
+
+    static void mul_acc(std::uint32_t* acc, const std::uint32_t* a, const std::uint32_t* b) {
+        instrument::count(instrument::Counter::RingMultiplies);
+        const simd::Kernels& kernels = simd::kernels();
+        for (std::size_t k = 0; k < prime_count; ++k) {
+            const std::size_t offset = k * transform_size;
+            kernels.mont_mul_acc(acc + offset, a + offset, b + offset, transform_size, NTT_MODULI[k].kernel_modulus());
+        }
+    }
+
+    // Consumes t.
+    static void inverse(Fq* c, std::uint32_t* t) {
+        instrument::count(instrument::Counter::Transforms);
+        const NttPlan& ntt = plan();
+        for (std::size_t k = 0; k < prime_count; ++k) {
+            ntt.inverse(t + k * transform_size, k);
+        }
+
+        const std::uint32_t p0 = NTT_PRIMES[0].p;
+        const std::uint32_t p1 = NTT_PRIMES[1].p;
+        const std::uint32_t p2 = NTT_PRIMES[2].p;
+        const Montgomery32& m1 = NTT_MODULI[1];
+        const Montgomery32& m2 = NTT_MODULI[2];
+        // Garner constants: x = a0 + p0 * t1 + p0 * p1 * t2, kept in Montgomery form
+        static const std::uint32_t p0_inv_p1 = m1.to_montgomery(ntt_powmod(p0 % p1, p1 - 2, p1));
+        static const std::uint32_t p01_inv_p2 = m2.to_montgomery(ntt_powmod(ntt_mulmod(p0 % p2, p1 % p2, p2), p2 - 2, p2));
+        static const Fq p0_q = Field::mod(p0);
+        static const Fq p01_q = Field::mul(Field::mod(p0), Field::mod(p1));
+
+        auto crt = [&](std::size_t i) -> Fq {
+            const std::uint32_t a0 = t[i];
+            Fq x = Field::mod(a0);
+            if constexpr (prime_count >= 2) {
+                const std::uint32_t a1 = t[transform_size + i];
+                const std::uint32_t t1 = m1.mul(m1.sub(a1, m1.reduce(a0)), p0_inv_p1);
+                x = Field::add(x, Field::mul(p0_q, Field::mod(t1)));
+                if constexpr (prime_count >= 3) {
+                    const std::uint32_t a2 = t[2 * transform_size + i];
+                    // a0 + p0 * t1 < 2^60, inside Montgomery32::reduce's input range
+                    const std::uint32_t low = m2.reduce(a0 + static_cast<std::uint64_t>(p0) * t1);
+                    const std::uint32_t t2 = m2.mul(m2.sub(a2, low), p01_inv_p2);
+                    x = Field::add(x, Field::mul(p01_q, Field::mod(t2)));
+                }
+            }
+            return x;
+        };
+
+        // Linear convolution has 2N - 1 terms; t^(N + i) folds onto t^i
+        for (std::size_t i = 0; i + 1 < N; ++i) {
+            c[i] = Field::add(crt(i), crt(i + N));
+        }
+        c[N - 1] = crt(N - 1);
+    }
+
+    static void mul(Fq* c, const Fq* a, const Fq* b) {
+        ArenaScope scope;
+        std::uint32_t* ta = scope.allocate<std::uint32_t>(2 * transform_words);
+        std::uint32_t* tb = ta + transform_words;
+
+        forward(ta, a);
+        forward(tb, b);
+        pointwise(ta, ta, tb);
+        inverse(c, ta);
+    }
+};
+
+template <std::size_t N, Fq Q, MulBackend Backend, class Reduction = DefaultReduction<Q>>
+using RingMultiplier = std::conditional_t<
+    Backend == MulBackend::Ntt || (Backend == MulBackend::Automatic && N >= NTT_CROSSOVER),
+    NttMultiplier<N, Q, Reduction>,
+    SchoolbookMultiplier<N, Q, Reduction>>;
+
+} // namespace giophantus
+
+#endif
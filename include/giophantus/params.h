@@ -0,0 +1,50 @@
+// Compile-time parameter sets
+#ifndef GIOPHANTUS_PARAMS_H
+#define GIOPHANTUS_PARAMS_H
+
+#include <cstddef>
+
+#include "giophantus/bivariate.h"
+#include "giophantus/ring.h"
+#include "giophantus/small.h"
+
+namespace giophantus {
+
+// Compile-time parameter set: N ring coefficients over Fq, small coefficients drawn from [0, noise_bound)
+template <std::size_t N_, Fq Q_, Fq NoiseBound, int BlockSize,
+          MulBackend Backend = MulBackend::Automatic, class Reduction = DefaultReduction<Q_>>
+struct ParamSet {
+    static constexpr std::size_t N = N_;
+    static constexpr Fq Q = Q_;
+    static constexpr Fq noise_bound = NoiseBound;
+    static constexpr int block_size = BlockSize;
+    // Total degrees of the public key X(x, y), the blinding r(x, y) and the noise e(x, y), as in parameter.h
+    static constexpr std::size_t dx = 1;
+    static constexpr std::size_t dr = 1;
+    static constexpr std::size_t dc = 2;
+
+    using Ring = Rq<N, Q, Backend, Reduction>;
+    // ux and uy, packed
+    using Secret = Rl<Ring, NoiseBound>;
+    using PublicPoly = Pq<Ring, dx>;
+    using Ciphertext = Pq<Ring, dx + dr>;
+    static_assert(dc <= dx + dr, "noise must fit in the ciphertext degree");
+
+    static constexpr GiophantusParams runtime() {
+        return {static_cast<int>(Q), static_cast<int>(N) - 1, static_cast<int>(NoiseBound), BlockSize};
+    }
+};
+
+// Toy parameter sets used by the self tests
+using Param128 = ParamSet<DEGREE + 1, MODULO, NOISE_BOUND, 32>;
+using Param192 = ParamSet<20, 23, 6, 48>;
+using Param256 = ParamSet<24, 29, 8, 64>;
+
+// Reference parameter sets (parameter.h): q = 2^31 - 1, L = 4, block size = MLEN bytes
+using IEC602 = ParamSet<1201, 0x7fffffffu, 4, 16>;
+using IEC868 = ParamSet<1733, 0x7fffffffu, 4, 24>;
+using IEC1134 = ParamSet<2267, 0x7fffffffu, 4, 32>;
+
+} // namespace giophantus
+
+#endif
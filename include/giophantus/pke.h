@@ -0,0 +1,132 @@
+// IND-CCA public key encryption: the FO conversion of iec.c over byte-encoded keys and ciphertexts
+#ifndef GIOPHANTUS_PKE_H
+#define GIOPHANTUS_PKE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "giophantus/codec.h"
+#include "giophantus/params.h"
+#include "giophantus/random.h"
+#include "giophantus/sampling.h"
+#include "giophantus/scheme.h"
+
+namespace giophantus {
+
+// crypto_encrypt_keypair / crypto_encrypt / crypto_encrypt_open of the reference. The message
+// is padded to a full Rl payload with random bytes; SHAKE256 of the payload then supplies r and e,
+// so decryption can re-encrypt the recovered payload and reject any ciphertext that differs.
+template <class Params>
+class GiophantusPke {
+public:
+    using Layout = ByteLayout<Params>;
+    using Ring = typename Params::Ring;
+    using PublicPoly = typename Params::PublicPoly;
+    using Ciphertext = typename Params::Ciphertext;
+
+    static constexpr std::size_t PUBLIC_KEY_BYTES = Layout::public_key;
+    static constexpr std::size_t SECRET_KEY_BYTES = Layout::secret_key;
+    static constexpr std::size_t CIPHERTEXT_BYTES = Layout::ciphertext;
+    static constexpr std::size_t MESSAGE_BYTES = Layout::message;
+    static constexpr std::size_t PADDING_BYTES = Layout::payload - MESSAGE_BYTES;
+
+    static_assert(Params::noise_bound == 4, "the Rl encoding packs two-bit coefficients");
+    static_assert(Layout::payload > MESSAGE_BYTES, "the payload must leave room for padding");
+
+    // Draws ux, uy and X from rng; a generator over the NIST DRBG with Sampling::Reference
+    // reproduces the KAT keys
+    static void keypair(std::uint8_t* pk, std::uint8_t* sk, RandomPolynomialGenerator& rng) {
+        const GiophantusKey<Params> key = GiophantusKeyGen::generate<Params>(rng);
+        ByteCodec::encode(pk, key.X);
+        ByteCodec::encode(sk, key);
+    }
+
+    // MESSAGE_BYTES of msg into CIPHERTEXT_BYTES of c; the padding is one rng.random_bytes()
+    // call. False when pk holds a coefficient that is not reduced modulo q.
+    static bool encrypt(std::uint8_t* c, const std::uint8_t* msg, const std::uint8_t* pk, RandomPolynomialGenerator& rng) {
+        std::array<std::uint8_t, PADDING_BYTES> padding;
+        rng.random_bytes(padding.data(), PADDING_BYTES);
+        return encrypt(c, msg, pk, padding.data());
+    }
+
+    // Encryption with caller-supplied PADDING_BYTES of randomness
+    static bool encrypt(std::uint8_t* c, const std::uint8_t* msg, const std::uint8_t* pk, const std::uint8_t* padding) {
+        PublicPoly X;
+        if (!ByteCodec::decode(X, pk)) {
+            return false;
+        }
+
+        std::array<std::uint8_t, Layout::payload> payload;
+        std::memcpy(payload.data(), msg, MESSAGE_BYTES);
+        std::memcpy(payload.data() + MESSAGE_BYTES, padding, PADDING_BYTES);
+        mask_tail(payload.data());
+
+        Ciphertext ciphertext;
+        derive(ciphertext, EncryptionContext<Params>(X), payload.data());
+        ByteCodec::encode(c, ciphertext);
+        return true;
+    }
+
+    // Recovers the payload, re-encrypts it and writes its first MESSAGE_BYTES to msg only when
+    // the result reproduces c byte for byte
+    static bool decrypt(std::uint8_t* msg, const std::uint8_t* c, const std::uint8_t* sk) {
+        GiophantusKey<Params> key;
+        const bool valid = ByteCodec::decode(key, sk);
+        return decrypt(msg, c, DecryptionContext<Params>(key), EncryptionContext<Params>(key.X)) && valid;
+    }
+
+    // Decryption with the tables of a long-lived key built once: decryption holds the secret
+    // key, encryption its public key X for the re-encryption
+    static bool decrypt(std::uint8_t* msg, const std::uint8_t* c, const DecryptionContext<Params>& decryption,
+                        const EncryptionContext<Params>& encryption) {
+        // Unreduced words cannot come out of encryption; they are rejected without being transformed
+        const CiphertextView<Params> ciphertext(c);
+        const bool valid = ciphertext.valid();
+
+        Ring m;
+        if (valid) {
+            decryption.decrypt_into(m, ciphertext);
+        }
+        std::array<std::uint8_t, Layout::payload> payload;
+        ByteCodec::encode_small(payload.data(), m);
+
+        Ciphertext expected;
+        derive(expected, encryption, payload.data());
+        std::array<std::uint8_t, CIPHERTEXT_BYTES> encoded;
+        ByteCodec::encode(encoded.data(), expected);
+
+        // Compared in full whatever the first difference, so timing does not locate it
+        std::uint8_t difference = 0;
+        for (std::size_t k = 0; k < CIPHERTEXT_BYTES; ++k) {
+            difference |= static_cast<std::uint8_t>(encoded[k] ^ c[k]);
+        }
+        if (!valid || difference != 0) {
+            return false;
+        }
+        std::memcpy(msg, payload.data(), MESSAGE_BYTES);
+        return true;
+    }
+
+private:
+    // Clears the bits of the last payload byte that lie past coefficient N - 1
+    static void mask_tail(std::uint8_t* payload) {
+        constexpr std::size_t used = Params::N % 4;
+        if constexpr (used != 0) {
+            payload[Layout::payload - 1] &= static_cast<std::uint8_t>(0xff << (8 - 2 * used));
+        }
+    }
+
+    // Deterministic encryption of the payload under the seed expander it keys
+    static void derive(Ciphertext& out, const EncryptionContext<Params>& context, const std::uint8_t* payload) {
+        Ring m;
+        ByteCodec::decode_small(m, payload);
+        RandomPolynomialGenerator expander(csprng::Shake256(payload, Layout::payload), Sampling::Reference);
+        context.encrypt_many(std::span<const Ring>(&m, 1), std::span<Ciphertext>(&out, 1), expander);
+    }
+};
+
+} // namespace giophantus
+
+#endif
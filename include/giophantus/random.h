@@ -0,0 +1,125 @@
+// Deterministic random byte sources: AES-256, the NIST AES-CTR DRBG and a SHAKE256 expander
+#ifndef GIOPHANTUS_RANDOM_H
+#define GIOPHANTUS_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace csprng {
+
+// AES-256 encryption with the key schedule expanded once. Blocks go through AES-NI when the
+// CPU has it and through a table implementation otherwise.
+class Aes256 {
+public:
+    static constexpr std::size_t KEY_BYTES = 32;
+    static constexpr std::size_t BLOCK_BYTES = 16;
+    static constexpr std::size_t ROUNDS = 14;
+
+    Aes256() = default;
+    explicit Aes256(const std::uint8_t key[KEY_BYTES]);
+
+    void set_key(const std::uint8_t key[KEY_BYTES]);
+
+    void encrypt_block(const std::uint8_t in[BLOCK_BYTES], std::uint8_t out[BLOCK_BYTES]) const;
+
+    // out[b] = E(counter + 1 + b) for b < blocks, counter being a 128-bit big-endian integer that
+    // is left at its last value (the pre-increment order of the NIST DRBG)
+    void ctr_blocks(std::uint8_t counter[BLOCK_BYTES], std::uint8_t* out, std::size_t blocks) const;
+
+    // Table implementation whatever the CPU, to cross-check the AES-NI path
+    void encrypt_blocks_portable(const std::uint8_t* in, std::uint8_t* out, std::size_t blocks) const;
+
+    // Expanded key: ROUNDS + 1 round keys in FIPS 197 byte order
+    const std::uint8_t* round_keys() const { return schedule; }
+
+private:
+    alignas(16) std::uint8_t schedule[(ROUNDS + 1) * BLOCK_BYTES] = {};
+};
+
+// True when the AES-NI code path is compiled in and the CPU supports it
+bool aes_ni_available();
+
+// AES-256-GCM (NIST SP 800-38D) with 96-bit nonces and 128-bit tags. GHASH runs on PCLMULQDQ
+// when the CPU has it and on a branch-free bitwise multiply otherwise.
+class Aes256Gcm {
+public:
+    static constexpr std::size_t KEY_BYTES = Aes256::KEY_BYTES;
+    static constexpr std::size_t NONCE_BYTES = 12;
+    static constexpr std::size_t TAG_BYTES = 16;
+    // The 32-bit block counter starts at 2 and must not wrap
+    static constexpr std::uint64_t MAX_BYTES = ((std::uint64_t{1} << 32) - 2) * Aes256::BLOCK_BYTES;
+
+    Aes256Gcm() = default;
+    explicit Aes256Gcm(const std::uint8_t key[KEY_BYTES]);
+
+    void set_key(const std::uint8_t key[KEY_BYTES]);
+
+    // out = E(in) for length <= MAX_BYTES with the tag over aad and out; out may equal in
+    void seal(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* aad, std::size_t aad_length, const std::uint8_t* in,
+              std::uint8_t* out, std::size_t length, std::uint8_t tag[TAG_BYTES]) const;
+
+    // Checks the tag before decrypting; false (and out untouched) when it does not match
+    bool open(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* aad, std::size_t aad_length, const std::uint8_t* in,
+              std::uint8_t* out, std::size_t length, const std::uint8_t tag[TAG_BYTES]) const;
+
+    // The tag with the portable GHASH whatever the CPU, to cross-check the PCLMULQDQ path
+    void tag_portable(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* aad, std::size_t aad_length,
+                      const std::uint8_t* ciphertext, std::size_t length, std::uint8_t tag[TAG_BYTES]) const;
+
+private:
+    Aes256 aes;
+    alignas(16) std::uint8_t h[Aes256::BLOCK_BYTES] = {};
+
+    void compute_tag(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* aad, std::size_t aad_length,
+                     const std::uint8_t* ciphertext, std::size_t length, std::uint8_t tag[TAG_BYTES], bool portable) const;
+    void ctr(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* in, std::uint8_t* out, std::size_t length) const;
+};
+
+// True when GHASH uses PCLMULQDQ
+bool clmul_available();
+
+// NIST SP 800-90A AES-256 CTR DRBG without derivation function, identical to the NIST rng.c
+// used for the KAT files: every generate() is one randombytes() call, ending with a state update.
+class CtrDrbg {
+public:
+    static constexpr std::size_t SEED_BYTES = 48;
+
+    explicit CtrDrbg(const std::uint8_t entropy[SEED_BYTES], const std::uint8_t* personalization = nullptr);
+
+    void generate(std::uint8_t* out, std::size_t length);
+
+private:
+    std::uint8_t key[Aes256::KEY_BYTES] = {};
+    std::uint8_t v[Aes256::BLOCK_BYTES] = {};
+    Aes256 aes;
+    std::uint64_t reseed_counter = 0;
+
+    void update(const std::uint8_t* provided);
+};
+
+// Keccak-f[1600] on a 25-lane state
+void keccak_f1600(std::uint64_t state[25]);
+
+// SHAKE256 over a seed, squeezed incrementally. The reference seedexpand.c computes the same
+// stream up front into a pool of maxlen bytes.
+class Shake256 {
+public:
+    static constexpr std::size_t RATE = 136;
+
+    Shake256(const std::uint8_t* seed, std::size_t length);
+
+    void squeeze(std::uint8_t* out, std::size_t length);
+
+private:
+    std::uint64_t state[25] = {};
+    std::size_t position = 0; // bytes of the current block already squeezed
+
+    std::uint8_t byte(std::size_t i) const { return static_cast<std::uint8_t>(state[i / 8] >> (8 * (i % 8))); }
+};
+
+// One-shot SHAKE256
+void shake256(std::uint8_t* out, std::size_t out_length, const std::uint8_t* in, std::size_t in_length);
+
+} // namespace csprng
+
+#endif
@@ -0,0 +1,87 @@
+// Runtime registry of parameter sets: look a set up by name or key size instead of by type
+#ifndef GIOPHANTUS_REGISTRY_H
+#define GIOPHANTUS_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "giophantus/params.h"
+#include "giophantus/pke.h"
+#include "giophantus/sampling.h"
+
+namespace giophantus {
+
+// A compiled parameter set behind function pointers. Every entry owns its constants through
+// its Params type: the reduction constants live in Params::Ring, the NTT plan and CRT constants
+// in its multiplier, built once by prepare() (or lazily by the first product).
+struct ParameterSetInfo {
+    const char* name;
+    std::size_t n;
+    Fq q;
+    Fq noise_bound;
+    bool ntt;
+    std::size_t transform_words;
+    std::size_t public_key_bytes;
+    std::size_t secret_key_bytes;
+    std::size_t ciphertext_bytes;
+    std::size_t message_bytes;
+
+    void (*prepare)();
+    void (*keypair)(std::uint8_t* pk, std::uint8_t* sk, RandomPolynomialGenerator& rng);
+    bool (*encrypt)(std::uint8_t* c, const std::uint8_t* msg, const std::uint8_t* pk, RandomPolynomialGenerator& rng);
+    bool (*decrypt)(std::uint8_t* msg, const std::uint8_t* c, const std::uint8_t* sk);
+};
+
+// Entry for Params under name; name must outlive the registry
+template <class Params>
+ParameterSetInfo describe_parameter_set(const char* name) {
+    using Pke = GiophantusPke<Params>;
+    using Multiplier = typename Params::Ring::Multiplier;
+    return {
+        name,
+        Params::N,
+        Params::Q,
+        Params::noise_bound,
+        !Multiplier::coefficient_domain,
+        Multiplier::transform_words,
+        Pke::PUBLIC_KEY_BYTES,
+        Pke::SECRET_KEY_BYTES,
+        Pke::CIPHERTEXT_BYTES,
+        Pke::MESSAGE_BYTES,
+        [] {
+            // One product runs every table constructor of the multiplier
+            const typename Params::Ring zero;
+            (void)(zero * zero);
+        },
+        [](std::uint8_t* pk, std::uint8_t* sk, RandomPolynomialGenerator& rng) { Pke::keypair(pk, sk, rng); },
+        [](std::uint8_t* c, const std::uint8_t* msg, const std::uint8_t* pk, RandomPolynomialGenerator& rng) {
+            return Pke::encrypt(c, msg, pk, rng);
+        },
+        [](std::uint8_t* msg, const std::uint8_t* c, const std::uint8_t* sk) { return Pke::decrypt(msg, c, sk); },
+    };
+}
+
+// Process-wide list, starting with IEC602, IEC868 and IEC1134. Entries are never removed, so
+// returned pointers stay valid; add() and the lookups may run concurrently.
+class ParamRegistry {
+public:
+    // Appends info; false (and no change) when its name is taken
+    static bool add(const ParameterSetInfo& info);
+
+    // Null when nothing matches
+    static const ParameterSetInfo* find(std::string_view name);
+    static const ParameterSetInfo* find_by_public_key(std::size_t public_key_bytes);
+    static const ParameterSetInfo* find_by_secret_key(std::size_t secret_key_bytes);
+
+    // Snapshot of every entry in registration order
+    static std::vector<const ParameterSetInfo*> all();
+
+    // Runs prepare() of every entry, so no operation pays for table construction later
+    static void prepare_all();
+};
+
+} // namespace giophantus
+
+#endif
@@ -0,0 +1,199 @@
+// Ring elements of Rq = Fq[t] / (t^N - 1)
+#ifndef GIOPHANTUS_RING_H
+#define GIOPHANTUS_RING_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <span>
+
+#include "giophantus/arena.h"
+#include "giophantus/multiply.h"
+#include "giophantus/simd.h"
+
+namespace giophantus {
+
+// Ring Element of Rq = Fq[t] / (t^N - 1)
+// The coefficient count is part of the type, so every loop below has a compile-time trip count
+// and the element itself never allocates.
+template <std::size_t N, Fq Q, MulBackend Backend = MulBackend::Automatic, class Reduction = DefaultReduction<Q>>
+class Rq {
+    static_assert(N > 0, "ring dimension must be positive");
+
+public:
+    using Field = FieldArithmetic<Q, Reduction>;
+    using Multiplier = RingMultiplier<N, Q, Backend, Reduction>;
+    static constexpr std::size_t dimension = N;
+    static constexpr Fq modulus = Q;
+
+private:
+    alignas(64) std::array<Fq, N> coeffs{};
+
+public:
+    Rq() = default;
+
+    explicit Rq(const std::array<Fq, N>& c) : coeffs(c) {
+        for (Fq& x : coeffs) {
+            x = Field::mod(x);
+        }
+    }
+
+    static constexpr int degree() {
+        return static_cast<int>(N) - 1;
+    }
+
+    Fq operator[](std::size_t i) const { return coeffs[i]; }
+    Fq& operator[](std::size_t i) { return coeffs[i]; }
+
+    const Fq* data() const { return coeffs.data(); }
+    Fq* data() { return coeffs.data(); }
+
+    auto begin() const { return coeffs.begin(); }
+    auto end() const { return coeffs.end(); }
+    auto begin() { return coeffs.begin(); }
+    auto end() { return coeffs.end(); }
+
+    Rq& operator+=(const Rq& other) {
+        simd::kernels().add(data(), data(), other.data(), N, Q);
+        return *this;
+    }
+
+    Rq& operator-=(const Rq& other) {
+        simd::kernels().sub(data(), data(), other.data(), N, Q);
+        return *this;
+    }
+
+    Rq& operator*=(Fq scalar) {
+        simd::kernels().scalar_mul(data(), data(), Field::mod(scalar), N, Q);
+        return *this;
+    }
+
+    // Coefficient-wise residue modulo a small l (2 <= l < 2^16), as in decryption's final step
+    Rq& reduce(Fq l) {
+        simd::kernels().reduce(data(), N, l);
+        return *this;
+    }
+
+    // Output-parameter forms; out may alias an operand except in mul_into and mul_add
+    static void add_into(Rq& out, const Rq& a, const Rq& b) {
+        simd::kernels().add(out.data(), a.data(), b.data(), N, Q);
+    }
+
+    static void sub_into(Rq& out, const Rq& a, const Rq& b) {
+        simd::kernels().sub(out.data(), a.data(), b.data(), N, Q);
+    }
+
+    static void mul_into(Rq& out, const Rq& a, const Rq& b) {
+        Multiplier::mul(out.data(), a.data(), b.data());
+    }
+
+    // out += a * b; the schoolbook backend accumulates straight into the coefficients
+    static void mul_add(Rq& out, const Rq& a, const Rq& b) {
+        if constexpr (Multiplier::coefficient_domain) {
+            Multiplier::mul_acc(out.data(), a.data(), b.data());
+        } else {
+            ArenaScope scope;
+            Rq* product = scope.allocate<Rq>(1);
+            mul_into(*product, a, b);
+            out += *product;
+        }
+    }
+
+    Rq operator+(const Rq& other) const {
+        Rq result = *this;
+        return result += other;
+    }
+
+    Rq operator-(const Rq& other) const {
+        Rq result = *this;
+        return result -= other;
+    }
+
+    Rq operator*(const Rq& other) const {
+        Rq result;
+        Multiplier::mul(result.data(), data(), other.data());
+        return result;
+    }
+
+    Rq& operator*=(const Rq& other) {
+        return *this = *this * other;
+    }
+
+    bool operator==(const Rq& other) const {
+        return coeffs == other.coeffs;
+    }
+
+    bool operator!=(const Rq& other) const {
+        return !(*this == other);
+    }
+
+    // f(x) by Horner's rule: one product and one addition per coefficient
+    Fq evaluate(Fq x) const {
+        Fq value = 0;
+        for (std::size_t i = N; i-- > 0;) {
+            value = Field::add(Field::mul(value, x), coeffs[i]);
+        }
+        return value;
+    }
+
+    // Lanes the batch evaluators run side by side, one kernel call per coefficient
+    static constexpr std::size_t EVALUATION_BLOCK = 256;
+
+    // values[k] = f(points[k]), points reduced: Horner over a block of points at a time with the
+    // points in Montgomery form, so a step is one fused vector product-and-add
+    void evaluate_many(std::span<const Fq> points, std::span<Fq> values) const {
+        assert(points.size() == values.size());
+        if constexpr (Q % 2 == 0) {
+            for (std::size_t k = 0; k < points.size(); ++k) {
+                values[k] = evaluate(points[k]);
+            }
+        } else {
+            static constexpr Montgomery32 montgomery{Q};
+            const simd::Kernels& k = simd::kernels();
+            std::array<Fq, EVALUATION_BLOCK> x, a, b;
+            for (std::size_t first = 0; first < points.size(); first += EVALUATION_BLOCK) {
+                const std::size_t count = std::min(EVALUATION_BLOCK, points.size() - first);
+                for (std::size_t p = 0; p < count; ++p) {
+                    x[p] = montgomery.to_montgomery(points[first + p]);
+                }
+                // The steps alternate between the two buffers
+                Fq* v = a.data();
+                Fq* next = b.data();
+                std::fill(v, v + count, coeffs[N - 1]);
+                for (std::size_t i = N - 1; i-- > 0;) {
+                    std::fill(next, next + count, coeffs[i]);
+                    k.mont_mul_acc(next, v, x.data(), count, montgomery.kernel_modulus());
+                    std::swap(v, next);
+                }
+                std::copy(v, v + count, values.begin() + first);
+            }
+        }
+    }
+
+    // values[k] = polys[k](x), x reduced: the lanes are polynomials, their coefficients gathered
+    // one column at a time into a vector scaled by x per step
+    static void evaluate_many(std::span<const Rq> polys, Fq x, std::span<Fq> values) {
+        assert(polys.size() == values.size());
+        const simd::Kernels& k = simd::kernels();
+        std::array<Fq, EVALUATION_BLOCK> column;
+        for (std::size_t first = 0; first < polys.size(); first += EVALUATION_BLOCK) {
+            const std::size_t count = std::min(EVALUATION_BLOCK, polys.size() - first);
+            Fq* v = values.data() + first;
+            for (std::size_t p = 0; p < count; ++p) {
+                v[p] = polys[first + p][N - 1];
+            }
+            for (std::size_t i = N - 1; i-- > 0;) {
+                for (std::size_t p = 0; p < count; ++p) {
+                    column[p] = polys[first + p][i];
+                }
+                k.scalar_mul(v, v, x, count, Q);
+                k.add(v, v, column.data(), count, Q);
+            }
+        }
+    }
+};
+
+} // namespace giophantus
+
+#endif
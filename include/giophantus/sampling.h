@@ -0,0 +1,175 @@
+// Random polynomial sampling from deterministic byte sources
+#ifndef GIOPHANTUS_SAMPLING_H
+#define GIOPHANTUS_SAMPLING_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <variant>
+
+#include "giophantus/field.h"
+#include "giophantus/instrument.h"
+#include "giophantus/random.h"
+
+namespace giophantus {
+
+// Random Polynomial Generator
+// Coefficients are cut from a deterministic byte stream: the AES-256 CTR DRBG behind the NIST
+// randombytes(), or the SHAKE256 seed expander of the FO transform.
+enum class Sampling {
+    // Rejection sampling on masked bytes: exactly uniform, whole buffers per source call
+    Uniform,
+    // Fq_rand / Fl_rand of the reference: 4 bytes little endian mod q, 1 byte mod L. DRBG
+    // sources are then called once per coefficient, the granularity the KAT files were made with.
+    Reference,
+};
+
+class RandomPolynomialGenerator {
+private:
+    using Source = std::variant<csprng::CtrDrbg, csprng::Shake256>;
+
+    static constexpr std::size_t BUFFER_BYTES = 2048;
+
+    Source source;
+    Sampling sampling;
+    alignas(64) std::array<std::uint8_t, BUFFER_BYTES> buffer;
+
+    static csprng::CtrDrbg seeded_drbg(std::uint32_t seed) {
+        std::uint8_t entropy[csprng::CtrDrbg::SEED_BYTES] = {};
+        for (int i = 0; i < 4; ++i) {
+            entropy[i] = static_cast<std::uint8_t>(seed >> (8 * i));
+        }
+        return csprng::CtrDrbg(entropy);
+    }
+
+    static csprng::CtrDrbg system_drbg() {
+        std::random_device device;
+        std::uint8_t entropy[csprng::CtrDrbg::SEED_BYTES];
+        for (std::size_t i = 0; i < sizeof(entropy); i += 4) {
+            const std::uint32_t word = device();
+            for (int k = 0; k < 4; ++k) {
+                entropy[i + k] = static_cast<std::uint8_t>(word >> (8 * k));
+            }
+        }
+        return csprng::CtrDrbg(entropy);
+    }
+
+    bool per_coefficient() const {
+        return sampling == Sampling::Reference && std::holds_alternative<csprng::CtrDrbg>(source);
+    }
+
+    // value < bound from width little-endian bytes; false when Uniform sampling rejects it
+    template <class Ring>
+    Fq decode(const std::uint8_t* p, std::size_t width, Fq bound, Fq mask, bool& accept) const {
+        Fq x = p[0];
+        if (width == 4) {
+            x |= static_cast<Fq>(p[1]) << 8 | static_cast<Fq>(p[2]) << 16 | static_cast<Fq>(p[3]) << 24;
+        }
+        if (sampling == Sampling::Reference) {
+            accept = true;
+            if (bound == Ring::modulus) {
+                return Ring::Field::mod(x);
+            }
+            return (bound & (bound - 1)) == 0 ? x & (bound - 1) : x % bound;
+        }
+        x &= mask;
+        accept = x < bound;
+        return x;
+    }
+
+public:
+    explicit RandomPolynomialGenerator(Sampling sampling = Sampling::Uniform) : source(system_drbg()), sampling(sampling) {}
+    // Reproducible stream for tests and benchmarks
+    explicit RandomPolynomialGenerator(std::uint32_t seed) : source(seeded_drbg(seed)), sampling(Sampling::Uniform) {}
+    explicit RandomPolynomialGenerator(const csprng::CtrDrbg& drbg, Sampling sampling = Sampling::Uniform)
+        : source(drbg), sampling(sampling) {}
+    explicit RandomPolynomialGenerator(const csprng::Shake256& expander, Sampling sampling = Sampling::Uniform)
+        : source(expander), sampling(sampling) {}
+
+    // Generator owned by the calling thread, seeded independently on first use
+    static RandomPolynomialGenerator& local() {
+        thread_local RandomPolynomialGenerator instance;
+        return instance;
+    }
+
+    // Next bytes of the stream; one randombytes() call for a DRBG source
+    void random_bytes(std::uint8_t* out, std::size_t length) {
+        std::visit([&](auto& s) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(s)>, csprng::CtrDrbg>) {
+                s.generate(out, length);
+            } else {
+                s.squeeze(out, length);
+            }
+        }, source);
+    }
+
+    // Coefficients uniform in [0, bound)
+    template <class Ring>
+    Ring generate(Fq bound) {
+        Ring result;
+        fill(result, bound);
+        return result;
+    }
+
+    template <class Ring>
+    Ring uniform() {
+        return generate<Ring>(Ring::modulus);
+    }
+
+    // Small bounds (up to 256, e.g. L) take one byte per draw, larger ones four. Uniform sampling
+    // masks each draw to the bit length of bound and compacts the accepted values branch-free;
+    // for q = 2^31 - 1 and L = 4 nothing is ever rejected in practice.
+    template <class Ring>
+    void fill(Ring& out, Fq bound) {
+        assert(bound >= 1);
+        constexpr std::size_t n = Ring::dimension;
+        const std::size_t width = bound <= 0x100 ? 1 : 4;
+        const Fq mask = bound == 1 ? 0 : static_cast<Fq>(std::bit_ceil(static_cast<std::uint64_t>(bound)) - 1);
+        Fq* dst = out.data();
+        bool accept = true;
+        instrument::count(instrument::Counter::SamplesDrawn, n);
+
+        if (per_coefficient()) {
+            for (std::size_t i = 0; i < n; ++i) {
+                random_bytes(buffer.data(), width);
+                dst[i] = decode<Ring>(buffer.data(), width, bound, mask, accept);
+            }
+            return;
+        }
+
+        std::size_t filled = 0;
+        while (filled < n) {
+            const std::size_t count = std::min(n - filled, BUFFER_BYTES / width);
+            random_bytes(buffer.data(), count * width);
+            // At most count values land, so dst[filled] stays inside the ring
+            for (std::size_t k = 0; k < count; ++k) {
+                dst[filled] = decode<Ring>(buffer.data() + k * width, width, bound, mask, accept);
+                filled += accept;
+            }
+        }
+    }
+
+    // Bivariate polynomial whose ring coefficients are drawn term by term in POLYFOR order
+    template <class Poly>
+    void fill_terms(Poly& out, Fq bound) {
+        for (auto& term : out) {
+            fill(term, bound);
+        }
+    }
+
+    template <class Poly>
+    Poly generate_terms(Fq bound) {
+        Poly result;
+        fill_terms(result, bound);
+        return result;
+    }
+};
+
+} // namespace giophantus
+
+#endif
@@ -0,0 +1,449 @@
+// Key generation, encryption and decryption
+#ifndef GIOPHANTUS_SCHEME_H
+#define GIOPHANTUS_SCHEME_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "giophantus/arena.h"
+#include "giophantus/bivariate.h"
+#include "giophantus/codec.h"
+#include "giophantus/instrument.h"
+#include "giophantus/key.h"
+#include "giophantus/params.h"
+#include "giophantus/sampling.h"
+#include "giophantus/thread_pool.h"
+#include "giophantus/validity.h"
+
+namespace giophantus {
+
+namespace detail {
+
+// out = f(ux, uy) at a key's secrets: the dense nested Horner of Pq::evaluate_into, or SparseRq
+// row additions when the build opts into GIOPHANTUS_SPARSE_SECRETS, whose time depends on the key
+template <class Params, class Poly>
+void evaluate_at_secrets(typename Params::Ring& out, const Poly& f, const GiophantusKey<Params>& key) {
+    if constexpr (SparseRq<typename Params::Ring>::use_sparse) {
+        using Sparse = SparseRq<typename Params::Ring>;
+        f.evaluate_into(out, Sparse(key.ux, Params::noise_bound), Sparse(key.uy, Params::noise_bound));
+    } else {
+        f.evaluate_into(out, key.ux.ring(), key.uy.ring());
+    }
+}
+
+} // namespace detail
+
+enum class KeyStatus {
+    Valid,
+    SecretOutOfRange, // a coefficient of ux or uy is not below L
+    Unreduced,        // a coefficient of X is not below q
+    NotRoot,          // X(ux, uy) != 0
+    Degenerate,       // X10 or X01 is a zero divisor of Rq
+};
+
+class GiophantusKeyGen {
+    template <class Params>
+    static GiophantusKey<Params> sample(RandomPolynomialGenerator& rng, bool validated) {
+        GIOPHANTUS_PHASE(KeyGen);
+        using Ring = typename Params::Ring;
+        using PublicPoly = typename Params::PublicPoly;
+
+        Ring ux = rng.generate<Ring>(Params::noise_bound);
+        Ring uy = rng.generate<Ring>(Params::noise_bound);
+        PublicPoly X = rng.generate_terms<PublicPoly>(Params::Q);
+        // Redraw X until both linear terms are units; for the IEC sets a draw fails with
+        // probability about 2 / q
+        while (validated && !nondegenerate<Params>(X)) {
+            rng.fill_terms(X, Params::Q);
+        }
+
+        // (ux, uy) becomes a root of X: X00 -= X(ux, uy)
+        if constexpr (SparseRq<Ring>::use_sparse) {
+            X(0, 0) -= X.evaluate(SparseRq<Ring>(ux, Params::noise_bound), SparseRq<Ring>(uy, Params::noise_bound));
+        } else {
+            X(0, 0) -= X.evaluate(ux, uy);
+        }
+
+        using Secret = typename Params::Secret;
+        return GiophantusKey<Params>(Secret(ux), Secret(uy), X);
+    }
+
+public:
+    template <class Params>
+    static GiophantusKey<Params> generate() {
+        return generate<Params>(RandomPolynomialGenerator::local());
+    }
+
+    // A key whose X passes nondegenerate(); the draws match generate_unchecked unless X is redrawn
+    template <class Params>
+    static GiophantusKey<Params> generate(RandomPolynomialGenerator& rng) {
+        return sample<Params>(rng, true);
+    }
+
+    // The bare construction, without the invertibility test
+    template <class Params>
+    static GiophantusKey<Params> generate_unchecked(RandomPolynomialGenerator& rng) {
+        return sample<Params>(rng, false);
+    }
+
+    // With X10 a unit, X(x, y) = 0 has exactly one x for every y (and with X01 one y for every
+    // x); a zero divisor leaves whole cosets of roots, and small ones among them, to an attacker
+    template <class Params>
+    static bool nondegenerate(const typename Params::PublicPoly& X) {
+        static_assert(Params::dx == 1, "the test covers linear public keys");
+        using Units = UnitTest<typename Params::Ring>;
+        return Units::is_unit(X(1, 0)) && Units::is_unit(X(0, 1));
+    }
+
+    // Full check of a key from outside, e.g. one loaded from storage
+    template <class Params>
+    static KeyStatus validate(const GiophantusKey<Params>& key) {
+        if (!key.ux.reduced() || !key.uy.reduced()) {
+            return KeyStatus::SecretOutOfRange;
+        }
+        for (std::size_t k = 0; k < Params::PublicPoly::terms; ++k) {
+            if (std::any_of(key.X[k].begin(), key.X[k].end(), [](Fq c) { return c >= Params::Q; })) {
+                return KeyStatus::Unreduced;
+            }
+        }
+        typename Params::Ring root;
+        detail::evaluate_at_secrets(root, key.X, key);
+        if (root != typename Params::Ring{}) {
+            return KeyStatus::NotRoot;
+        }
+        return nondegenerate<Params>(key.X) ? KeyStatus::Valid : KeyStatus::Degenerate;
+    }
+
+    // count independent keys, each worker drawing from its own thread's generator
+    template <class Params>
+    static std::vector<GiophantusKey<Params>> generate_many(std::size_t count, ThreadPool& pool) {
+        std::vector<GiophantusKey<Params>> keys(count);
+        pool.parallel_for(count, [&](std::size_t k) { keys[k] = generate<Params>(); });
+        return keys;
+    }
+};
+
+// Encryption under one public key. The transforms of the X(x, y) terms are computed once in the
+// constructor and reused by every message: c = X * r + L * e + m.
+template <class Params>
+class EncryptionContext {
+public:
+    using Ring = typename Params::Ring;
+    using PublicPoly = typename Params::PublicPoly;
+    using Ciphertext = typename Params::Ciphertext;
+    using Blinding = Pq<Ring, Params::dr>;
+
+    // Messages encrypted together by encrypt_many: each X term transform is used GROUP times
+    // while it is still in cache
+    static constexpr std::size_t GROUP = 4;
+
+private:
+    using Multiplier = typename Ring::Multiplier;
+    static constexpr std::size_t W = Multiplier::transform_words;
+
+    PublicPoly X;
+    // The term transforms, in storage or borrowed from a caller (a mapped key store)
+    std::vector<std::uint32_t> storage;
+    const std::uint32_t* transformed;
+
+    using Noise = Pq<Ring, Params::dc>;
+
+    // (X * r)(i, j) for every message of the group, from pre-transformed r terms; a term sums at
+    // most one product per X(x, y) term
+    static_assert(std::min(PublicPoly::terms, Blinding::terms) <= NTT_ACCUMULATION, "blinding term exceeds NTT_ACCUMULATION");
+    void blind(Ciphertext* out, const std::uint32_t* tr, std::uint32_t* acc, std::size_t count) const {
+        for (std::size_t i = 0; i <= Params::dx + Params::dr; ++i) {
+            for (std::size_t j = 0; i + j <= Params::dx + Params::dr; ++j) {
+                for (std::size_t m = 0; m < count; ++m) {
+                    Multiplier::clear(acc);
+                    for (std::size_t xi = 0; xi <= std::min(i, Params::dx); ++xi) {
+                        for (std::size_t xj = 0; xj <= j && xi + xj <= Params::dx; ++xj) {
+                            const std::size_t ri = i - xi;
+                            const std::size_t rj = j - xj;
+                            if (ri + rj <= Params::dr) {
+                                Multiplier::mul_acc(acc, transformed + PublicPoly::index(xi, xj) * W,
+                                                    tr + (m * Blinding::terms + Blinding::index(ri, rj)) * W);
+                            }
+                        }
+                    }
+                    Multiplier::inverse(out[m](i, j).data(), acc);
+                }
+            }
+        }
+    }
+
+    // c += L * e + m, with e(x, y) of total degree dc and coefficients in [0, L)
+    static void add_noise(Ciphertext& c, Noise& e, const Ring& message) {
+        e *= Params::noise_bound;
+        for (std::size_t i = 0; i <= Params::dc; ++i) {
+            for (std::size_t j = 0; i + j <= Params::dc; ++j) {
+                c(i, j) += e(i, j);
+            }
+        }
+        c(0, 0) += message;
+    }
+
+public:
+    // Words of the X term transforms, as returned by transforms()
+    static constexpr std::size_t TRANSFORM_WORDS = PublicPoly::terms * W;
+
+    explicit EncryptionContext(const PublicPoly& X) : X(X), storage(TRANSFORM_WORDS), transformed(storage.data()) {
+        GIOPHANTUS_TRACE_SCOPE("giophantus::encryption_context");
+        for (std::size_t k = 0; k < PublicPoly::terms; ++k) {
+            Multiplier::forward(storage.data() + k * W, X[k].data());
+        }
+        ScratchArena::local().reserve(scratch_bytes());
+    }
+
+    // Context over transforms computed earlier by this build; the table must outlive the context
+    EncryptionContext(const PublicPoly& X, const std::uint32_t* transforms) : X(X), transformed(transforms) {
+        ScratchArena::local().reserve(scratch_bytes());
+    }
+
+    EncryptionContext(const EncryptionContext& other)
+        : X(other.X), storage(other.storage), transformed(storage.empty() ? other.transformed : storage.data()) {}
+
+    EncryptionContext& operator=(const EncryptionContext& other) {
+        if (this != &other) {
+            X = other.X;
+            storage = other.storage;
+            transformed = storage.empty() ? other.transformed : storage.data();
+        }
+        return *this;
+    }
+
+    // Moving keeps the table where it is, owned or borrowed
+    EncryptionContext(EncryptionContext&&) = default;
+    EncryptionContext& operator=(EncryptionContext&&) = default;
+
+    const std::uint32_t* transforms() const {
+        return transformed;
+    }
+
+    // Arena space taken by one group of encrypt_many, including alignment padding
+    static constexpr std::size_t scratch_bytes() {
+        constexpr std::size_t pad = ScratchArena::ALIGNMENT;
+        return (GROUP * Blinding::terms + 1) * W * sizeof(std::uint32_t) + GROUP * (sizeof(Blinding) + sizeof(Noise)) + 4 * pad;
+    }
+
+    const PublicPoly& public_key() const {
+        return X;
+    }
+
+    Ciphertext encrypt(const Ring& message, RandomPolynomialGenerator& rng) const {
+        Ciphertext c;
+        encrypt_many(std::span<const Ring>(&message, 1), std::span<Ciphertext>(&c, 1), rng);
+        return c;
+    }
+
+    // Parallel batch: groups of GROUP messages are spread over the pool, every group
+    // drawing its randomness from the generator of the thread that runs it
+    void encrypt_many(std::span<const Ring> messages, std::span<Ciphertext> ciphertexts, ThreadPool& pool) const {
+        assert(messages.size() == ciphertexts.size());
+        const std::size_t groups = (messages.size() + GROUP - 1) / GROUP;
+        pool.parallel_for(groups, [&](std::size_t g) {
+            const std::size_t first = g * GROUP;
+            const std::size_t count = std::min(GROUP, messages.size() - first);
+            encrypt_many(messages.subspan(first, count), ciphertexts.subspan(first, count), RandomPolynomialGenerator::local());
+        });
+    }
+
+    // ciphertexts[k] = Enc(messages[k]); randomness is drawn message by message (r, then e),
+    // so the result matches encrypting the messages one at a time from the same generator
+    void encrypt_many(std::span<const Ring> messages, std::span<Ciphertext> ciphertexts, RandomPolynomialGenerator& rng) const {
+        assert(messages.size() == ciphertexts.size());
+        GIOPHANTUS_PHASE(Encrypt);
+        ArenaScope scope;
+        std::uint32_t* tr = scope.allocate<std::uint32_t>(GROUP * Blinding::terms * W);
+        std::uint32_t* acc = scope.allocate<std::uint32_t>(W);
+        Blinding* r = scope.allocate<Blinding>(GROUP);
+        Noise* e = scope.allocate<Noise>(GROUP);
+
+        for (std::size_t first = 0; first < messages.size(); first += GROUP) {
+            const std::size_t count = std::min(GROUP, messages.size() - first);
+            for (std::size_t m = 0; m < count; ++m) {
+                rng.fill_terms(r[m], Params::Q);
+                rng.fill_terms(e[m], Params::noise_bound);
+                for (std::size_t k = 0; k < Blinding::terms; ++k) {
+                    Multiplier::forward(tr + (m * Blinding::terms + k) * W, r[m][k].data());
+                }
+            }
+
+            Ciphertext* out = ciphertexts.data() + first;
+            blind(out, tr, acc, count);
+            for (std::size_t m = 0; m < count; ++m) {
+                add_noise(out[m], e[m], messages[first + m]);
+            }
+        }
+    }
+};
+
+// Decryption under one secret key. The monomials ux^i uy^j of every ciphertext term are multiplied
+// out and transformed once in the constructor, so each decryption only transforms the ciphertext
+// terms and accumulates their products with the cached tables: m = c(ux, uy) mod L.
+template <class Params>
+class DecryptionContext {
+public:
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+
+private:
+    using Multiplier = typename Ring::Multiplier;
+    static constexpr std::size_t W = Multiplier::transform_words;
+    // Both decrypt_into overloads sum one product per non-constant ciphertext term
+    static_assert(Ciphertext::terms - 1 <= NTT_ACCUMULATION, "ciphertext degree exceeds NTT_ACCUMULATION");
+
+    GiophantusKey<Params> key;
+    // Transform of ux^i uy^j for slot k = Ciphertext::index(i, j) at (k - 1) * W; the constant
+    // term needs none. Held in storage or borrowed like the tables of EncryptionContext.
+    std::vector<std::uint32_t> storage;
+    const std::uint32_t* powers;
+
+public:
+    static constexpr std::size_t TRANSFORM_WORDS = (Ciphertext::terms - 1) * W;
+
+    explicit DecryptionContext(const GiophantusKey<Params>& key) : key(key), storage(TRANSFORM_WORDS), powers(storage.data()) {
+        GIOPHANTUS_TRACE_SCOPE("giophantus::decryption_context");
+        std::vector<Ring> monomials(Ciphertext::terms);
+        const Ring ux = key.ux.ring(), uy = key.uy.ring();
+        SparseRq<Ring> small_x, small_y;
+        if constexpr (SparseRq<Ring>::use_sparse) {
+            small_x = SparseRq<Ring>(key.ux, Params::noise_bound);
+            small_y = SparseRq<Ring>(key.uy, Params::noise_bound);
+        }
+        for (std::size_t k = 1; k < Ciphertext::terms; ++k) {
+            const auto [i, j] = Ciphertext::exponents[k];
+            // Each monomial is the one before it times a secret
+            const Ring& previous = monomials[j > 0 ? Ciphertext::index(i, j - 1) : Ciphertext::index(i - 1, 0)];
+            if (i + j == 1) {
+                monomials[k] = i == 1 ? ux : uy;
+            } else if constexpr (SparseRq<Ring>::use_sparse) {
+                SparseRq<Ring>::mul_into(monomials[k], previous, j > 0 ? small_y : small_x);
+            } else {
+                Ring::mul_into(monomials[k], previous, j > 0 ? uy : ux);
+            }
+            Multiplier::forward(storage.data() + (k - 1) * W, monomials[k].data());
+        }
+        ScratchArena::local().reserve(scratch_bytes());
+    }
+
+    DecryptionContext(const GiophantusKey<Params>& key, const std::uint32_t* transforms) : key(key), powers(transforms) {
+        ScratchArena::local().reserve(scratch_bytes());
+    }
+
+    DecryptionContext(const DecryptionContext& other)
+        : key(other.key), storage(other.storage), powers(storage.empty() ? other.powers : storage.data()) {}
+
+    DecryptionContext& operator=(const DecryptionContext& other) {
+        if (this != &other) {
+            key = other.key;
+            storage = other.storage;
+            powers = storage.empty() ? other.powers : storage.data();
+        }
+        return *this;
+    }
+
+    // Moving keeps the table where it is, owned or borrowed
+    DecryptionContext(DecryptionContext&&) = default;
+    DecryptionContext& operator=(DecryptionContext&&) = default;
+
+    const std::uint32_t* transforms() const {
+        return powers;
+    }
+
+    static constexpr std::size_t scratch_bytes() {
+        return 2 * W * sizeof(std::uint32_t) + sizeof(Ring) + 3 * ScratchArena::ALIGNMENT;
+    }
+
+    const GiophantusKey<Params>& secret_key() const {
+        return key;
+    }
+
+    void decrypt_into(Ring& m, const Ciphertext& c) const {
+        GIOPHANTUS_PHASE(Decrypt);
+        evaluate_into(m, c);
+        m.reduce(Params::noise_bound);
+    }
+
+    // w = c(ux, uy), the decryption before the reduction mod L: m + L * e(ux, uy) while that stays
+    // below q, which is what giophantus_noise measures
+    void evaluate_into(Ring& w, const Ciphertext& c) const {
+        ArenaScope scope;
+        std::uint32_t* acc = scope.allocate<std::uint32_t>(2 * W);
+        std::uint32_t* tc = acc + W;
+        Multiplier::clear(acc);
+        for (std::size_t k = 1; k < Ciphertext::terms; ++k) {
+            Multiplier::forward(tc, c[k].data());
+            Multiplier::mul_acc(acc, tc, powers + (k - 1) * W);
+        }
+        Multiplier::inverse(w.data(), acc);
+        w += c[0];
+    }
+
+    // Decryption straight from an encoded ciphertext; terms are transformed from the buffer itself
+    // when it allows. The coefficients must be reduced (CiphertextView::valid).
+    void decrypt_into(Ring& m, const CiphertextView<Params>& c) const {
+        GIOPHANTUS_PHASE(Decrypt);
+        ArenaScope scope;
+        std::uint32_t* acc = scope.allocate<std::uint32_t>(2 * W);
+        std::uint32_t* tc = acc + W;
+        Ring* scratch = scope.allocate<Ring>(1);
+        Multiplier::clear(acc);
+        for (std::size_t k = 1; k < Ciphertext::terms; ++k) {
+            Multiplier::forward(tc, c[k].coefficients(*scratch));
+            Multiplier::mul_acc(acc, tc, powers + (k - 1) * W);
+        }
+        Multiplier::inverse(m.data(), acc);
+        simd::kernels().add(m.data(), m.data(), c[0].coefficients(*scratch), Ring::dimension, Ring::modulus);
+        m.reduce(Params::noise_bound);
+    }
+
+    Ring decrypt(const Ciphertext& c) const {
+        Ring m;
+        decrypt_into(m, c);
+        return m;
+    }
+
+    void decrypt_many(std::span<const Ciphertext> ciphertexts, std::span<Ring> messages, ThreadPool& pool) const {
+        assert(messages.size() == ciphertexts.size());
+        pool.parallel_for(ciphertexts.size(), [&](std::size_t k) { decrypt_into(messages[k], ciphertexts[k]); });
+    }
+};
+
+class GiophantusCipher {
+public:
+    template <class Params>
+    static typename Params::Ciphertext encrypt(const typename Params::PublicPoly& X, const typename Params::Ring& message,
+                                               RandomPolynomialGenerator& rng) {
+        return EncryptionContext<Params>(X).encrypt(message, rng);
+    }
+
+    // m = c(ux, uy) mod L: X * r vanishes at the root and L * e(ux, uy) + m does not wrap modulo q
+    template <class Params>
+    static typename Params::Ring decrypt(const GiophantusKey<Params>& key, const typename Params::Ciphertext& c) {
+        typename Params::Ring m;
+        decrypt_into(m, key, c);
+        return m;
+    }
+
+    template <class Params>
+    static void decrypt_into(typename Params::Ring& m, const GiophantusKey<Params>& key, const typename Params::Ciphertext& c) {
+        GIOPHANTUS_PHASE(Decrypt);
+        detail::evaluate_at_secrets(m, c, key);
+        m.reduce(Params::noise_bound);
+    }
+
+    template <class Params>
+    static void decrypt_many(const GiophantusKey<Params>& key, std::span<const typename Params::Ciphertext> ciphertexts,
+                             std::span<typename Params::Ring> messages, ThreadPool& pool) {
+        DecryptionContext<Params>(key).decrypt_many(ciphertexts, messages, pool);
+    }
+};
+
+} // namespace giophantus
+
+#endif
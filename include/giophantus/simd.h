@@ -0,0 +1,67 @@
+// Vectorized coefficient kernels with runtime CPU dispatch
+#ifndef GIOPHANTUS_SIMD_H
+#define GIOPHANTUS_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace simd {
+
+enum class Backend {
+    Scalar,
+    Sse42,
+    Avx2,
+    Avx512,
+    Neon,
+};
+
+// Odd modulus q < 2^31 together with -q^-1 mod 2^32 for Montgomery products (R = 2^32)
+struct Modulus {
+    std::uint32_t q;
+    std::uint32_t qinv;
+};
+
+// Every kernel works on n coefficients, accepts any alignment and any n, expects inputs
+// reduced modulo q (unless noted) and may run in place.
+struct Kernels {
+    Backend backend;
+    const char* name;
+
+    // c = a + b, c = a - b (mod q)
+    void (*add)(std::uint32_t* c, const std::uint32_t* a, const std::uint32_t* b, std::size_t n, std::uint32_t q);
+    void (*sub)(std::uint32_t* c, const std::uint32_t* a, const std::uint32_t* b, std::size_t n, std::uint32_t q);
+    // c = a * s (mod q) with s < q; a may be any 32-bit value
+    void (*scalar_mul)(std::uint32_t* c, const std::uint32_t* a, std::uint32_t s, std::size_t n, std::uint32_t q);
+    // acc += a * s (mod q) with s < q
+    void (*scalar_mul_acc)(std::uint32_t* acc, const std::uint32_t* a, std::uint32_t s, std::size_t n, std::uint32_t q);
+    // acc += a * s in 64-bit lanes, unreduced: the caller keeps every sum below 2^64
+    void (*mul_acc_wide)(std::uint64_t* acc, const std::uint32_t* a, std::uint32_t s, std::size_t n);
+    // a = a mod l for 2 <= l < 2^16 and a < 2^31
+    void (*reduce)(std::uint32_t* a, std::size_t n, std::uint32_t l);
+
+    // Montgomery domain: c = a * b * R^-1, acc += a * b * R^-1, c = a * s * R^-1 (mod q).
+    // The product of every pair of operands must stay below q * 2^32.
+    void (*mont_mul)(std::uint32_t* c, const std::uint32_t* a, const std::uint32_t* b, std::size_t n, Modulus m);
+    void (*mont_mul_acc)(std::uint32_t* acc, const std::uint32_t* a, const std::uint32_t* b, std::size_t n, Modulus m);
+    void (*mont_scale)(std::uint32_t* c, const std::uint32_t* a, std::uint32_t s, std::size_t n, Modulus m);
+
+    // NTT butterflies over two half-blocks x, y with Montgomery-form twiddles w:
+    // DIF: (x, y) <- (x + y, (x - y) * w); DIT: (x, y) <- (x + y * w, x - y * w)
+    void (*dif_butterflies)(std::uint32_t* x, std::uint32_t* y, const std::uint32_t* w, std::size_t n, Modulus m);
+    void (*dit_butterflies)(std::uint32_t* x, std::uint32_t* y, const std::uint32_t* w, std::size_t n, Modulus m);
+};
+
+// Kernels in use. The fastest backend supported by the CPU is picked on first call; the
+// GIOPHANTUS_SIMD environment variable (scalar, sse4.2, avx2, avx512, neon) overrides it.
+const Kernels& kernels();
+
+// Table for one backend, or nullptr when it was not compiled in or the CPU lacks it
+const Kernels* find(Backend backend);
+
+// Switches the active backend; returns false (keeping the current one) when unavailable.
+// Not synchronized with running kernels: call it before spawning workers.
+bool select(Backend backend);
+
+} // namespace simd
+
+#endif
@@ -0,0 +1,105 @@
+// Packed elements of Rl: ring elements with coefficients in [0, L), the type of the secrets
+#ifndef GIOPHANTUS_SMALL_H
+#define GIOPHANTUS_SMALL_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "giophantus/field.h"
+
+namespace giophantus {
+
+// Small Ring Element
+// Coefficients of [0, L) in bits each, the width of L - 1 rounded up to a power of two so that
+// none straddles a byte, the first coefficient in the high bits: for L = 4 this is the Rl2OS
+// encoding itself, N / 4 bytes against the 4N of an Rq element. Arithmetic happens elsewhere:
+// ring() expands to Rq for the dense products, and SparseRq reads the coefficients directly.
+template <class Ring, Fq L>
+class Rl {
+    static_assert(L >= 1 && L <= 256, "small coefficients fit in a byte");
+    static constexpr std::size_t N = Ring::dimension;
+
+public:
+    static constexpr unsigned bits = std::bit_ceil(static_cast<unsigned>(std::bit_width(std::max<Fq>(L - 1, 1))));
+    static constexpr unsigned per_byte = 8 / bits;
+    static constexpr std::size_t size_bytes = (N + per_byte - 1) / per_byte;
+    static constexpr std::size_t dimension = N;
+    static constexpr Fq bound = L;
+    // Largest storable coefficient, L - 1 or more when L is not a power of two
+    static constexpr Fq max_value = (1u << bits) - 1;
+
+private:
+    std::array<std::uint8_t, size_bytes> packed{};
+
+    static constexpr unsigned shift(std::size_t i) {
+        return 8 - bits * static_cast<unsigned>(i % per_byte + 1);
+    }
+
+public:
+    Rl() = default;
+
+    // f's coefficients must be at most max_value
+    explicit Rl(const Ring& f) {
+        for (std::size_t i = 0; i < N; ++i) {
+            assert(f[i] <= max_value);
+            packed[i / per_byte] |= static_cast<std::uint8_t>(f[i] << shift(i));
+        }
+    }
+
+    Fq operator[](std::size_t i) const {
+        return packed[i / per_byte] >> shift(i) & max_value;
+    }
+
+    void set(std::size_t i, Fq value) {
+        assert(value <= max_value);
+        std::uint8_t& byte = packed[i / per_byte];
+        byte = static_cast<std::uint8_t>((byte & ~(max_value << shift(i))) | value << shift(i));
+    }
+
+    // Every coefficient below L; always true when L is a power of two
+    bool reduced() const {
+        if constexpr (max_value == L - 1) {
+            return true;
+        } else {
+            Fq out_of_range = 0;
+            for (std::size_t i = 0; i < N; ++i) {
+                out_of_range |= static_cast<Fq>((*this)[i] >= L);
+            }
+            return out_of_range == 0;
+        }
+    }
+
+    Ring ring() const {
+        Ring f;
+        for (std::size_t i = 0; i < N; ++i) {
+            f[i] = (*this)[i];
+        }
+        return f;
+    }
+
+    const std::uint8_t* data() const { return packed.data(); }
+
+    // Bytes in the layout above; bits past the last coefficient are cleared
+    void assign_bytes(const std::uint8_t* in) {
+        std::copy(in, in + size_bytes, packed.begin());
+        if constexpr (N % per_byte != 0) {
+            packed[size_bytes - 1] &= static_cast<std::uint8_t>(0xff << (8 - bits * (N % per_byte)));
+        }
+    }
+
+    bool operator==(const Rl& other) const {
+        return packed == other.packed;
+    }
+
+    bool operator!=(const Rl& other) const {
+        return !(*this == other);
+    }
+};
+
+} // namespace giophantus
+
+#endif
@@ -0,0 +1,130 @@
+// Products with small-coefficient ring elements: the secrets ux, uy have coefficients below L
+#ifndef GIOPHANTUS_SPARSE_H
+#define GIOPHANTUS_SPARSE_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "giophantus/arena.h"
+#include "giophantus/field.h"
+#include "giophantus/instrument.h"
+#include "giophantus/simd.h"
+
+#ifndef GIOPHANTUS_SPARSE_SECRETS
+#define GIOPHANTUS_SPARSE_SECRETS 0
+#endif
+
+namespace giophantus {
+
+// Secret-dependent row additions for the products with ux and uy; off by default
+constexpr bool SPARSE_SECRETS = GIOPHANTUS_SPARSE_SECRETS != 0;
+
+// Small Ring Element
+// The nonzero coefficients of an element of Rq below a small bound, as positions grouped by
+// value. A product with a uniform b adds one shifted row of b per position into a sum for its
+// value, with the reduced vector additions and no multiplies; the sums for value v > 1 then
+// enter the result with one scalar product each: about 3N^2 / 4 additions for L = 4, against
+// N^2 multiply-reduce steps for the schoolbook and the transforms of the NTT. Which rows are
+// added depends on the element, so the time does: the scheme only multiplies its secrets this
+// way when configured with -DGIOPHANTUS_SPARSE_SECRETS=ON (see use_sparse), and such a build
+// does not decrypt in constant time. Keygen, validate and decryption stay dense otherwise.
+template <class Ring>
+class SparseRq {
+    static constexpr std::size_t N = Ring::dimension;
+    static constexpr Fq Q = Ring::modulus;
+    static_assert(N <= 0x10000, "positions are 16-bit");
+
+public:
+    // Values are grouped, one bucket per value
+    static constexpr Fq MAX_BOUND = 256;
+
+    // Whether the scheme multiplies by secrets this way: opt-in, and never under CONSTANT_TIME
+    static constexpr bool use_sparse = SPARSE_SECRETS && !CONSTANT_TIME;
+
+    SparseRq() = default;
+
+    // s, an element of Rq or Rl, must have coefficients below bound, bound <= min(MAX_BOUND, q)
+    template <class Small>
+    SparseRq(const Small& s, Fq bound) : bound(bound) {
+        assert(bound >= 1 && bound <= MAX_BOUND && bound <= Q);
+        for (std::size_t i = 0; i < N; ++i) {
+            assert(s[i] < bound);
+            ++first[s[i] + 1];
+        }
+        for (Fq v = 1; v <= bound; ++v) {
+            first[v] += first[v - 1];
+        }
+        std::array<std::uint32_t, MAX_BOUND + 1> next = first;
+        for (std::size_t i = 0; i < N; ++i) {
+            positions[next[s[i]]++] = static_cast<std::uint16_t>(i);
+        }
+    }
+
+    // Nonzero coefficients
+    std::size_t weight() const {
+        return N - first[1];
+    }
+
+    Ring dense() const {
+        Ring s;
+        for (Fq v = 1; v < bound; ++v) {
+            for (std::uint32_t k = first[v]; k < first[v + 1]; ++k) {
+                s[positions[k]] = v;
+            }
+        }
+        return s;
+    }
+
+    // acc += b * s
+    void mul_acc(Ring& acc, const Ring& b) const {
+        instrument::count(instrument::Counter::RingMultiplies);
+        const simd::Kernels& k = simd::kernels();
+        add_rows(k, acc.data(), b.data(), 1);
+        if (bound > 2) {
+            ArenaScope scope;
+            std::uint32_t* sum = scope.allocate<std::uint32_t>(N);
+            for (Fq v = 2; v < bound; ++v) {
+                if (first[v] == first[v + 1]) {
+                    continue;
+                }
+                std::fill(sum, sum + N, 0);
+                add_rows(k, sum, b.data(), v);
+                k.scalar_mul_acc(acc.data(), sum, v, N, Q);
+            }
+        }
+    }
+
+    // out = b * s; out must not alias b
+    static void mul_into(Ring& out, const Ring& b, const SparseRq& s) {
+        out = Ring{};
+        s.mul_acc(out, b);
+    }
+
+    friend Ring operator*(const Ring& b, const SparseRq& s) {
+        Ring result;
+        mul_into(result, b, s);
+        return result;
+    }
+
+private:
+    Fq bound = 1;
+    // Positions of value v at [first[v], first[v + 1])
+    std::array<std::uint32_t, MAX_BOUND + 1> first{};
+    std::array<std::uint16_t, N> positions{};
+
+    // sum += b t^i for every position i of value v
+    void add_rows(const simd::Kernels& k, std::uint32_t* sum, const std::uint32_t* b, Fq v) const {
+        for (std::uint32_t e = first[v]; e < first[v + 1]; ++e) {
+            const std::size_t i = positions[e];
+            k.add(sum + i, sum + i, b, N - i, Q);
+            k.add(sum, sum, b + (N - i), i, Q);
+        }
+    }
+};
+
+} // namespace giophantus
+
+#endif
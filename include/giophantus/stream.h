@@ -0,0 +1,132 @@
+// Hybrid encryption of byte streams: one Giophantus encryption per stream, AES-256-GCM per chunk
+#ifndef GIOPHANTUS_STREAM_H
+#define GIOPHANTUS_STREAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+#include "giophantus/params.h"
+#include "giophantus/pke.h"
+#include "giophantus/random.h"
+#include "giophantus/sampling.h"
+
+namespace giophantus {
+
+enum class StreamStatus {
+    Ok,
+    ReadError,  // the reader failed
+    WriteError, // the writer failed
+    BadHeader,  // not a stream of this parameter set, or an unsupported chunk size
+    BadKey,     // the public key holds an unreduced coefficient
+    Corrupt,    // the header ciphertext or a chunk failed authentication
+    Truncated,  // the input ended before the final chunk
+    TooLong,    // more than 2^32 chunks
+};
+
+const char* stream_status_name(StreamStatus status);
+
+// Fills out with up to capacity bytes and sets length; fewer than capacity only at end of
+// input. False on a read error.
+using StreamReader = std::function<bool(std::uint8_t* out, std::size_t capacity, std::size_t& length)>;
+// Consumes all length bytes; false on a write error
+using StreamWriter = std::function<bool(const std::uint8_t* data, std::size_t length)>;
+
+// Adapters over stdio; the file must outlive the returned function
+StreamReader file_reader(std::FILE* file);
+StreamWriter file_writer(std::FILE* file);
+
+// Stream layout:
+//
+//   preamble   magic "GIOSTRM1", then N and the chunk size as 32-bit little-endian integers
+//   capsule    GiophantusPke ciphertext of a random MESSAGE_BYTES seed
+//   chunks     every chunk_bytes of input as AES-256-GCM ciphertext || 16-byte tag; the final
+//              chunk is shorter than chunk_bytes (and empty when the input fills the last one)
+//
+// key || nonce prefix = SHAKE256(preamble || capsule || seed), so the header is authenticated
+// through the key. Chunk k has nonce prefix || k (32-bit big-endian) || final, the STREAM
+// construction of Hoang, Reyhanitabar, Rogaway and Vizar: chunks cannot be reordered, dropped,
+// or cut off at a chunk boundary without the opener noticing.
+constexpr char STREAM_MAGIC[8] = {'G', 'I', 'O', 'S', 'T', 'R', 'M', '1'};
+constexpr std::size_t STREAM_PREAMBLE_BYTES = 16;
+constexpr std::size_t STREAM_DEFAULT_CHUNK = std::size_t{1} << 20;
+constexpr std::size_t STREAM_MAX_CHUNK = std::size_t{1} << 30;
+
+struct StreamKey {
+    static constexpr std::size_t NONCE_PREFIX_BYTES = 7;
+    std::uint8_t key[csprng::Aes256Gcm::KEY_BYTES];
+    std::uint8_t nonce_prefix[NONCE_PREFIX_BYTES];
+};
+
+void write_stream_preamble(std::uint8_t* out, std::size_t n, std::size_t chunk_bytes);
+// The chunk size of a preamble for dimension n; 0 when it is not one
+std::size_t read_stream_preamble(const std::uint8_t* in, std::size_t n);
+
+StreamKey derive_stream_key(const std::uint8_t* header, std::size_t header_bytes, const std::uint8_t* seed, std::size_t seed_bytes);
+
+// The chunk layer alone. Reads, crypto and writes overlap: a reader thread fills and a writer
+// thread drains a ring of three chunk buffers while the calling thread seals or opens, so memory
+// stays at three chunks whatever the stream length. The reader and the writer are called from
+// those threads, never concurrently with themselves.
+StreamStatus seal_chunks(const StreamKey& key, std::size_t chunk_bytes, const StreamReader& in, const StreamWriter& out);
+
+// Every chunk is authenticated before it is written, but a stream that fails later has written
+// the chunks before the failure: discard the output unless the result is Ok.
+StreamStatus open_chunks(const StreamKey& key, std::size_t chunk_bytes, const StreamReader& in, const StreamWriter& out);
+
+template <class Params>
+class HybridStream {
+public:
+    using Pke = GiophantusPke<Params>;
+
+    static constexpr std::size_t HEADER_BYTES = STREAM_PREAMBLE_BYTES + Pke::CIPHERTEXT_BYTES;
+
+    static StreamStatus encrypt(const std::uint8_t* pk, const StreamReader& in, const StreamWriter& out,
+                                RandomPolynomialGenerator& rng, std::size_t chunk_bytes = STREAM_DEFAULT_CHUNK) {
+        if (chunk_bytes == 0 || chunk_bytes > STREAM_MAX_CHUNK) {
+            return StreamStatus::BadHeader;
+        }
+        std::array<std::uint8_t, HEADER_BYTES> header;
+        std::array<std::uint8_t, Pke::MESSAGE_BYTES> seed;
+        rng.random_bytes(seed.data(), seed.size());
+        write_stream_preamble(header.data(), Params::N, chunk_bytes);
+        if (!Pke::encrypt(header.data() + STREAM_PREAMBLE_BYTES, seed.data(), pk, rng)) {
+            return StreamStatus::BadKey;
+        }
+        if (!out(header.data(), header.size())) {
+            return StreamStatus::WriteError;
+        }
+        const StreamKey key = derive_stream_key(header.data(), header.size(), seed.data(), seed.size());
+        return seal_chunks(key, chunk_bytes, in, out);
+    }
+
+    static StreamStatus decrypt(const std::uint8_t* sk, const StreamReader& in, const StreamWriter& out) {
+        std::array<std::uint8_t, HEADER_BYTES> header;
+        std::size_t length = 0;
+        if (!in(header.data(), header.size(), length)) {
+            return StreamStatus::ReadError;
+        }
+        if (length < STREAM_PREAMBLE_BYTES) {
+            return StreamStatus::BadHeader;
+        }
+        const std::size_t chunk_bytes = read_stream_preamble(header.data(), Params::N);
+        if (chunk_bytes == 0) {
+            return StreamStatus::BadHeader;
+        }
+        if (length < header.size()) {
+            return StreamStatus::Truncated;
+        }
+        std::array<std::uint8_t, Pke::MESSAGE_BYTES> seed;
+        if (!Pke::decrypt(seed.data(), header.data() + STREAM_PREAMBLE_BYTES, sk)) {
+            return StreamStatus::Corrupt;
+        }
+        const StreamKey key = derive_stream_key(header.data(), header.size(), seed.data(), seed.size());
+        return open_chunks(key, chunk_bytes, in, out);
+    }
+};
+
+} // namespace giophantus
+
+#endif
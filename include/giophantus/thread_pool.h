@@ -0,0 +1,167 @@
+// Work-stealing thread pool
+#ifndef GIOPHANTUS_THREAD_POOL_H
+#define GIOPHANTUS_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace giophantus {
+
+// Work-Stealing Thread Pool
+// Every worker owns a deque: it pushes and pops its own tasks at the back and, when empty,
+// steals from the front of the others. Threads waiting in parallel_for run queued tasks
+// instead of blocking, so parallel regions can nest (a batch task multiplying a Pq).
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(std::size_t workers = std::max(1u, std::thread::hardware_concurrency())) {
+        for (std::size_t i = 0; i < workers; ++i) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (std::size_t i = 0; i < workers; ++i) {
+            threads.emplace_back([this, i] { run_worker(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool with one worker per hardware thread
+    static ThreadPool& shared() {
+        static ThreadPool instance;
+        return instance;
+    }
+
+    std::size_t size() const {
+        return threads.size();
+    }
+
+    // Workers queue onto their own deque; other threads spread tasks round robin. pending counts
+    // the task before it is visible, so a thief's decrement never runs ahead of it.
+    void submit(Task task) {
+        const std::size_t target = current_pool == this ? current_index : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        pending.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->lock);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_lock);
+        }
+        wake.notify_one();
+    }
+
+    // body(k) for every k in [0, count), returning once all of them finished. The range is cut
+    // into a few chunks per worker; the caller takes part. body must not throw.
+    template <class Body>
+    void parallel_for(std::size_t count, Body&& body) {
+        if (count == 0) {
+            return;
+        }
+        const std::size_t chunks = std::min(count, 4 * size());
+        std::atomic<std::size_t> remaining(chunks);
+        for (std::size_t c = 0; c < chunks; ++c) {
+            const std::size_t first = count * c / chunks;
+            const std::size_t last = count * (c + 1) / chunks;
+            submit([&body, &remaining, first, last] {
+                for (std::size_t k = first; k < last; ++k) {
+                    body(k);
+                }
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!run_one()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<std::size_t> pending{0};
+    std::atomic<std::size_t> next_queue{0};
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    static inline thread_local ThreadPool* current_pool = nullptr;
+    static inline thread_local std::size_t current_index = 0;
+
+    bool pop(std::size_t queue, bool own, Task& task) {
+        Queue& q = *queues[queue];
+        std::lock_guard<std::mutex> lock(q.lock);
+        if (q.tasks.empty()) {
+            return false;
+        }
+        if (own) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Own queue first, then one steal attempt from each other queue
+    bool run_one() {
+        const bool worker = current_pool == this;
+        const std::size_t home = worker ? current_index : 0;
+        Task task;
+        bool found = worker && pop(home, true, task);
+        for (std::size_t k = worker ? 1 : 0; !found && k < queues.size(); ++k) {
+            found = pop((home + k) % queues.size(), false, task);
+        }
+        if (found) {
+            task();
+        }
+        return found;
+    }
+
+    void run_worker(std::size_t index) {
+        current_pool = this;
+        current_index = index;
+        while (true) {
+            if (run_one()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_lock);
+            wake.wait(lock, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+            if (stopping && pending.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+};
+
+} // namespace giophantus
+
+#endif
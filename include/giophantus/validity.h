@@ -0,0 +1,202 @@
+// Invertibility in Rq, the non-degeneracy condition on public keys
+#ifndef GIOPHANTUS_VALIDITY_H
+#define GIOPHANTUS_VALIDITY_H
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "giophantus/field.h"
+
+namespace giophantus {
+
+// Units of Rq = Fq[t] / (t^N - 1), q prime and coprime to N.
+//
+// t -> t^q permutes the coefficients and is the Frobenius a(t)^q = a(t^q), an automorphism of
+// Rq; k is its order, the order of q mod N. Elements it fixes are constant on the orbits
+// i -> q i of Z_N and form a subalgebra A of dimension d = number of orbits (13, 3 and 12 for
+// the IEC sets), where an element is a unit exactly when multiplication by it is invertible: a
+// d x d rank test over Fq. Membership of A reduces the question for a in two ways:
+//
+//   trace  P(a) = a(t) + a(t^q) + ... + a(t^(q^(k-1))), orbit sums of the coefficients. In each
+//          factor field of Rq it is the trace of a's component, so when P(a) is a unit no
+//          component of a vanishes and a is a unit. For a random a a trace vanishes with
+//          probability about d / q, and the test is inconclusive.
+//   norm   c = a(t) a(t^q) ... a(t^(q^(k-1))), a multiple of a and a product of units when a is
+//          one: a is a unit exactly when c is. floor(log2 k) + popcount(k) - 1 ring products
+//          through the addition chain of Itoh and Tsujii, on permuted copies of the running
+//          product.
+//
+// is_unit tries the trace, O(d N) field operations, and runs the norm only when it fails, so
+// a random element costs a few microseconds and a zero divisor a few NTT multiplies.
+template <class Ring>
+class UnitTest {
+    static constexpr std::size_t N = Ring::dimension;
+    static constexpr Fq Q = Ring::modulus;
+    using Field = typename Ring::Field;
+    static_assert(std::gcd(static_cast<std::size_t>(Q), N) == 1, "the Frobenius needs q coprime to N");
+
+    struct Orbits {
+        std::size_t order = 1;                      // k
+        std::vector<std::uint32_t> orbit;           // orbit of every exponent
+        std::vector<std::uint32_t> representatives; // smallest exponent of every orbit
+        std::vector<std::uint32_t> sizes;
+    };
+
+    static const Orbits& orbits() {
+        static const Orbits o = [] {
+            Orbits o;
+            o.orbit.assign(N, UINT32_MAX);
+            for (std::size_t i = 0; i < N; ++i) {
+                if (o.orbit[i] != UINT32_MAX) {
+                    continue;
+                }
+                const auto index = static_cast<std::uint32_t>(o.representatives.size());
+                o.representatives.push_back(static_cast<std::uint32_t>(i));
+                std::size_t j = i, size = 0;
+                do {
+                    o.orbit[j] = index;
+                    j = j * Q % N;
+                    ++size;
+                } while (j != i);
+                o.sizes.push_back(static_cast<std::uint32_t>(size));
+            }
+            for (std::size_t power = Q % N; power != 1 % N; power = power * Q % N) {
+                ++o.order;
+            }
+            return o;
+        }();
+        return o;
+    }
+
+    // out(t) = a(t^h)
+    static void conjugate(Ring& out, const Ring& a, std::size_t h) {
+        for (std::size_t i = 0, j = 0; i < N; ++i, j = (j + h) % N) {
+            out[j] = a[i];
+        }
+    }
+
+    static Fq inverse(Fq x) {
+        Fq result = 1;
+        for (Fq e = Q - 2; e != 0; e >>= 1) {
+            if (e & 1) {
+                result = Field::mul(result, x);
+            }
+            x = Field::mul(x, x);
+        }
+        return result;
+    }
+
+    // Gaussian elimination of a d x d matrix, row-major
+    static bool full_rank(std::vector<Fq>& m, std::size_t d) {
+        for (std::size_t col = 0; col < d; ++col) {
+            std::size_t pivot = col;
+            while (pivot < d && m[pivot * d + col] == 0) {
+                ++pivot;
+            }
+            if (pivot == d) {
+                return false;
+            }
+            for (std::size_t j = col; j < d; ++j) {
+                std::swap(m[col * d + j], m[pivot * d + j]);
+            }
+            const Fq scale = inverse(m[col * d + col]);
+            for (std::size_t row = col + 1; row < d; ++row) {
+                const Fq f = Field::mul(m[row * d + col], scale);
+                for (std::size_t j = col; j < d; ++j) {
+                    m[row * d + j] = Field::sub(m[row * d + j], Field::mul(f, m[col * d + j]));
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    // Dimension of the Frobenius-fixed subalgebra
+    static std::size_t orbit_count() {
+        return orbits().representatives.size();
+    }
+
+    // The order of q mod N: the Frobenius conjugates multiplied into the norm
+    static std::size_t frobenius_order() {
+        return orbits().order;
+    }
+
+    static bool is_unit(const Ring& a) {
+        return trace_is_unit(a) || norm_is_unit(a);
+    }
+
+    // True only when a is a unit; false is inconclusive
+    static bool trace_is_unit(const Ring& a) {
+        const Orbits& o = orbits();
+        const std::size_t d = o.representatives.size();
+        // Conjugates run over every orbit k / size times
+        std::vector<std::uint64_t> sums(d);
+        for (std::size_t i = 0; i < N; ++i) {
+            sums[o.orbit[i]] += a[i];
+        }
+        std::vector<Fq> scaled(d);
+        for (std::size_t p = 0; p < d; ++p) {
+            scaled[p] = Field::mul(Field::mod(sums[p]), Field::mod(o.order / o.sizes[p]));
+        }
+        Ring trace;
+        for (std::size_t i = 0; i < N; ++i) {
+            trace[i] = scaled[o.orbit[i]];
+        }
+        return fixed_is_unit(trace);
+    }
+
+    static bool norm_is_unit(const Ring& a) {
+        const std::size_t k = orbits().order;
+
+        // c = a(t) a(t^q) ... a(t^(q^(m-1))) and h = q^m mod N; doubling m multiplies c by its
+        // own conjugate under t -> t^h, adding one multiplies in a(t^h)
+        Ring c = a, conjugated, next;
+        std::size_t h = Q % N;
+        for (int bit = std::bit_width(k) - 2; bit >= 0; --bit) {
+            conjugate(conjugated, c, h);
+            Ring::mul_into(next, c, conjugated);
+            h = h * h % N;
+            if ((k >> bit) & 1) {
+                conjugate(conjugated, a, h);
+                Ring::mul_into(c, next, conjugated);
+                h = h * Q % N;
+            } else {
+                std::swap(c, next);
+            }
+        }
+        assert(h == 1 % N);
+        return fixed_is_unit(c);
+    }
+
+private:
+    // c in A. Multiplication by c on the orbit sums e_P: the e_R coordinate of c e_P is the
+    // coefficient of t^r in it, r the representative of R
+    static bool fixed_is_unit(const Ring& c) {
+        const Orbits& o = orbits();
+        const std::size_t d = o.representatives.size();
+        std::vector<std::uint64_t> sums(d);
+        std::vector<Fq> m(d * d);
+        for (std::size_t row = 0; row < d; ++row) {
+            const std::size_t r = o.representatives[row];
+            assert(c[r] == c[r * Q % N]);
+            std::fill(sums.begin(), sums.end(), 0);
+            for (std::size_t j = 0; j < N; ++j) {
+                sums[o.orbit[j]] += c[(r + N - j) % N];
+            }
+            for (std::size_t col = 0; col < d; ++col) {
+                m[row * d + col] = Field::mod(sums[col]);
+            }
+        }
+        return full_rank(m, d);
+    }
+};
+
+} // namespace giophantus
+
+#endif
@@ -1,168 +1,1476 @@
 // Redesigned Giophantus Cryptosystem - Parallel OOP C++ Implementation
 #include <iostream>
-#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <random>
+#include <span>
+#include <vector>
 #include <algorithm>
-//#include <execution>
-//#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <cassert>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
 
-constexpr int MODULO = 17; // Default modulus for the field
-constexpr int DEGREE = 11; // Default polynomial degree limit
-constexpr int NOISE_BOUND = 4; // Default noise magnitude
+#include "giophantus/api.h"
+#include "giophantus/giophantus.h"
 
-// Parameter Structure
-struct GiophantusParams {
-    int modulo;
-    int degree;
-    int noise_bound;
-    int block_size;
-};
+using namespace giophantus;
 
-// Field Arithmetic Utility
-class FieldArithmetic {
-public:
-    static int mod(int a, int modulo) {
-        return ((a % modulo) + modulo) % modulo;
+// Test Functions
+template <class Params>
+void test_keygen() {
+    const GiophantusParams params = Params::runtime();
+    auto key = GiophantusKeyGen::generate<Params>();
+    const auto ux = key.ux.ring(), uy = key.uy.ring();
+    assert(ux.degree() <= params.degree);
+    assert(uy.degree() <= params.degree);
+    assert(key.ux.reduced() && key.uy.reduced());
+    assert(std::all_of(ux.begin(), ux.end(), [](Fq c) { return c < Params::noise_bound; }));
+    assert(key.X.evaluate(ux, uy) == typename Params::Ring{});
+    std::cout << "Key generation test passed for params: modulo=" << params.modulo << ", degree=" << params.degree << std::endl;
+}
+
+// UnitTest against the rank of the N x N circulant of multiplication by a
+template <class Ring>
+void test_unit_test() {
+    using Field = typename Ring::Field;
+    constexpr std::size_t N = Ring::dimension;
+    RandomPolynomialGenerator rng(22);
+    std::size_t units = 0;
+    for (int trial = 0; trial < 64; ++trial) {
+        const Ring a = trial == 0 ? Ring{} : rng.generate<Ring>(trial % 2 == 0 ? 2 : Ring::modulus);
+        std::vector<Fq> m(N * N);
+        for (std::size_t i = 0; i < N; ++i) {
+            for (std::size_t j = 0; j < N; ++j) {
+                m[i * N + j] = a[(i + N - j) % N];
+            }
+        }
+        std::size_t rank = 0;
+        for (std::size_t col = 0; col < N && rank < N; ++col) {
+            std::size_t pivot = rank;
+            while (pivot < N && m[pivot * N + col] == 0) {
+                ++pivot;
+            }
+            if (pivot == N) {
+                continue;
+            }
+            std::swap_ranges(m.begin() + rank * N, m.begin() + (rank + 1) * N, m.begin() + pivot * N);
+            Fq scale = 1;
+            for (Fq e = Ring::modulus - 2, x = m[rank * N + col]; e != 0; e >>= 1, x = Field::mul(x, x)) {
+                scale = e & 1 ? Field::mul(scale, x) : scale;
+            }
+            for (std::size_t row = rank + 1; row < N; ++row) {
+                const Fq f = Field::mul(m[row * N + col], scale);
+                for (std::size_t j = col; j < N; ++j) {
+                    m[row * N + j] = Field::sub(m[row * N + j], Field::mul(f, m[rank * N + j]));
+                }
+            }
+            ++rank;
+        }
+        assert(UnitTest<Ring>::is_unit(a) == (rank == N));
+        assert(UnitTest<Ring>::norm_is_unit(a) == (rank == N));
+        assert(!UnitTest<Ring>::trace_is_unit(a) || rank == N);
+        units += rank == N;
+    }
+    assert(units > 0 && units < 64);
+    std::cout << "Unit test passed for N = " << N << ", q = " << Ring::modulus << " (" << UnitTest<Ring>::orbit_count()
+              << " Frobenius orbits, " << units << " of 64 units)" << std::endl;
+}
+
+template <class Params>
+void test_key_validation() {
+    using Ring = typename Params::Ring;
+    RandomPolynomialGenerator rng(23), same(23);
+    const GiophantusKey<Params> key = GiophantusKeyGen::generate<Params>(rng);
+    assert(GiophantusKeyGen::validate(key) == KeyStatus::Valid);
+    // No redraw: the validated key is the raw construction
+    assert(GiophantusKeyGen::generate_unchecked<Params>(same).X == key.X);
+
+    GiophantusKey<Params> bad = key;
+    // Packed secrets hold nothing above L - 1 when L is a power of two
+    if constexpr (Params::Secret::max_value >= Params::noise_bound) {
+        bad.ux.set(0, Params::noise_bound);
+        assert(GiophantusKeyGen::validate(bad) == KeyStatus::SecretOutOfRange);
+        bad = key;
     }
+    bad.X(0, 1)[0] = Params::Q;
+    assert(GiophantusKeyGen::validate(bad) == KeyStatus::Unreduced);
+    bad = key;
+    bad.X(0, 0)[0] = Ring::Field::add(bad.X(0, 0)[0], 1);
+    assert(GiophantusKeyGen::validate(bad) == KeyStatus::NotRoot);
+
+    // X10 = (t - 1) s vanishes at t = 1; rebalance X00 to keep (ux, uy) a root
+    bad = key;
+    Ring t_minus_1;
+    t_minus_1[1] = 1;
+    t_minus_1[0] = Params::Q - 1;
+    bad.X(1, 0) = t_minus_1 * rng.uniform<Ring>();
+    bad.X(0, 0) = Ring{};
+    bad.X(0, 0) -= bad.X.evaluate(bad.ux.ring(), bad.uy.ring());
+    assert(GiophantusKeyGen::validate(bad) == KeyStatus::Degenerate);
+    assert(!GiophantusKeyGen::nondegenerate<Params>(bad.X));
+    std::cout << "Key validation test passed for N = " << Params::N << " (Frobenius order " << UnitTest<Ring>::frobenius_order()
+              << ", " << UnitTest<Ring>::orbit_count() << " orbits)" << std::endl;
+}
 
-    static int add(int a, int b, int modulo) {
-        return mod(a + b, modulo);
+// SparseRq products against the dense ones, at the scheme's bound and at the largest one
+template <class Params>
+void test_sparse_products() {
+    using Ring = typename Params::Ring;
+    using Sparse = SparseRq<Ring>;
+    RandomPolynomialGenerator rng(24);
+    const Ring b = rng.uniform<Ring>();
+    const Fq bounds[] = {1, 2, Params::noise_bound, std::min(Sparse::MAX_BOUND, Params::Q)};
+    for (const Fq bound : bounds) {
+        const Ring s = rng.generate<Ring>(bound);
+        const Sparse sparse(s, bound);
+        assert(sparse.dense() == s);
+        assert(sparse.weight() == static_cast<std::size_t>(std::count_if(s.begin(), s.end(), [](Fq c) { return c != 0; })));
+        assert(b * sparse == b * s);
+        Ring acc = b;
+        sparse.mul_acc(acc, b);
+        assert(acc == b + b * s);
     }
 
-    static int mul(int a, int b, int modulo) {
-        return mod(a * b, modulo);
+    const GiophantusKey<Params> key = GiophantusKeyGen::generate<Params>(rng);
+    const Sparse x(key.ux, Params::noise_bound), y(key.uy, Params::noise_bound);
+    assert(key.X.evaluate(x, y) == key.X.evaluate(key.ux.ring(), key.uy.ring()));
+    assert(key.X.evaluate(x, y) == Ring{});
+    std::cout << "Sparse product test passed for N = " << Params::N << " (secret weight " << x.weight() << ")" << std::endl;
+}
+
+// Packed secrets: round trips through Rq and the byte layout, and the Rl2OS encoding for L = 4
+template <class Params>
+void test_small_ring() {
+    using Ring = typename Params::Ring;
+    using Secret = typename Params::Secret;
+    RandomPolynomialGenerator rng(25);
+    const Ring s = rng.generate<Ring>(Params::noise_bound);
+    const Secret packed(s);
+    assert(packed.ring() == s && packed.reduced());
+    for (std::size_t i = 0; i < Params::N; ++i) {
+        assert(packed[i] == s[i]);
     }
-};
 
-// Polynomial Representation
-class Polynomial {
-private:
-    std::vector<int> coeffs;
+    Secret copy;
+    copy.assign_bytes(packed.data());
+    assert(copy == packed);
+    copy.set(1, Secret::max_value);
+    assert(copy[1] == Secret::max_value && copy[0] == s[0] && copy[2] == s[2]);
+    assert(copy.reduced() == (Secret::max_value < Params::noise_bound));
+    copy.set(1, s[1]);
+    assert(copy == packed);
 
-public:
-    explicit Polynomial(int degree = 0) : coeffs(degree + 1, 0) {}
+    if constexpr (Secret::bits == 2) {
+        std::uint8_t bytes[ByteLayout<Params>::rl], expected[ByteLayout<Params>::rl];
+        ByteCodec::encode_small(bytes, packed);
+        ByteCodec::encode_small(expected, s);
+        assert(std::equal(bytes, bytes + sizeof(bytes), expected));
+        Secret decoded;
+        ByteCodec::decode_small(decoded, expected);
+        assert(decoded == packed);
+
+        // One-bit secrets widen to the same two-bit slots
+        const Ring t = rng.generate<Ring>(2);
+        ByteCodec::encode_small(bytes, Rl<Ring, 2>(t));
+        ByteCodec::encode_small(expected, t);
+        assert(std::equal(bytes, bytes + sizeof(bytes), expected));
+        Rl<Ring, 2> narrow;
+        ByteCodec::decode_small(narrow, expected);
+        assert(narrow.ring() == t);
+    }
+    std::cout << "Small ring test passed for N = " << Params::N << ", L = " << Params::noise_bound << " (" << Secret::bits
+              << " bits a coefficient, key " << sizeof(GiophantusKey<Params>) << " bytes)" << std::endl;
+}
+
+template <class Params>
+void test_polynomial_operations() {
+    using Ring = typename Params::Ring;
+    const GiophantusParams params = Params::runtime();
+
+    RandomPolynomialGenerator rng;
+    Ring p1 = rng.generate<Ring>(Params::noise_bound);
+    Ring p2 = rng.uniform<Ring>();
 
-    explicit Polynomial(const std::vector<int>& c) : coeffs(c) {}
+    Ring sum = p1 + p2;
+    Ring product = p1 * p2;
+    assert(sum - p2 == p1);
+    assert(product == p2 * p1);
 
-    int degree() const {
-        return coeffs.size() - 1;
+    // Multiplying by t rotates the coefficients one step, wrapping t^(N-1) back to t^0
+    Ring t;
+    t[1 % Params::N] = 1;
+    Ring rotated = p2 * t;
+    for (std::size_t i = 0; i < Params::N; ++i) {
+        assert(rotated[(i + 1) % Params::N] == p2[i]);
     }
 
-    void trim() {
-        while (!coeffs.empty() && coeffs.back() == 0) {
-            coeffs.pop_back();
+    std::cout << "Polynomial operations test passed for params: modulo=" << params.modulo << ", degree=" << params.degree << std::endl;
+}
+
+template <class Params>
+void test_bivariate_operations() {
+    using Ring = typename Params::Ring;
+    using P1 = Pq<Ring, 1>;
+    using P2 = Pq<Ring, 2>;
+
+    // POLYFOR order maps onto consecutive slots
+    std::size_t k = 0;
+    for (std::size_t i = 0; i <= 2; ++i) {
+        for (std::size_t j = 0; i + j <= 2; ++j) {
+            assert(P2::index(i, j) == k++);
         }
     }
+    assert(k == P2::terms);
 
-    Polynomial operator+(const Polynomial& other) const {
-        size_t max_size = std::max(coeffs.size(), other.coeffs.size());
-        std::vector<int> result(max_size, 0);
+    RandomPolynomialGenerator rng;
+    P1 a = rng.generate_terms<P1>(Params::Q);
+    P2 b = rng.generate_terms<P2>(Params::Q);
+    P2 b2 = rng.generate_terms<P2>(Params::Q);
+    Ring x = rng.generate<Ring>(Params::noise_bound);
+    Ring y = rng.generate<Ring>(Params::noise_bound);
+
+    // Substitution is a ring homomorphism Rq[x, y] -> Rq
+    const Pq<Ring, 3> product = a * b;
+    assert(product.evaluate(x, y) == a.evaluate(x, y) * b.evaluate(x, y));
+    assert((b + b2).evaluate(x, y) == b.evaluate(x, y) + b2.evaluate(x, y));
+    assert(product == b * a);
 
-        for (size_t i = 0; i < max_size; ++i) {
-            int a = (i < coeffs.size()) ? coeffs[i] : 0;
-            int b = (i < other.coeffs.size()) ? other.coeffs[i] : 0;
-            result[i] = FieldArithmetic::add(a, b, MODULO);
+    // Against a direct term-by-term expansion of a * b
+    Pq<Ring, 3> expected;
+    for (std::size_t ai = 0; ai <= 1; ++ai) {
+        for (std::size_t aj = 0; ai + aj <= 1; ++aj) {
+            for (std::size_t bi = 0; bi <= 2; ++bi) {
+                for (std::size_t bj = 0; bi + bj <= 2; ++bj) {
+                    expected(ai + bi, aj + bj) += a(ai, aj) * b(bi, bj);
+                }
+            }
         }
-        return Polynomial(result);
     }
+    assert(product == expected);
 
-    Polynomial operator*(const Polynomial& other) const {
-        size_t size = coeffs.size() + other.coeffs.size() - 1;
-        std::vector<int> result(size, 0);
+    std::cout << "Bivariate operations test passed for N=" << Params::N << ", q=" << Params::Q << std::endl;
+}
 
-        for (size_t i = 0; i < coeffs.size(); ++i) {
-            for (size_t j = 0; j < other.coeffs.size(); ++j) {
-                result[i + j] = FieldArithmetic::add(result[i + j], FieldArithmetic::mul(coeffs[i], other.coeffs[j], MODULO), MODULO);
+// f(x, y) as the sum of f_ij x^i y^j, the monomials by repeated products
+template <class Ring, std::size_t D>
+Ring evaluate_by_monomials(const Pq<Ring, D>& f, const Ring& x, const Ring& y) {
+    Ring one, sum;
+    one[0] = 1;
+    for (std::size_t i = 0; i <= D; ++i) {
+        for (std::size_t j = 0; i + j <= D; ++j) {
+            Ring monomial = one;
+            for (std::size_t e = 0; e < i; ++e) {
+                monomial = monomial * x;
             }
+            for (std::size_t e = 0; e < j; ++e) {
+                monomial = monomial * y;
+            }
+            sum += f(i, j) * monomial;
         }
-        return Polynomial(result);
     }
+    return sum;
+}
+
+template <class Ring, std::size_t D>
+void check_horner(RandomPolynomialGenerator& rng, Fq bound) {
+    const auto f = rng.generate_terms<Pq<Ring, D>>(Ring::modulus);
+    const Ring x = rng.generate<Ring>(bound), y = rng.generate<Ring>(bound);
+    const Ring expected = evaluate_by_monomials(f, x, y);
+    assert(f.evaluate(x, y) == expected);
+    assert(f.evaluate(SparseRq<Ring>(x, bound), SparseRq<Ring>(y, bound)) == expected);
+    // Uniform points too, and out aliasing an argument
+    const Ring u = rng.uniform<Ring>();
+    Ring out = u;
+    f.evaluate_into(out, out, y);
+    assert(out == evaluate_by_monomials(f, u, y));
+}
 
-    int evaluate(int x, int modulo) const {
-        int value = 0;
-        int power = 1;
+// Horner evaluation at scalars, one polynomial at many points and many at one, and of Pq at
+// ring elements against the monomial sums
+template <class Params>
+void test_horner_evaluation() {
+    using Ring = typename Params::Ring;
+    using Field = typename Ring::Field;
+    RandomPolynomialGenerator rng(27);
 
-        for (int c : coeffs) {
-            value = FieldArithmetic::add(value, FieldArithmetic::mul(c, power, modulo), modulo);
-            power = FieldArithmetic::mul(power, x, modulo);
+    const Ring f = rng.uniform<Ring>();
+    const std::size_t count = Ring::EVALUATION_BLOCK + 45;
+    std::vector<Fq> points(count), values(count);
+    for (std::size_t k = 0; k < count; ++k) {
+        points[k] = rng.uniform<Ring>()[0];
+        Fq power = 1, sum = 0;
+        for (std::size_t i = 0; i < Params::N; ++i) {
+            sum = Field::add(sum, Field::mul(f[i], power));
+            power = Field::mul(power, points[k]);
         }
+        assert(f.evaluate(points[k]) == sum);
+    }
+    f.evaluate_many(points, values);
+    for (std::size_t k = 0; k < count; ++k) {
+        assert(values[k] == f.evaluate(points[k]));
+    }
 
-        return value;
+    std::vector<Ring> polys(count);
+    for (Ring& p : polys) {
+        p = rng.uniform<Ring>();
+    }
+    Ring::evaluate_many(polys, points[0], values);
+    for (std::size_t k = 0; k < count; ++k) {
+        assert(values[k] == polys[k].evaluate(points[0]));
     }
-};
 
-// Random Polynomial Generator
-class RandomPolynomialGenerator {
-private:
-    std::mt19937 generator;
+    check_horner<Ring, 1>(rng, Params::noise_bound);
+    check_horner<Ring, 2>(rng, Params::noise_bound);
+    check_horner<Ring, 3>(rng, Params::noise_bound);
+    std::cout << "Horner evaluation test passed for N = " << Params::N << ", " << count << " points" << std::endl;
+}
 
-public:
-    explicit RandomPolynomialGenerator() : generator(std::random_device{}()) {}
+// lazy(v0) * v1 + lazy(v1) * v2 + ... + lazy(vK) * vK+1, every inner element in two products
+template <std::size_t K, class Ring>
+auto product_chain(const std::vector<Ring>& v) {
+    if constexpr (K == 0) {
+        return lazy(v[0]) * v[1];
+    } else {
+        return product_chain<K - 1>(v) + lazy(v[K]) * v[K + 1];
+    }
+}
+
+// Fused ring expressions against the eager operators: shared operands, scalars, products of
+// sums, an output that is also an operand, and more products than one accumulation takes
+template <class Params>
+void test_ring_expressions() {
+    using Ring = typename Params::Ring;
+    RandomPolynomialGenerator rng(30);
+    const Ring a = rng.uniform<Ring>(), b = rng.uniform<Ring>(), c = rng.uniform<Ring>(), d = rng.uniform<Ring>();
+    const Ring e = rng.generate<Ring>(Params::noise_bound);
 
-    Polynomial generate(int degree, int max_coeff) {
-        std::uniform_int_distribution<> dist(0, max_coeff);
-        std::vector<int> coeffs(degree + 1);
+    const Ring fused = lazy(a) * b + lazy(c) * d;
+    assert(fused == a * b + c * d);
+    Ring e4 = e;
+    e4 *= 4;
+    const Ring scaled = lazy(a) * b - 4 * lazy(e) + c;
+    assert(scaled == a * b - e4 + c);
+    Ring c3 = c;
+    c3 *= 3;
+    const Ring negated = -(lazy(a) * b) + lazy(a) * c * 3;
+    assert(negated == a * c3 - a * b);
+    const Ring nested = (lazy(a) + b) * (lazy(c) - d);
+    assert(nested == (a + b) * (c - d));
 
-        std::generate(coeffs.begin(), coeffs.end(), [&]() { return dist(generator); });
-        return Polynomial(coeffs);
+    Ring x = a;
+    compute_into(x, lazy(x) * b + x);
+    assert(x == a * b + a);
+    x = e;
+    x = lazy(b) * x - 2 * lazy(x);
+    assert(x == b * e - e - e);
+
+    constexpr std::size_t products = NTT_ACCUMULATION + 1;
+    std::vector<Ring> v(products + 1);
+    for (Ring& r : v) {
+        r = rng.uniform<Ring>();
     }
-};
+    Ring expected;
+    for (std::size_t k = 0; k < products; ++k) {
+        expected += v[k] * v[k + 1];
+    }
+    const Ring chain = product_chain<products - 1>(v);
+    assert(chain == expected);
 
-// Encryption/Decryption Keys
-class GiophantusKey {
-public:
-    Polynomial ux, uy, X;
+    // a * b + a * c: a transformed once, one inverse
+    if constexpr (INSTRUMENT && !Ring::Multiplier::coefficient_domain) {
+        instrument::reset();
+        const Ring shared = lazy(a) * b + lazy(a) * c;
+        assert(instrument::snapshot()[instrument::Counter::Transforms] == 4);
+        assert(shared == a * b + a * c);
+    }
+    std::cout << "Ring expression test passed for N = " << Params::N << ", " << products << " fused products" << std::endl;
+}
+
+template <class Params>
+void test_encryption() {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+
+    auto key = GiophantusKeyGen::generate<Params>();
+    const EncryptionContext<Params> context(key.X);
+
+    RandomPolynomialGenerator message_rng;
+    std::vector<Ring> messages(2 * EncryptionContext<Params>::GROUP + 1);
+    for (Ring& m : messages) {
+        m = message_rng.generate<Ring>(Params::noise_bound);
+    }
 
-    GiophantusKey(const Polynomial& ux, const Polynomial& uy, const Polynomial& X)
-        : ux(ux), uy(uy), X(X) {}
+    std::vector<Ciphertext> batch(messages.size());
+    RandomPolynomialGenerator batch_rng(7);
+    context.encrypt_many(messages, batch, batch_rng);
+
+    RandomPolynomialGenerator single_rng(7);
+    for (std::size_t k = 0; k < messages.size(); ++k) {
+        assert(GiophantusCipher::encrypt<Params>(key.X, messages[k], single_rng) == batch[k]);
+        assert(GiophantusCipher::decrypt(key, batch[k]) == messages[k]);
+    }
+    std::cout << "Encryption test passed for N=" << Params::N << ", " << messages.size() << " messages" << std::endl;
+}
+
+// The cached monomial tables give the same c(ux, uy) mod L as direct substitution, also for
+// ciphertexts that were not produced by encryption
+template <class Params>
+void test_decryption_context() {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+
+    RandomPolynomialGenerator rng(11);
+    const auto key = GiophantusKeyGen::generate<Params>(rng);
+    const DecryptionContext<Params> context(key);
+    for (int trial = 0; trial < 4; ++trial) {
+        const auto c = rng.generate_terms<Ciphertext>(Params::Q);
+        assert(context.decrypt(c) == GiophantusCipher::decrypt(key, c));
+    }
+
+    const Ring m = rng.generate<Ring>(Params::noise_bound);
+    const Ciphertext c = GiophantusCipher::encrypt<Params>(key.X, m, rng);
+    Ring out;
+    context.decrypt_into(out, c);
+    assert(out == m || Params::Q < (1u << 30));
+    std::cout << "Decryption context test passed for N=" << Params::N << std::endl;
+}
+
+// Packed encodings round-trip, and views over the packed bytes see the same coefficients, also
+// from a buffer that is not aligned for in-place access
+template <class Params>
+void test_codec() {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+    using Layout = ByteLayout<Params>;
+
+    RandomPolynomialGenerator rng(13);
+    const auto key = GiophantusKeyGen::generate<Params>(rng);
+    std::vector<std::uint8_t> sk(Layout::secret_key);
+    ByteCodec::encode(sk.data(), key);
+    GiophantusKey<Params> decoded;
+    assert(ByteCodec::decode(decoded, sk.data()));
+    assert(decoded.ux == key.ux && decoded.uy == key.uy && decoded.X == key.X);
+
+    const SecretKeyView<Params> sk_view(sk.data());
+    for (std::size_t i = 0; i < Params::N; ++i) {
+        assert(sk_view.ux()[i] == key.ux[i] && sk_view.uy()[i] == key.uy[i]);
+        assert(sk_view.public_key()(1, 0)[i] == key.X(1, 0)[i]);
+    }
+
+    const Ring m = rng.generate<Ring>(Params::noise_bound);
+    const Ciphertext c = GiophantusCipher::encrypt<Params>(key.X, m, rng);
+    std::vector<std::uint8_t> buffer(Layout::ciphertext + 1);
+    for (std::size_t offset : {0, 1}) {
+        ByteCodec::encode(buffer.data() + offset, c);
+        const CiphertextView<Params> view(buffer.data() + offset);
+        assert(view.valid());
+        for (std::size_t k = 0; k < Ciphertext::terms; ++k) {
+            Ring term;
+            view[k].copy_to(term);
+            assert(term == c[k]);
+        }
+        Ring out;
+        DecryptionContext<Params>(key).decrypt_into(out, view);
+        assert(out == GiophantusCipher::decrypt(key, c));
+    }
+
+    // A word of q or more is not a valid coefficient
+    buffer[Layout::rq + 3] = 0xff;
+    buffer[Layout::rq + 2] = 0xff;
+    buffer[Layout::rq + 1] = 0xff;
+    buffer[Layout::rq] = 0xff;
+    assert(!CiphertextView<Params>(buffer.data()).valid());
+    Ciphertext rejected;
+    assert(!ByteCodec::decode(rejected, buffer.data()));
+
+    std::cout << "Codec test passed for N=" << Params::N << ": " << Layout::secret_key << " byte secret key, "
+              << Layout::ciphertext << " byte ciphertext" << std::endl;
+}
+
+// Keys written to a store come back under their ids, with the mapped transforms and without
+template <class Params>
+void test_key_store() {
+    using Ring = typename Params::Ring;
+
+    RandomPolynomialGenerator rng(17);
+    std::vector<GiophantusKey<Params>> keys;
+    const std::vector<std::uint64_t> ids = {42, 7, 1000000007, 3};
+    for (std::size_t k = 0; k < ids.size(); ++k) {
+        keys.push_back(GiophantusKeyGen::generate<Params>(rng));
+    }
+    const std::string path = (std::filesystem::temp_directory_path() / "giophantus_key_store_test.bin").string();
+
+    for (bool transforms : {false, true}) {
+        assert(KeyStore<Params>::write(path.c_str(), ids, keys, transforms));
+        KeyStore<Params> store;
+        assert(store.open(path.c_str()));
+        assert(store.size() == ids.size() && store.has_transforms() == transforms);
+        assert(store.id(0) == 3 && store.id(3) == 1000000007);
+        assert(store.get(8) == nullptr);
+
+        for (std::size_t k = 0; k < ids.size(); ++k) {
+            const auto* prepared = store.get(ids[k]);
+            assert(prepared != nullptr && prepared == store.get(ids[k]));
+            assert(prepared->key.X == keys[k].X && prepared->key.ux == keys[k].ux);
+            const Ring m = rng.generate<Ring>(Params::noise_bound);
+            assert(prepared->decryption.decrypt(prepared->encryption.encrypt(m, rng)) == m);
+        }
+        // Another parameter set does not open the file
+        assert(!KeyStore<IEC868>().open(path.c_str()));
+    }
+    // Nor does a header moving the records off their aligned offset
+    {
+        std::FILE* f = std::fopen(path.c_str(), "r+b");
+        const std::uint64_t records = KEY_STORE_RECORDS_OFFSET + 4;
+        assert(f != nullptr && std::fseek(f, offsetof(KeyStoreHeader, records), SEEK_SET) == 0);
+        assert(std::fwrite(&records, sizeof(records), 1, f) == 1 && std::fclose(f) == 0);
+        assert(!KeyStore<Params>().open(path.c_str()));
+    }
+    const std::uint64_t duplicate[] = {1, 1};
+    assert(!KeyStore<Params>::write(path.c_str(), duplicate, std::span(keys).first(2)));
+    std::filesystem::remove(path);
+    std::cout << "Key store test passed for N=" << Params::N << ", " << ids.size() << " keys" << std::endl;
+}
+
+// Sets found at runtime by name or key size; an added schoolbook IEC602 agrees with the NTT one
+void test_param_registry() {
+    const ParameterSetInfo* iec868 = ParamRegistry::find("IEC868");
+    assert(iec868 != nullptr && iec868->n == IEC868::N && iec868->q == IEC868::Q && iec868->ntt);
+    assert(ParamRegistry::find_by_public_key(GIOPHANTUS_IEC1134_PUBLICKEYBYTES) == ParamRegistry::find("IEC1134"));
+    assert(ParamRegistry::find_by_secret_key(GIOPHANTUS_IEC602_SECRETKEYBYTES) == ParamRegistry::find("IEC602"));
+    assert(ParamRegistry::find("IEC999") == nullptr && ParamRegistry::find_by_public_key(1) == nullptr);
+
+    using Schoolbook602 = ParamSet<1201, 0x7fffffffu, 4, 16, MulBackend::Schoolbook>;
+    assert(ParamRegistry::add(describe_parameter_set<Schoolbook602>("IEC602/schoolbook")));
+    assert(!ParamRegistry::add(describe_parameter_set<Schoolbook602>("IEC602")));
+    ParamRegistry::prepare_all();
+
+    const ParameterSetInfo* ntt = ParamRegistry::find("IEC602");
+    const ParameterSetInfo* schoolbook = ParamRegistry::find("IEC602/schoolbook");
+    assert(schoolbook != nullptr && !schoolbook->ntt && schoolbook->ciphertext_bytes == ntt->ciphertext_bytes);
+    std::vector<std::uint8_t> pk(ntt->public_key_bytes), sk(ntt->secret_key_bytes), msg(ntt->message_bytes, 0x5a);
+    std::vector<std::uint8_t> c0(ntt->ciphertext_bytes), c1(ntt->ciphertext_bytes), recovered(ntt->message_bytes);
+    RandomPolynomialGenerator rng(23);
+    ntt->keypair(pk.data(), sk.data(), rng);
+    RandomPolynomialGenerator padding0(29), padding1(29);
+    assert(ntt->encrypt(c0.data(), msg.data(), pk.data(), padding0));
+    assert(schoolbook->encrypt(c1.data(), msg.data(), pk.data(), padding1));
+    assert(c0 == c1);
+    assert(schoolbook->decrypt(recovered.data(), c0.data(), sk.data()) && recovered == msg);
+
+    std::cout << "Parameter registry test passed with " << ParamRegistry::all().size() << " sets" << std::endl;
+}
+
+// Counters, phases and trace markers of one keygen, encryption and decryption; all zero unless
+// built with GIOPHANTUS_INSTRUMENT
+template <class Params>
+void test_instrumentation() {
+    using Ring = typename Params::Ring;
+    static std::atomic<int> phases{0}, open_traces{0};
+    instrument::set_phase_callback([](instrument::Phase, std::uint64_t, void*) { phases.fetch_add(1); }, nullptr);
+    instrument::set_trace_hooks([](const char*) { open_traces.fetch_add(1); }, [](const char*) { open_traces.fetch_sub(1); });
+    instrument::reset();
+
+    RandomPolynomialGenerator rng(31);
+    const GiophantusKey<Params> key = GiophantusKeyGen::generate<Params>(rng);
+    const Ring m = rng.generate<Ring>(Params::noise_bound);
+    const EncryptionContext<Params> encryption(key.X);
+    const DecryptionContext<Params> decryption(key);
+    // A worker's counts survive the thread
+    Ring recovered;
+    std::thread worker([&] { recovered = decryption.decrypt(encryption.encrypt(m, RandomPolynomialGenerator::local())); });
+    worker.join();
+    assert(recovered == m);
+
+    const instrument::Snapshot s = instrument::snapshot();
+    const std::string text = instrument::prometheus_text();
+    instrument::set_phase_callback(nullptr, nullptr);
+    instrument::set_trace_hooks(nullptr, nullptr);
+    assert(open_traces.load() == 0);
+    if constexpr (INSTRUMENT) {
+        assert(s.phase_count[static_cast<std::size_t>(instrument::Phase::KeyGen)] == 1);
+        assert(s.phase_count[static_cast<std::size_t>(instrument::Phase::Encrypt)] == 1);
+        assert(s.phase_count[static_cast<std::size_t>(instrument::Phase::Decrypt)] == 1);
+        assert(phases.load() == 3);
+        assert(s[instrument::Counter::RingMultiplies] > 0 && s[instrument::Counter::ArenaAllocations] > 0);
+        assert(s[instrument::Counter::SamplesDrawn] >= (2 + Params::PublicPoly::terms) * Params::N);
+        assert(text.find("giophantus_phase_seconds_count{phase=\"keygen\"} 1\n") != std::string::npos);
+    } else {
+        assert(phases.load() == 0 && s[instrument::Counter::RingMultiplies] == 0);
+        assert(text.find("giophantus_ring_multiplies_total 0\n") != std::string::npos);
+    }
+    std::cout << "Instrumentation test passed (" << (INSTRUMENT ? "enabled" : "compiled out") << "), "
+              << s[instrument::Counter::RingMultiplies] << " ring products" << std::endl;
+}
+
+void test_thread_pool() {
+    ThreadPool pool(4);
+
+    std::vector<std::atomic<int>> hits(1000);
+    pool.parallel_for(hits.size(), [&](std::size_t k) { hits[k].fetch_add(1); });
+    assert(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& h) { return h.load() == 1; }));
+
+    // Nested regions: workers waiting on an inner loop keep executing queued tasks
+    std::atomic<std::size_t> total{0};
+    pool.parallel_for(16, [&](std::size_t) {
+        pool.parallel_for(64, [&](std::size_t k) { total.fetch_add(k); });
+    });
+    assert(total.load() == 16 * (63 * 64 / 2));
+
+    std::cout << "Thread pool test passed with " << pool.size() << " workers" << std::endl;
+}
+
+void test_mpmc_ring() {
+    constexpr int PRODUCERS = 4, CONSUMERS = 4, ITEMS = 20000;
+    MpmcRing<std::uint64_t> ring(100);
+    assert(ring.capacity() == 128);
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<int> popped{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < ITEMS; ++i) {
+                std::uint64_t value = static_cast<std::uint64_t>(p) * ITEMS + i + 1;
+                while (!ring.try_push(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < CONSUMERS; ++c) {
+        threads.emplace_back([&] {
+            std::uint64_t value;
+            while (popped.load() < PRODUCERS * ITEMS) {
+                if (ring.try_pop(value)) {
+                    sum.fetch_add(value);
+                    popped.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    const std::uint64_t total = std::uint64_t{PRODUCERS} * ITEMS;
+    assert(sum.load() == total * (total + 1) / 2);
+    std::uint64_t value;
+    assert(!ring.try_pop(value));
+    std::cout << "MPMC ring test passed (" << PRODUCERS << " producers, " << CONSUMERS << " consumers)" << std::endl;
+}
+
+template <class Params>
+void test_key_pool() {
+    using Key = GiophantusKey<Params>;
+    KeyPool<Params> pool({.capacity = 6, .low_watermark = 3, .threads = 2});
+    const auto wait_for_depth = [&](std::size_t depth) {
+        for (int i = 0; i < 10000 && pool.depth() < depth; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(pool.depth() == depth);
+    };
+    wait_for_depth(6);
+    // Full: the generators sleep instead of overfilling
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(pool.stats().generated == 6 && pool.stats().refills == 0);
+
+    // Above the watermark nothing is refilled
+    std::vector<Key> keys;
+    for (int i = 0; i < 3; ++i) {
+        keys.push_back(pool.take());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(pool.depth() == 3 && pool.stats().generated == 6);
+
+    // Crossing it refills to capacity
+    keys.push_back(pool.take());
+    wait_for_depth(6);
+    const KeyPoolStats s = pool.stats();
+    assert(s.served == 4 && s.misses == 0 && s.refills == 1 && s.generated == 10);
+
+    // An empty pool still serves, inline
+    KeyPool<Params> drained({.capacity = 1, .low_watermark = 1, .threads = 1});
+    for (int i = 0; i < 4; ++i) {
+        keys.push_back(drained.take());
+    }
+    assert(drained.stats().served + drained.stats().misses == 4);
+
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        assert(GiophantusKeyGen::validate(keys[i]) == KeyStatus::Valid);
+        for (std::size_t j = 0; j < i; ++j) {
+            assert(keys[i].X != keys[j].X);
+        }
+    }
+    std::cout << "Key pool test passed: " << s.generated << " generated, " << s.served << " served, " << s.refills << " refill" << std::endl;
+}
+
+// Coroutine started eagerly and never awaited, for the async tests
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::abort(); }
+    };
 };
 
-class GiophantusKeyGen {
+// Single-threaded event loop: executors post handles, run() resumes them on the calling thread
+class EventLoop {
 public:
-    static GiophantusKey generate(const GiophantusParams& params) {
-        RandomPolynomialGenerator rng;
-        Polynomial ux = rng.generate(params.degree, params.noise_bound);
-        Polynomial uy = rng.generate(params.degree, params.noise_bound);
-        Polynomial X = rng.generate(params.degree, params.modulo - 1); // Placeholder for irreducibility check
+    struct Executor {
+        EventLoop* loop;
+        void operator()(std::coroutine_handle<> handle) const {
+            loop->post(handle);
+        }
+    };
+
+    Executor executor() {
+        return {this};
+    }
+
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(handle);
+        }
+        ready.notify_one();
+    }
 
-        return GiophantusKey(ux, uy, X);
+    // Until done() holds after a resumption
+    template <class Done>
+    void run(Done done) {
+        while (!done()) {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&] { return !queue.empty(); });
+            const std::coroutine_handle<> handle = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            handle.resume();
+        }
     }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::coroutine_handle<>> queue;
 };
 
-// Test Functions
-void test_keygen(const GiophantusParams& params) {
-    auto key = GiophantusKeyGen::generate(params);
-    assert(key.ux.degree() <= params.degree);
-    assert(key.uy.degree() <= params.degree);
-    std::cout << "Key generation test passed for params: modulo=" << params.modulo << ", degree=" << params.degree << std::endl;
+// Requests awaited together on a busy pool go out as one batch and resume on the loop thread
+template <class Params>
+void test_async_cipher() {
+    using Ring = typename Params::Ring;
+    constexpr std::size_t COUNT = 2 * EncryptionContext<Params>::GROUP + 3;
+    const GiophantusKey<Params> key = GiophantusKeyGen::generate<Params>();
+    ThreadPool pool(1);
+    AsyncEncryptor<Params> encryptor(key.X, pool);
+    AsyncDecryptor<Params> decryptor(key, pool);
+    EventLoop loop;
+    const std::thread::id loop_thread = std::this_thread::get_id();
+
+    RandomPolynomialGenerator rng(26);
+    std::vector<Ring> messages(COUNT), decrypted(COUNT);
+    for (Ring& m : messages) {
+        m = rng.generate<Ring>(Params::noise_bound);
+    }
+    std::size_t finished = 0;
+    const auto round_trip = [&](std::size_t k) -> DetachedTask {
+        const typename Params::Ciphertext c = co_await async_encrypt(encryptor, messages[k], loop.executor());
+        assert(std::this_thread::get_id() == loop_thread);
+        decrypted[k] = co_await async_decrypt(decryptor, c, loop.executor());
+        assert(std::this_thread::get_id() == loop_thread);
+        ++finished;
+    };
+
+    // Hold the only worker until every encryption is queued
+    std::atomic<bool> release{false};
+    pool.submit([&] {
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    for (std::size_t k = 0; k < COUNT; ++k) {
+        round_trip(k);
+    }
+    release.store(true);
+    loop.run([&] { return finished == COUNT; });
+
+    assert(decrypted == messages);
+    const AsyncStats e = encryptor.stats(), d = decryptor.stats();
+    assert(e.requests == COUNT && e.batches == 1);
+    assert(d.requests == COUNT && d.batches >= 1 && d.batches <= COUNT);
+
+    // Without an executor the coroutine continues on the worker
+    std::atomic<bool> done{false};
+    const auto on_worker = [&]() -> DetachedTask {
+        const Ring m = co_await async_decrypt(decryptor, co_await async_encrypt(encryptor, messages[0]));
+        assert(m == messages[0] && std::this_thread::get_id() != loop_thread);
+        done.store(true);
+    };
+    on_worker();
+    while (!done.load()) {
+        std::this_thread::yield();
+    }
+    std::cout << "Async cipher test passed for N = " << Params::N << ": " << COUNT << " requests in " << e.batches << " encryption and "
+              << d.batches << " decryption batches" << std::endl;
+}
+
+template <class Params>
+void test_parallel_batches() {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+    ThreadPool pool(4);
+
+    auto keys = GiophantusKeyGen::generate_many<Params>(4, pool);
+    for (const auto& key : keys) {
+        assert(key.X.evaluate(key.ux.ring(), key.uy.ring()) == Ring{});
+    }
+
+    const auto& key = keys.front();
+    const EncryptionContext<Params> context(key.X);
+    std::vector<Ring> messages(3 * EncryptionContext<Params>::GROUP + 2);
+    for (Ring& m : messages) {
+        m = RandomPolynomialGenerator::local().generate<Ring>(Params::noise_bound);
+    }
+    std::vector<Ciphertext> ciphertexts(messages.size());
+    context.encrypt_many(messages, ciphertexts, pool);
+
+    std::vector<Ring> decrypted(messages.size());
+    GiophantusCipher::decrypt_many<Params>(key, ciphertexts, decrypted, pool);
+    assert(decrypted == messages);
+
+    // Intra-operation split of a Pq product over its output terms
+    using P1 = typename Params::PublicPoly;
+    const P1 a = RandomPolynomialGenerator::local().generate_terms<P1>(Params::Q);
+    const P1 b = RandomPolynomialGenerator::local().generate_terms<P1>(Params::Q);
+    assert(multiply(a, b, &pool) == multiply(a, b, nullptr));
+
+    std::cout << "Parallel batch test passed for N=" << Params::N << ", " << messages.size() << " messages" << std::endl;
+}
+
+template <class Params>
+void test_gpu_encryption() {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+    using Gpu = GpuEncryptionContext<Params>;
+
+    // Every public key term meets every blinding term exactly once
+    const GpuLayout layout = Gpu::layout();
+    assert(layout.products.size() == Params::PublicPoly::terms * Gpu::Blinding::terms);
+    assert(layout.transform_size == ntt_transform_size(Params::N));
+
+    const auto key = GiophantusKeyGen::generate<Params>();
+    // A small batch spreads the messages over both staging slots several times
+    Gpu gpu(key.X, 3);
+    const EncryptionContext<Params> cpu(key.X);
+    std::vector<Ring> messages(8);
+    for (Ring& m : messages) {
+        m = RandomPolynomialGenerator::local().generate<Ring>(Params::noise_bound);
+    }
+
+    std::vector<Ciphertext> on_gpu(messages.size()), on_cpu(messages.size());
+    RandomPolynomialGenerator gpu_rng(37), cpu_rng(37);
+    gpu.encrypt_many(messages, on_gpu, gpu_rng);
+    cpu.encrypt_many(messages, on_cpu, cpu_rng);
+    assert(on_gpu == on_cpu);
+    for (std::size_t m = 0; m < messages.size(); ++m) {
+        assert(GiophantusCipher::decrypt<Params>(key, on_gpu[m]) == messages[m]);
+    }
+
+    std::cout << "GPU encryption test passed for N=" << Params::N << (gpu.on_device() ? " on the device" : " on the host fallback")
+              << std::endl;
+}
+
+// Heap allocation counter for the zero-allocation test: every plain operator new passes here
+std::atomic<std::size_t> heap_allocations{0};
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+template <class Params>
+void test_scratch_arena() {
+    using Ring = typename Params::Ring;
+    using Ciphertext = typename Params::Ciphertext;
+
+    auto key = GiophantusKeyGen::generate<Params>();
+    const EncryptionContext<Params> context(key.X);
+    RandomPolynomialGenerator rng(11);
+    const Ring a = rng.uniform<Ring>();
+    const Ring b = rng.uniform<Ring>();
+    Ring message = rng.generate<Ring>(Params::noise_bound);
+    Ciphertext c;
+    Ring decrypted, out, acc;
+
+    // Output-parameter forms agree with the operators
+    Ring::add_into(out, a, b);
+    assert(out == a + b);
+    Ring::sub_into(out, a, b);
+    assert(out == a - b);
+    Ring::mul_into(out, a, b);
+    assert(out == a * b);
+    acc = b;
+    Ring::mul_add(acc, a, b);
+    assert(acc == b + a * b);
+
+    auto round_trip = [&] {
+        context.encrypt_many(std::span<const Ring>(&message, 1), std::span<Ciphertext>(&c, 1), rng);
+        GiophantusCipher::decrypt_into(decrypted, key, c);
+        Ring::mul_add(acc, a, b);
+    };
+
+    // The first pass sizes the arena; later ones must not touch the heap at all
+    round_trip();
+    const std::size_t heap_before = heap_allocations.load();
+    const std::size_t blocks_before = ScratchArena::total_allocations();
+    for (int i = 0; i < 8; ++i) {
+        round_trip();
+    }
+    assert(heap_allocations.load() == heap_before);
+    assert(ScratchArena::total_allocations() == blocks_before);
+    // Toy moduli are too small for L * e(ux, uy) + m to survive decryption
+    if constexpr (Params::Q > (1u << 30)) {
+        assert(decrypted == message);
+    }
+
+    std::cout << "Scratch arena test passed for N=" << Params::N << ": no allocations in steady state" << std::endl;
+}
+
+std::vector<std::uint8_t> from_hex(const char* hex) {
+    std::vector<std::uint8_t> bytes;
+    for (; hex[0] != '\0' && hex[1] != '\0'; hex += 2) {
+        auto nibble = [](char c) { return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10; };
+        bytes.push_back(static_cast<std::uint8_t>(nibble(hex[0]) << 4 | nibble(hex[1])));
+    }
+    return bytes;
 }
 
-void test_polynomial_operations(const GiophantusParams& params) {
+void test_random_sources() {
+    // FIPS 197 appendix C.3
+    std::uint8_t key[32], plain[16], cipher[16], portable[16];
+    for (int i = 0; i < 32; ++i) {
+        key[i] = static_cast<std::uint8_t>(i);
+    }
+    for (int i = 0; i < 16; ++i) {
+        plain[i] = static_cast<std::uint8_t>(0x11 * i);
+    }
+    const csprng::Aes256 aes(key);
+    aes.encrypt_block(plain, cipher);
+    aes.encrypt_blocks_portable(plain, portable, 1);
+    assert(std::equal(cipher, cipher + 16, from_hex("8ea2b7ca516745bfeafc49904b496089").begin()));
+    assert(std::equal(cipher, cipher + 16, portable));
+
+    // Batched counter mode agrees with the portable path across the eight-block stride
+    std::uint8_t counter[16] = {}, counter2[16] = {};
+    std::vector<std::uint8_t> stream(19 * 16), expected(19 * 16);
+    counter[15] = counter2[15] = 0xfe;
+    aes.ctr_blocks(counter, stream.data(), 19);
+    for (std::size_t b = 0; b < 19; ++b) {
+        for (int j = 15; j >= 0 && ++counter2[j] == 0; --j) {
+        }
+        aes.encrypt_blocks_portable(counter2, expected.data() + 16 * b, 1);
+    }
+    assert(stream == expected && std::equal(counter, counter + 16, counter2));
+
+    // NIST KAT request file: entropy 0..47, then the seed and message of count = 0
+    std::uint8_t entropy[48];
+    for (int i = 0; i < 48; ++i) {
+        entropy[i] = static_cast<std::uint8_t>(i);
+    }
+    csprng::CtrDrbg drbg(entropy);
+    std::uint8_t seed[48], message[16];
+    drbg.generate(seed, sizeof(seed));
+    assert(std::equal(seed, seed + 48, from_hex("061550234D158C5EC95595FE04EF7A25767F2E24CC2BC479D09D86DC9ABCFDE7056A8C266F9EF97ED08541DBD2E1FFA1").begin()));
+    drbg.generate(message, sizeof(message));
+    assert(std::equal(message, message + 16, from_hex("D81C4D8D734FCBFBEADE3D3F8A039FAA").begin()));
+
+    // SHAKE256 of the empty string; squeezing in pieces continues the same stream
+    std::uint8_t digest[300], pieces[300];
+    csprng::shake256(digest, sizeof(digest), nullptr, 0);
+    assert(std::equal(digest, digest + 32, from_hex("46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762f").begin()));
+    csprng::Shake256 expander(nullptr, 0);
+    expander.squeeze(pieces, 7);
+    expander.squeeze(pieces + 7, 200);
+    expander.squeeze(pieces + 207, 93);
+    assert(std::equal(digest, digest + 300, pieces));
+
+    using Ring = IEC602::Ring;
+    // Reference sampling from a DRBG draws each coefficient with its own randombytes() call
+    RandomPolynomialGenerator reference(csprng::CtrDrbg(entropy), Sampling::Reference);
+    csprng::CtrDrbg manual(entropy);
+    const Ring small = reference.generate<Ring>(IEC602::noise_bound);
+    const Ring wide = reference.uniform<Ring>();
+    for (std::size_t i = 0; i < Ring::dimension; ++i) {
+        std::uint8_t b;
+        manual.generate(&b, 1);
+        assert(small[i] == b % IEC602::noise_bound);
+    }
+    for (std::size_t i = 0; i < Ring::dimension; ++i) {
+        std::uint8_t w[4];
+        manual.generate(w, 4);
+        const std::uint32_t x = w[0] | w[1] << 8 | w[2] << 16 | static_cast<std::uint32_t>(w[3]) << 24;
+        assert(wide[i] == x % IEC602::Q);
+    }
+
+    // Uniform sampling: in range, reproducible from a seed, rejection for non-power-of-two bounds
+    RandomPolynomialGenerator first(3), second(3);
+    const Ring a = first.generate<Ring>(5);
+    assert(a == second.generate<Ring>(5));
+    assert(std::all_of(a.begin(), a.end(), [](Fq c) { return c < 5; }));
+    std::array<std::size_t, 5> histogram{};
+    for (Fq c : a) {
+        ++histogram[c];
+    }
+    assert(std::all_of(histogram.begin(), histogram.end(), [](std::size_t h) { return h > 150 && h < 330; }));
+    const Ring b = first.uniform<Ring>();
+    assert(std::all_of(b.begin(), b.end(), [](Fq c) { return c < IEC602::Q; }));
+
+    std::cout << "Random sources test passed (AES-NI " << (csprng::aes_ni_available() ? "on" : "off") << ")" << std::endl;
+}
+
+void test_aes_gcm() {
+    // McGrew and Viega, GCM test cases 13, 14 and 16
+    const std::uint8_t zero[32] = {};
+    std::uint8_t out[64], tag[16];
+    const csprng::Aes256Gcm null_key(zero);
+    null_key.seal(zero, nullptr, 0, nullptr, nullptr, 0, tag);
+    assert(std::equal(tag, tag + 16, from_hex("530f8afbc74536b9a963b4f1c4cb738b").begin()));
+    null_key.seal(zero, nullptr, 0, zero, out, 16, tag);
+    assert(std::equal(out, out + 16, from_hex("cea7403d4d606b6e074ec5d3baf39d18").begin()));
+    assert(std::equal(tag, tag + 16, from_hex("d0d1c8a799996bf0265b98b5d48ab919").begin()));
+
+    const auto key = from_hex("feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308");
+    const auto nonce = from_hex("cafebabefacedbaddecaf888");
+    const auto plain = from_hex("d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+                                "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+    const auto aad = from_hex("feedfacedeadbeeffeedfacedeadbeefabaddad2");
+    const csprng::Aes256Gcm gcm(key.data());
+    gcm.seal(nonce.data(), aad.data(), aad.size(), plain.data(), out, plain.size(), tag);
+    assert(std::equal(out, out + plain.size(),
+                      from_hex("522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+                               "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662").begin()));
+    assert(std::equal(tag, tag + 16, from_hex("76fc6ece0f4e1768cddf8853bb2d551b").begin()));
+
+    std::uint8_t opened[64];
+    assert(gcm.open(nonce.data(), aad.data(), aad.size(), out, opened, plain.size(), tag));
+    assert(std::equal(plain.begin(), plain.end(), opened));
+    out[5] ^= 1;
+    assert(!gcm.open(nonce.data(), aad.data(), aad.size(), out, opened, plain.size(), tag));
+
+    // The aggregated PCLMULQDQ GHASH agrees with the bitwise one around its four-block stride
+    std::vector<std::uint8_t> data(1000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::uint8_t>(i * 7 + 3);
+    }
+    for (std::size_t length : {1, 16, 63, 64, 65, 1000}) {
+        std::uint8_t portable[16];
+        gcm.seal(nonce.data(), aad.data(), aad.size(), data.data(), data.data(), length, tag);
+        gcm.tag_portable(nonce.data(), aad.data(), aad.size(), data.data(), length, portable);
+        assert(std::equal(tag, tag + 16, portable));
+    }
+
+    std::cout << "AES-GCM test passed (PCLMULQDQ " << (csprng::clmul_available() ? "on" : "off") << ")" << std::endl;
+}
+
+template <class Params>
+void test_hybrid_stream() {
+    using Pke = GiophantusPke<Params>;
+    using Stream = HybridStream<Params>;
+    RandomPolynomialGenerator rng(41);
+    std::vector<std::uint8_t> pk(Pke::PUBLIC_KEY_BYTES), sk(Pke::SECRET_KEY_BYTES);
+    Pke::keypair(pk.data(), sk.data(), rng);
+
+    // In-memory reader and writer
+    auto reader = [](const std::vector<std::uint8_t>& bytes, std::size_t& position) -> StreamReader {
+        return [&bytes, &position](std::uint8_t* out, std::size_t capacity, std::size_t& length) {
+            length = std::min(capacity, bytes.size() - position);
+            std::copy(bytes.begin() + position, bytes.begin() + position + length, out);
+            position += length;
+            return true;
+        };
+    };
+    auto writer = [](std::vector<std::uint8_t>& bytes) -> StreamWriter {
+        return [&bytes](const std::uint8_t* data, std::size_t length) {
+            bytes.insert(bytes.end(), data, data + length);
+            return true;
+        };
+    };
+
+    constexpr std::size_t CHUNK = 1000;
+    for (std::size_t size : {0, 1, 999, 1000, 1001, 3 * 1000 + 17}) {
+        std::vector<std::uint8_t> plain(size), sealed, opened;
+        rng.random_bytes(plain.data(), plain.size());
+        std::size_t position = 0;
+        assert(Stream::encrypt(pk.data(), reader(plain, position), writer(sealed), rng, CHUNK) == StreamStatus::Ok);
+        // Header, then every chunk (and the final short one) with its tag
+        assert(sealed.size() == Stream::HEADER_BYTES + size + (size / CHUNK + 1) * csprng::Aes256Gcm::TAG_BYTES);
+        position = 0;
+        assert(Stream::decrypt(sk.data(), reader(sealed, position), writer(opened)) == StreamStatus::Ok);
+        assert(opened == plain);
+    }
+
+    std::vector<std::uint8_t> plain(2500), sealed;
+    rng.random_bytes(plain.data(), plain.size());
+    std::size_t position = 0;
+    assert(Stream::encrypt(pk.data(), reader(plain, position), writer(sealed), rng, CHUNK) == StreamStatus::Ok);
+    auto open = [&](const std::vector<std::uint8_t>& bytes) {
+        std::vector<std::uint8_t> opened;
+        std::size_t at = 0;
+        return Stream::decrypt(sk.data(), reader(bytes, at), writer(opened));
+    };
+
+    std::vector<std::uint8_t> tampered = sealed;
+    tampered[Stream::HEADER_BYTES + 1500] ^= 0x80;
+    assert(open(tampered) == StreamStatus::Corrupt);
+    tampered = sealed;
+    tampered[STREAM_PREAMBLE_BYTES + 3] ^= 1;
+    assert(open(tampered) == StreamStatus::Corrupt);
+    tampered = sealed;
+    tampered[12] ^= 1; // the chunk size is bound into the key
+    assert(open(tampered) == StreamStatus::Corrupt);
+    tampered = sealed;
+    tampered[8] ^= 1;
+    assert(open(tampered) == StreamStatus::BadHeader);
+
+    // Cut at a chunk boundary, or inside the final chunk
+    const std::size_t full = CHUNK + csprng::Aes256Gcm::TAG_BYTES;
+    assert(open(std::vector<std::uint8_t>(sealed.begin(), sealed.begin() + Stream::HEADER_BYTES + 2 * full)) ==
+           StreamStatus::Truncated);
+    assert(open(std::vector<std::uint8_t>(sealed.begin(), sealed.end() - 1)) == StreamStatus::Corrupt);
+    assert(open(std::vector<std::uint8_t>(sealed.begin(), sealed.begin() + 100)) == StreamStatus::Truncated);
+
+    // Swapping two whole chunks
+    tampered = sealed;
+    std::swap_ranges(tampered.begin() + Stream::HEADER_BYTES, tampered.begin() + Stream::HEADER_BYTES + full,
+                     tampered.begin() + Stream::HEADER_BYTES + full);
+    assert(open(tampered) == StreamStatus::Corrupt);
+
+    // Reader and writer failures surface as such
+    const StreamReader failing = [](std::uint8_t*, std::size_t, std::size_t&) { return false; };
+    const StreamWriter refusing = [](const std::uint8_t*, std::size_t) { return false; };
+    std::vector<std::uint8_t> sink;
+    assert(Stream::encrypt(pk.data(), failing, writer(sink), rng, CHUNK) == StreamStatus::ReadError);
+    position = 0;
+    assert(Stream::encrypt(pk.data(), reader(plain, position), refusing, rng, CHUNK) == StreamStatus::WriteError);
+
+    std::cout << "Hybrid stream test passed for N=" << Params::N << std::endl;
+}
+
+// The C API reproduces count = 0 of the reference KAT file: keys and ciphertext are compared
+// through their SHAKE256 digests, then decryption must recover the message and reject tampering
+template <class Params>
+void test_c_api(int (*keypair)(unsigned char*, unsigned char*),
+                int (*encrypt)(unsigned char*, unsigned long long*, const unsigned char*, unsigned long long, const unsigned char*),
+                int (*encrypt_open)(unsigned char*, unsigned long long*, const unsigned char*, unsigned long long, const unsigned char*),
+                const char* pk_digest, const char* sk_digest, const char* c_digest) {
+    using Pke = GiophantusPke<Params>;
+    std::uint8_t entropy[48];
+    for (int i = 0; i < 48; ++i) {
+        entropy[i] = static_cast<std::uint8_t>(i);
+    }
+    std::uint8_t seed[48];
+    std::vector<std::uint8_t> message(Pke::MESSAGE_BYTES);
+    giophantus_randombytes_init(entropy, nullptr, 256);
+    giophantus_randombytes(seed, sizeof(seed));
+    giophantus_randombytes(message.data(), message.size());
+
+    std::vector<std::uint8_t> pk(Pke::PUBLIC_KEY_BYTES), sk(Pke::SECRET_KEY_BYTES), c(Pke::CIPHERTEXT_BYTES);
+    unsigned long long clen = 0, mlen = 0;
+    giophantus_randombytes_init(seed, nullptr, 256);
+    assert(keypair(pk.data(), sk.data()) == GIOPHANTUS_OK);
+    assert(encrypt(c.data(), &clen, message.data(), message.size(), pk.data()) == GIOPHANTUS_OK);
+    assert(clen == c.size());
+
+    std::uint8_t digest[32];
+    csprng::shake256(digest, sizeof(digest), pk.data(), pk.size());
+    assert(std::equal(digest, digest + 32, from_hex(pk_digest).begin()));
+    csprng::shake256(digest, sizeof(digest), sk.data(), sk.size());
+    assert(std::equal(digest, digest + 32, from_hex(sk_digest).begin()));
+    csprng::shake256(digest, sizeof(digest), c.data(), c.size());
+    assert(std::equal(digest, digest + 32, from_hex(c_digest).begin()));
+
+    std::vector<std::uint8_t> recovered(Pke::MESSAGE_BYTES);
+    assert(encrypt_open(recovered.data(), &mlen, c.data(), clen, sk.data()) == GIOPHANTUS_OK);
+    assert(mlen == message.size() && recovered == message);
+
+    // A flipped payload bit and an unreduced coefficient both fail the re-encryption check
+    c[7] ^= 0x10;
+    assert(encrypt_open(recovered.data(), &mlen, c.data(), clen, sk.data()) == GIOPHANTUS_NG);
+    c[7] ^= 0x10;
+    c[3] = 0xff;
+    c[2] = 0xff;
+    c[1] = 0xff;
+    c[0] = 0xff;
+    assert(encrypt_open(recovered.data(), &mlen, c.data(), clen, sk.data()) == GIOPHANTUS_NG);
+    assert(encrypt(c.data(), &clen, message.data(), message.size() - 1, pk.data()) == GIOPHANTUS_NG);
+
+    // Codec round trip of the key the API produced
+    typename Params::PublicPoly X;
+    assert(ByteCodec::decode(X, pk.data()));
+    std::vector<std::uint8_t> encoded(pk.size());
+    ByteCodec::encode(encoded.data(), X);
+    assert(encoded == pk);
+
+    std::cout << "C API test passed for N = " << Params::N << " (KAT count 0)" << std::endl;
+}
+
+template <Fq Q>
+void test_reduction_policies() {
+    std::mt19937_64 generator(Q);
+    std::uniform_int_distribution<std::uint64_t> wide;
+    std::uniform_int_distribution<std::uint64_t> product(0, static_cast<std::uint64_t>(Q - 1) * (Q - 1));
+
+    for (int i = 0; i < 10000; ++i) {
+        const std::uint64_t x = wide(generator);
+        const std::uint64_t y = product(generator);
+        assert(BarrettReduction<Q>::reduce(x) == x % Q);
+        assert(MontgomeryReduction<Q>::reduce(y) == y % Q);
+        if constexpr ((Q & (Q + 1)) == 0) {
+            assert(MersenneReduction<Q>::reduce(x) == x % Q);
+        }
+    }
+    assert(BarrettReduction<Q>::reduce(~std::uint64_t{0}) == ~std::uint64_t{0} % Q);
+
+    // The policy is part of the ring type; all of them must agree on the result
+    using Barrett = Rq<24, Q, MulBackend::Schoolbook, BarrettReduction<Q>>;
+    using Montgomery = Rq<24, Q, MulBackend::Schoolbook, MontgomeryReduction<Q>>;
     RandomPolynomialGenerator rng;
-    Polynomial p1 = rng.generate(params.degree, params.noise_bound);
-    Polynomial p2 = rng.generate(params.degree, params.noise_bound);
+    Barrett a = rng.uniform<Barrett>();
+    Barrett b = rng.uniform<Barrett>();
+    Montgomery a2, b2;
+    std::copy(a.begin(), a.end(), a2.begin());
+    std::copy(b.begin(), b.end(), b2.begin());
+    Montgomery product2 = a2 * b2;
+    Barrett product1 = a * b;
+    assert(std::equal(product1.begin(), product1.end(), product2.begin()));
+    std::cout << "Reduction policies test passed for q=" << Q << std::endl;
+}
 
-    Polynomial sum = p1 + p2;
-    Polynomial product = p1 * p2;
+template <class Ring>
+void test_multiplication_backends() {
+    constexpr std::size_t N = Ring::dimension;
+    constexpr Fq Q = Ring::modulus;
 
-    std::cout << "Polynomial operations test passed for params: modulo=" << params.modulo << ", degree=" << params.degree << std::endl;
+    RandomPolynomialGenerator rng;
+    Ring a = rng.uniform<Ring>();
+    Ring b = rng.uniform<Ring>();
+    // All-(q - 1) operands squared hit the CRT bound N * (q - 1)^2 exactly
+    Ring top;
+    std::fill(top.begin(), top.end(), Q - 1);
+
+    for (const auto& [x, y] : {std::pair{&a, &b}, std::pair{&top, &top}}) {
+        Ring slow, fast;
+        SchoolbookMultiplier<N, Q>::mul(slow.data(), x->data(), y->data());
+        NttMultiplier<N, Q>::mul(fast.data(), x->data(), y->data());
+        assert(slow == fast);
+    }
+
+    // NTT_ACCUMULATION worst-case products summed before one inverse, as Pq products and
+    // decryption do
+    using Ntt = NttMultiplier<N, Q>;
+    std::vector<std::uint32_t> t(Ntt::transform_words), acc(Ntt::transform_words);
+    Ntt::forward(t.data(), top.data());
+    Ntt::clear(acc.data());
+    Ring expected{}, sum;
+    for (std::size_t k = 0; k < NTT_ACCUMULATION; ++k) {
+        Ntt::mul_acc(acc.data(), t.data(), t.data());
+        SchoolbookMultiplier<N, Q>::mul_acc(expected.data(), top.data(), top.data());
+    }
+    Ntt::inverse(sum.data(), acc.data());
+    assert(sum == expected);
+    std::cout << "NTT multiplication matches schoolbook for N=" << N << ", q=" << Q
+              << " (" << NttMultiplier<N, Q>::prime_count << " primes)" << std::endl;
+}
+
+// Every compiled-in backend must reproduce the scalar kernels bit for bit, tails included
+void test_simd_backends() {
+    const simd::Kernels* scalar = simd::find(simd::Backend::Scalar);
+    const simd::Kernels& active = simd::kernels();
+    const simd::Modulus m = NTT_MODULI[0].kernel_modulus();
+    constexpr Fq Q = 0x7fffffffu;
+    std::mt19937 generator(4);
+
+    for (simd::Backend backend : {simd::Backend::Sse42, simd::Backend::Avx2, simd::Backend::Avx512, simd::Backend::Neon}) {
+        const simd::Kernels* k = simd::find(backend);
+        if (k == nullptr) {
+            continue;
+        }
+        for (std::size_t n = 0; n <= 70; ++n) {
+            std::vector<std::uint32_t> a(n), b(n), w(n), expected(n), actual(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                a[i] = generator() % Q;
+                b[i] = generator() % Q;
+                w[i] = generator() % m.q;
+            }
+            const std::uint32_t s = generator() % Q;
+
+            scalar->add(expected.data(), a.data(), b.data(), n, Q);
+            k->add(actual.data(), a.data(), b.data(), n, Q);
+            assert(expected == actual);
+            scalar->sub(expected.data(), a.data(), b.data(), n, Q);
+            k->sub(actual.data(), a.data(), b.data(), n, Q);
+            assert(expected == actual);
+            scalar->scalar_mul(expected.data(), a.data(), s, n, Q);
+            k->scalar_mul(actual.data(), a.data(), s, n, Q);
+            assert(expected == actual);
+            expected = b;
+            actual = b;
+            scalar->scalar_mul_acc(expected.data(), a.data(), s, n, Q);
+            k->scalar_mul_acc(actual.data(), a.data(), s, n, Q);
+            assert(expected == actual);
+            std::vector<std::uint64_t> wide_expected(n, ~std::uint64_t{0} >> 2), wide_actual = wide_expected;
+            scalar->mul_acc_wide(wide_expected.data(), a.data(), s, n);
+            k->mul_acc_wide(wide_actual.data(), a.data(), s, n);
+            assert(wide_expected == wide_actual);
+            expected = a;
+            actual = a;
+            scalar->reduce(expected.data(), n, 5);
+            k->reduce(actual.data(), n, 5);
+            assert(expected == actual);
+
+            // Montgomery kernels: operands below the NTT prime
+            for (std::size_t i = 0; i < n; ++i) {
+                a[i] %= m.q;
+                b[i] %= m.q;
+            }
+            scalar->mont_mul(expected.data(), a.data(), w.data(), n, m);
+            k->mont_mul(actual.data(), a.data(), w.data(), n, m);
+            assert(expected == actual);
+            expected = b;
+            actual = b;
+            scalar->mont_mul_acc(expected.data(), a.data(), w.data(), n, m);
+            k->mont_mul_acc(actual.data(), a.data(), w.data(), n, m);
+            assert(expected == actual);
+            scalar->mont_scale(expected.data(), a.data(), s % m.q, n, m);
+            k->mont_scale(actual.data(), a.data(), s % m.q, n, m);
+            assert(expected == actual);
+
+            std::vector<std::uint32_t> x1 = a, y1 = b, x2 = a, y2 = b;
+            scalar->dif_butterflies(x1.data(), y1.data(), w.data(), n, m);
+            k->dif_butterflies(x2.data(), y2.data(), w.data(), n, m);
+            assert(x1 == x2 && y1 == y2);
+            scalar->dit_butterflies(x1.data(), y1.data(), w.data(), n, m);
+            k->dit_butterflies(x2.data(), y2.data(), w.data(), n, m);
+            assert(x1 == x2 && y1 == y2);
+        }
+
+        // Whole ring products through this backend
+        simd::select(backend);
+        test_multiplication_backends<IEC602::Ring>();
+        std::cout << "SIMD backend " << k->name << " matches scalar kernels" << std::endl;
+    }
+    simd::select(active.backend);
+    std::cout << "Active SIMD backend: " << simd::kernels().name << std::endl;
 }
 
 int main() {
-    GiophantusParams param128 = {17, 11, 4, 32};
-    GiophantusParams param192 = {23, 19, 6, 48};
-    GiophantusParams param256 = {29, 23, 8, 64};
+    test_reduction_policies<17>();
+    test_reduction_policies<65521>();
+    test_reduction_policies<0x7fffffffu>();
+
+    test_multiplication_backends<Param128::Ring>();
+    test_multiplication_backends<Rq<257, 65521>>();
+    // q near 2^30 reduces the lazy schoolbook sums every 16 of its 64 rows
+    static_assert(SchoolbookMultiplier<64, 1073741789>::lazy && SchoolbookMultiplier<64, 1073741789>::lazy_rows == 16);
+    test_multiplication_backends<Rq<64, 1073741789>>();
+    test_multiplication_backends<IEC602::Ring>();
+
+    test_simd_backends();
+    test_random_sources();
+    test_aes_gcm();
 
     // Run tests for different parameters
-    test_keygen(param128);
-    test_polynomial_operations(param128);
+    test_keygen<Param128>();
+    test_polynomial_operations<Param128>();
+    test_bivariate_operations<Param128>();
+    test_sparse_products<Param128>();
+    test_small_ring<Param128>();
+    test_horner_evaluation<Param128>();
+    test_ring_expressions<Param128>();
+
+    test_keygen<Param192>();
+    test_polynomial_operations<Param192>();
+    test_bivariate_operations<Param192>();
+    test_small_ring<Param192>();
+
+    test_keygen<Param256>();
+    test_polynomial_operations<Param256>();
+    test_bivariate_operations<Param256>();
+    test_sparse_products<Param256>();
+    test_small_ring<Param256>();
+
+    test_keygen<IEC602>();
+    test_unit_test<Param128::Ring>();
+    test_unit_test<Rq<13, 3>>();
+    test_unit_test<Rq<11, 23>>();
+    test_key_validation<IEC602>();
+    test_key_validation<IEC868>();
+    test_key_validation<IEC1134>();
+    test_polynomial_operations<IEC602>();
+    test_bivariate_operations<IEC602>();
+    test_sparse_products<IEC602>();
+    test_sparse_products<IEC1134>();
+    test_small_ring<IEC1134>();
+    test_horner_evaluation<IEC602>();
+    test_ring_expressions<IEC602>();
+    test_encryption<IEC602>();
+    test_decryption_context<Param192>();
+    test_decryption_context<IEC602>();
+    test_codec<IEC602>();
+    test_codec<IEC868>();
+    test_key_store<IEC602>();
+    test_hybrid_stream<IEC602>();
+    test_param_registry();
+    test_instrumentation<IEC602>();
+
+    test_scratch_arena<Param128>();
+    test_scratch_arena<IEC602>();
 
-    test_keygen(param192);
-    test_polynomial_operations(param192);
+    test_thread_pool();
+    test_parallel_batches<IEC602>();
+    test_mpmc_ring();
+    test_key_pool<IEC602>();
+    test_async_cipher<IEC602>();
+    test_parallel_batches<IEC1134>();
+    test_gpu_encryption<IEC602>();
 
-    test_keygen(param256);
-    test_polynomial_operations(param256);
+    test_c_api<IEC602>(giophantus_iec602_keypair, giophantus_iec602_encrypt, giophantus_iec602_encrypt_open,
+                       "3810558f691cd7b4d21a9da16a4b600acff5d921638a27f6d0dfb85c08f21af3",
+                       "9f89d6375773ac1e15902b1ee6501305977f68d0a2355119591e1fc077395b1d",
+                       "fff02abebcfef8f5051ed58ce42e6b68243b7805b9aa4c59ba9a361d1f88b944");
+    test_c_api<IEC868>(giophantus_iec868_keypair, giophantus_iec868_encrypt, giophantus_iec868_encrypt_open,
+                       "b1bea7fd1ffb60b5600b1d8d2d9b05c20dfd5a7b6b5ae8bb37c57d184264099c",
+                       "b838e30162e940e3bc444ba376001a10fd09a910e2d588f6485c8beae91f9960",
+                       "f564abf24a567942201e3308a19d5319002392e8756820b3c14e7c97e8746183");
+    test_c_api<IEC1134>(giophantus_iec1134_keypair, giophantus_iec1134_encrypt, giophantus_iec1134_encrypt_open,
+                        "db4ca685aa39030045eb16bcffeca941b3c89570b749e18afbf79f6b506821c2",
+                        "5d4cdcbd3099c83456c53ff83551ef67e0ab36d8d75d8646f75e515018c1685a",
+                        "d98d5b0f3de149b293456326cf3a914125aea53bb8ec0ea456db8996856ca4ec");
 
     std::cout << "All tests completed successfully." << std::endl;
     return 0;
@@ -0,0 +1,109 @@
+// C interface over GiophantusPke for the IEC parameter sets
+#include "giophantus/api.h"
+
+#include <array>
+#include <mutex>
+
+#include "giophantus/pke.h"
+
+namespace {
+
+using giophantus::GiophantusPke;
+using giophantus::RandomPolynomialGenerator;
+using giophantus::Sampling;
+
+// The process-wide randombytes() stream. Reference sampling keeps key generation on the
+// per-coefficient randombytes() calls of the reference, so seeded runs reproduce the KAT files.
+struct GlobalRandom {
+    std::mutex mutex;
+    RandomPolynomialGenerator rng{Sampling::Reference};
+};
+
+GlobalRandom& global_random() {
+    static GlobalRandom instance;
+    return instance;
+}
+
+static_assert(GiophantusPke<giophantus::IEC602>::PUBLIC_KEY_BYTES == GIOPHANTUS_IEC602_PUBLICKEYBYTES &&
+              GiophantusPke<giophantus::IEC602>::SECRET_KEY_BYTES == GIOPHANTUS_IEC602_SECRETKEYBYTES &&
+              GiophantusPke<giophantus::IEC602>::CIPHERTEXT_BYTES == GIOPHANTUS_IEC602_BYTES &&
+              GiophantusPke<giophantus::IEC602>::MESSAGE_BYTES == GIOPHANTUS_IEC602_MESSAGEBYTES);
+static_assert(GiophantusPke<giophantus::IEC868>::PUBLIC_KEY_BYTES == GIOPHANTUS_IEC868_PUBLICKEYBYTES &&
+              GiophantusPke<giophantus::IEC868>::SECRET_KEY_BYTES == GIOPHANTUS_IEC868_SECRETKEYBYTES &&
+              GiophantusPke<giophantus::IEC868>::CIPHERTEXT_BYTES == GIOPHANTUS_IEC868_BYTES &&
+              GiophantusPke<giophantus::IEC868>::MESSAGE_BYTES == GIOPHANTUS_IEC868_MESSAGEBYTES);
+static_assert(GiophantusPke<giophantus::IEC1134>::PUBLIC_KEY_BYTES == GIOPHANTUS_IEC1134_PUBLICKEYBYTES &&
+              GiophantusPke<giophantus::IEC1134>::SECRET_KEY_BYTES == GIOPHANTUS_IEC1134_SECRETKEYBYTES &&
+              GiophantusPke<giophantus::IEC1134>::CIPHERTEXT_BYTES == GIOPHANTUS_IEC1134_BYTES &&
+              GiophantusPke<giophantus::IEC1134>::MESSAGE_BYTES == GIOPHANTUS_IEC1134_MESSAGEBYTES);
+
+template <class Params>
+int keypair(unsigned char* pk, unsigned char* sk) {
+    GlobalRandom& random = global_random();
+    std::lock_guard<std::mutex> lock(random.mutex);
+    GiophantusPke<Params>::keypair(pk, sk, random.rng);
+    return GIOPHANTUS_OK;
+}
+
+// Only the padding draw holds the lock; r and e come from the payload's own seed expander
+template <class Params>
+int encrypt(unsigned char* c, unsigned long long* clen, const unsigned char* m, unsigned long long mlen, const unsigned char* pk) {
+    using Pke = GiophantusPke<Params>;
+    if (mlen != Pke::MESSAGE_BYTES) {
+        return GIOPHANTUS_NG;
+    }
+    std::array<unsigned char, Pke::PADDING_BYTES> padding;
+    giophantus_randombytes(padding.data(), padding.size());
+    if (!Pke::encrypt(c, m, pk, padding.data())) {
+        return GIOPHANTUS_NG;
+    }
+    *clen = Pke::CIPHERTEXT_BYTES;
+    return GIOPHANTUS_OK;
+}
+
+template <class Params>
+int encrypt_open(unsigned char* m, unsigned long long* mlen, const unsigned char* c, unsigned long long clen, const unsigned char* sk) {
+    using Pke = GiophantusPke<Params>;
+    if (clen != Pke::CIPHERTEXT_BYTES || !Pke::decrypt(m, c, sk)) {
+        return GIOPHANTUS_NG;
+    }
+    *mlen = Pke::MESSAGE_BYTES;
+    return GIOPHANTUS_OK;
+}
+
+} // namespace
+
+extern "C" {
+
+void giophantus_randombytes_init(const unsigned char* entropy_input, const unsigned char* personalization_string,
+                                 int /* security_strength */) {
+    GlobalRandom& random = global_random();
+    std::lock_guard<std::mutex> lock(random.mutex);
+    random.rng = RandomPolynomialGenerator(csprng::CtrDrbg(entropy_input, personalization_string), Sampling::Reference);
+}
+
+int giophantus_randombytes(unsigned char* x, unsigned long long xlen) {
+    GlobalRandom& random = global_random();
+    std::lock_guard<std::mutex> lock(random.mutex);
+    random.rng.random_bytes(x, static_cast<std::size_t>(xlen));
+    return GIOPHANTUS_OK;
+}
+
+#define GIOPHANTUS_DEFINE_PARAMS(name, Params)                                                                 \
+    int giophantus_##name##_keypair(unsigned char* pk, unsigned char* sk) {                                    \
+        return keypair<giophantus::Params>(pk, sk);                                                            \
+    }                                                                                                          \
+    int giophantus_##name##_encrypt(unsigned char* c, unsigned long long* clen, const unsigned char* m,        \
+                                    unsigned long long mlen, const unsigned char* pk) {                        \
+        return encrypt<giophantus::Params>(c, clen, m, mlen, pk);                                              \
+    }                                                                                                          \
+    int giophantus_##name##_encrypt_open(unsigned char* m, unsigned long long* mlen, const unsigned char* c,   \
+                                         unsigned long long clen, const unsigned char* sk) {                   \
+        return encrypt_open<giophantus::Params>(m, mlen, c, clen, sk);                                         \
+    }
+
+GIOPHANTUS_DEFINE_PARAMS(iec602, IEC602)
+GIOPHANTUS_DEFINE_PARAMS(iec868, IEC868)
+GIOPHANTUS_DEFINE_PARAMS(iec1134, IEC1134)
+
+} // extern "C"
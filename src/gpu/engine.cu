@@ -0,0 +1,354 @@
+// CUDA engine of GpuEncryptionContext: X * r over the NTT primes of the CPU multiplier
+#include "giophantus/gpu.h"
+
+#include <cuda_runtime.h>
+
+#include <vector>
+
+namespace giophantus {
+
+namespace {
+
+// Largest transform one thread block holds in shared memory (32 KiB)
+constexpr std::size_t MAX_TRANSFORM = 8192;
+constexpr unsigned THREADS = 512;
+
+// Montgomery arithmetic modulo one NTT prime, R = 2^32, residues in [0, p)
+struct Prime {
+    std::uint32_t p;
+    std::uint32_t pinv; // -p^-1 mod 2^32
+    std::uint32_t r2;   // R^2 mod p
+};
+
+__device__ __forceinline__ std::uint32_t redc(std::uint64_t t, const Prime& m) {
+    const std::uint32_t k = static_cast<std::uint32_t>(t) * m.pinv;
+    const std::uint32_t r = static_cast<std::uint32_t>((t + static_cast<std::uint64_t>(k) * m.p) >> 32);
+    return r >= m.p ? r - m.p : r;
+}
+
+__device__ __forceinline__ std::uint32_t mont_mul(std::uint32_t a, std::uint32_t b, const Prime& m) {
+    return redc(static_cast<std::uint64_t>(a) * b, m);
+}
+
+__device__ __forceinline__ std::uint32_t add_mod(std::uint32_t a, std::uint32_t b, std::uint32_t p) {
+    const std::uint32_t s = a + b;
+    return s >= p ? s - p : s;
+}
+
+__device__ __forceinline__ std::uint32_t sub_mod(std::uint32_t a, std::uint32_t b, std::uint32_t p) {
+    return a >= b ? a - b : a + p - b;
+}
+
+struct Constants {
+    Prime primes[3];
+    std::uint32_t scale[3];  // plain n^-1 mod p
+    std::uint64_t p0_inv_p1; // Garner constants, plain residues
+    std::uint64_t p01_inv_p2;
+};
+
+// One block per (polynomial, prime): a[0, N) * R, zero-padded, DIF into bit-reversed order.
+// in holds `polys` polynomials of n coefficients; out the transforms, limb k of poly at
+// out + (poly * primes + k) * size.
+__global__ void forward_kernel(std::uint32_t* out, const std::uint32_t* in, const std::uint32_t* roots, Constants c,
+                               std::uint32_t n, std::uint32_t size, std::uint32_t primes) {
+    extern __shared__ std::uint32_t a[];
+    const std::uint32_t poly = blockIdx.x;
+    const std::uint32_t k = blockIdx.y;
+    const Prime m = c.primes[k];
+    const std::uint32_t* src = in + static_cast<std::size_t>(poly) * n;
+    const std::uint32_t* w = roots + static_cast<std::size_t>(k) * size;
+
+    for (std::uint32_t i = threadIdx.x; i < size; i += blockDim.x) {
+        a[i] = i < n ? mont_mul(src[i], m.r2, m) : 0;
+    }
+    __syncthreads();
+    for (std::uint32_t len = size >> 1; len >= 1; len >>= 1) {
+        for (std::uint32_t b = threadIdx.x; b < size / 2; b += blockDim.x) {
+            const std::uint32_t j = b & (len - 1);
+            const std::uint32_t s = (b - j) * 2;
+            const std::uint32_t u = a[s + j];
+            const std::uint32_t v = a[s + j + len];
+            a[s + j] = add_mod(u, v, m.p);
+            a[s + j + len] = mont_mul(sub_mod(u, v, m.p), w[len + j], m);
+        }
+        __syncthreads();
+    }
+    std::uint32_t* dst = out + (static_cast<std::size_t>(poly) * primes + k) * size;
+    for (std::uint32_t i = threadIdx.x; i < size; i += blockDim.x) {
+        dst[i] = a[i];
+    }
+}
+
+// One block per (message, ciphertext term, prime): the pointwise sum of that term's products,
+// then the DIT inverse scaled by 1/size. products[first[t], first[t + 1]) belong to term t.
+__global__ void product_kernel(std::uint32_t* out, const std::uint32_t* xt, const std::uint32_t* rt,
+                               const std::uint32_t* inverse_roots, const GpuProduct* products, const std::uint32_t* first,
+                               Constants c, std::uint32_t size, std::uint32_t primes, std::uint32_t r_terms,
+                               std::uint32_t c_terms) {
+    extern __shared__ std::uint32_t a[];
+    const std::uint32_t message = blockIdx.x / c_terms;
+    const std::uint32_t term = blockIdx.x % c_terms;
+    const std::uint32_t k = blockIdx.y;
+    const Prime m = c.primes[k];
+    const std::uint32_t* w = inverse_roots + static_cast<std::size_t>(k) * size;
+
+    for (std::uint32_t i = threadIdx.x; i < size; i += blockDim.x) {
+        std::uint32_t acc = 0;
+        for (std::uint32_t q = first[term]; q < first[term + 1]; ++q) {
+            const GpuProduct p = products[q];
+            const std::uint32_t x = xt[(static_cast<std::size_t>(p.x) * primes + k) * size + i];
+            const std::uint32_t r = rt[((static_cast<std::size_t>(message) * r_terms + p.r) * primes + k) * size + i];
+            acc = add_mod(acc, mont_mul(x, r, m), m.p);
+        }
+        a[i] = acc;
+    }
+    __syncthreads();
+    for (std::uint32_t len = 1; len < size; len <<= 1) {
+        for (std::uint32_t b = threadIdx.x; b < size / 2; b += blockDim.x) {
+            const std::uint32_t j = b & (len - 1);
+            const std::uint32_t s = (b - j) * 2;
+            const std::uint32_t u = a[s + j];
+            const std::uint32_t v = mont_mul(a[s + j + len], w[len + j], m);
+            a[s + j] = add_mod(u, v, m.p);
+            a[s + j + len] = sub_mod(u, v, m.p);
+        }
+        __syncthreads();
+    }
+    std::uint32_t* dst = out + (static_cast<std::size_t>(blockIdx.x) * primes + k) * size;
+    for (std::uint32_t i = threadIdx.x; i < size; i += blockDim.x) {
+        dst[i] = mont_mul(a[i], c.scale[k], m);
+    }
+}
+
+// Garner recombination of coefficient i of one linear convolution, modulo q
+__device__ std::uint64_t crt(const std::uint32_t* t, std::uint32_t i, const Constants& c, std::uint32_t size,
+                             std::uint32_t primes, std::uint64_t q) {
+    const std::uint64_t p0 = c.primes[0].p;
+    const std::uint64_t a0 = t[i];
+    std::uint64_t x = a0 % q;
+    if (primes >= 2) {
+        const std::uint64_t p1 = c.primes[1].p;
+        const std::uint64_t t1 = (t[size + i] + p1 - a0 % p1) % p1 * c.p0_inv_p1 % p1;
+        x = (x + p0 % q * t1) % q;
+        if (primes >= 3) {
+            const std::uint64_t p2 = c.primes[2].p;
+            const std::uint64_t low = (a0 + p0 * t1) % p2;
+            const std::uint64_t t2 = (t[2 * size + i] + p2 - low) % p2 * c.p01_inv_p2 % p2;
+            x = (x + p0 * c.primes[1].p % q * t2) % q;
+        }
+    }
+    return x;
+}
+
+// One thread per coefficient: fold t^(n + i) onto t^i
+__global__ void crt_kernel(std::uint32_t* out, const std::uint32_t* ct, Constants c, std::uint32_t n, std::uint32_t size,
+                           std::uint32_t primes, std::uint32_t q) {
+    const std::uint32_t poly = blockIdx.y;
+    const std::uint32_t i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i >= n) {
+        return;
+    }
+    const std::uint32_t* t = ct + static_cast<std::size_t>(poly) * primes * size;
+    std::uint64_t x = crt(t, i, c, size, primes, q);
+    if (i + 1 < n) {
+        x = (x + crt(t, i + n, c, size, primes, q)) % q;
+    }
+    out[static_cast<std::size_t>(poly) * n + i] = static_cast<std::uint32_t>(x);
+}
+
+std::uint32_t to_montgomery(std::uint32_t x, std::uint32_t p) {
+    return static_cast<std::uint32_t>((static_cast<std::uint64_t>(x) << 32) % p);
+}
+
+template <class T>
+bool device_copy(T** dst, const T* src, std::size_t count) {
+    return cudaMalloc(dst, count * sizeof(T)) == cudaSuccess &&
+           cudaMemcpy(*dst, src, count * sizeof(T), cudaMemcpyHostToDevice) == cudaSuccess;
+}
+
+} // namespace
+
+struct GpuBatchEngine::Device {
+    GpuLayout layout;
+    std::size_t batch = 0;
+    Constants constants{};
+    bool ok = false;
+
+    std::uint32_t* roots = nullptr;
+    std::uint32_t* inverse_roots = nullptr;
+    std::uint32_t* x_transforms = nullptr;
+    GpuProduct* products = nullptr;
+    std::uint32_t* first = nullptr;
+
+    struct Slot {
+        cudaStream_t stream = nullptr;
+        std::uint32_t* host_r = nullptr; // pinned
+        std::uint32_t* host_c = nullptr; // pinned
+        std::uint32_t* r = nullptr;
+        std::uint32_t* rt = nullptr;
+        std::uint32_t* ct = nullptr;
+        std::uint32_t* c = nullptr;
+    } slots[SLOTS];
+
+    ~Device() {
+        for (Slot& s : slots) {
+            if (s.stream != nullptr) {
+                cudaStreamSynchronize(s.stream);
+                cudaStreamDestroy(s.stream);
+            }
+            cudaFreeHost(s.host_r);
+            cudaFreeHost(s.host_c);
+            cudaFree(s.r);
+            cudaFree(s.rt);
+            cudaFree(s.ct);
+            cudaFree(s.c);
+        }
+        cudaFree(roots);
+        cudaFree(inverse_roots);
+        cudaFree(x_transforms);
+        cudaFree(products);
+        cudaFree(first);
+    }
+
+    std::size_t shared_bytes() const {
+        return layout.transform_size * sizeof(std::uint32_t);
+    }
+
+    bool setup(const Fq* x_coefficients) {
+        const std::size_t size = layout.transform_size;
+        const std::size_t n = layout.n;
+        if (size > MAX_TRANSFORM || layout.primes > NTT_PRIMES.size()) {
+            return false;
+        }
+
+        // The twiddle layout of NttPlan: table[k][len + j] = w^j * R for the (2 * len)-th root w
+        std::vector<std::uint32_t> w(layout.primes * size), iw(layout.primes * size);
+        for (std::size_t k = 0; k < layout.primes; ++k) {
+            const std::uint32_t p = NTT_PRIMES[k].p;
+            for (std::size_t len = 1; len < size; len <<= 1) {
+                const std::uint32_t root = ntt_powmod(NTT_PRIMES[k].g, (p - 1) / (2 * len), p);
+                const std::uint32_t inverse_root = ntt_powmod(root, p - 2, p);
+                std::uint32_t x = 1, ix = 1;
+                for (std::size_t j = 0; j < len; ++j) {
+                    w[k * size + len + j] = to_montgomery(x, p);
+                    iw[k * size + len + j] = to_montgomery(ix, p);
+                    x = ntt_mulmod(x, root, p);
+                    ix = ntt_mulmod(ix, inverse_root, p);
+                }
+            }
+            std::uint32_t pinv = 1;
+            for (int i = 0; i < 5; ++i) {
+                pinv *= 2 - p * pinv;
+            }
+            const std::uint32_t r = to_montgomery(1, p);
+            constants.primes[k] = {p, 0u - pinv, ntt_mulmod(r, r, p)};
+            constants.scale[k] = ntt_powmod(static_cast<std::uint32_t>(size % p), p - 2, p);
+        }
+        const std::uint32_t p0 = NTT_PRIMES[0].p, p1 = NTT_PRIMES[1].p, p2 = NTT_PRIMES[2].p;
+        constants.p0_inv_p1 = ntt_powmod(p0 % p1, p1 - 2, p1);
+        constants.p01_inv_p2 = ntt_powmod(ntt_mulmod(p0 % p2, p1 % p2, p2), p2 - 2, p2);
+
+        std::vector<std::uint32_t> offsets(layout.c_terms + 1, 0);
+        for (const GpuProduct& p : layout.products) {
+            ++offsets[p.out + 1];
+        }
+        for (std::size_t t = 0; t < layout.c_terms; ++t) {
+            offsets[t + 1] += offsets[t];
+        }
+
+        std::uint32_t* x = nullptr;
+        const bool uploaded = device_copy(&roots, w.data(), w.size()) && device_copy(&inverse_roots, iw.data(), iw.size()) &&
+                              device_copy(&products, layout.products.data(), layout.products.size()) &&
+                              device_copy(&first, offsets.data(), offsets.size()) &&
+                              device_copy(&x, x_coefficients, layout.x_terms * n) &&
+                              cudaMalloc(&x_transforms, layout.x_terms * layout.primes * size * sizeof(std::uint32_t)) == cudaSuccess;
+        if (uploaded) {
+            forward_kernel<<<dim3(static_cast<unsigned>(layout.x_terms), static_cast<unsigned>(layout.primes)), THREADS,
+                             shared_bytes()>>>(x_transforms, x, roots, constants, static_cast<std::uint32_t>(n),
+                                               static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(layout.primes));
+        }
+        const bool transformed = uploaded && cudaDeviceSynchronize() == cudaSuccess;
+        cudaFree(x);
+        if (!transformed) {
+            return false;
+        }
+
+        const std::size_t r_words = batch * layout.r_terms * n;
+        const std::size_t c_words = batch * layout.c_terms * n;
+        for (Slot& s : slots) {
+            if (cudaStreamCreateWithFlags(&s.stream, cudaStreamNonBlocking) != cudaSuccess ||
+                cudaHostAlloc(&s.host_r, r_words * sizeof(std::uint32_t), cudaHostAllocDefault) != cudaSuccess ||
+                cudaHostAlloc(&s.host_c, c_words * sizeof(std::uint32_t), cudaHostAllocDefault) != cudaSuccess ||
+                cudaMalloc(&s.r, r_words * sizeof(std::uint32_t)) != cudaSuccess ||
+                cudaMalloc(&s.rt, batch * layout.r_terms * layout.primes * size * sizeof(std::uint32_t)) != cudaSuccess ||
+                cudaMalloc(&s.ct, batch * layout.c_terms * layout.primes * size * sizeof(std::uint32_t)) != cudaSuccess ||
+                cudaMalloc(&s.c, c_words * sizeof(std::uint32_t)) != cudaSuccess) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool submit(int index, std::size_t count) {
+        Slot& s = slots[index];
+        const std::size_t n = layout.n;
+        const std::uint32_t size = static_cast<std::uint32_t>(layout.transform_size);
+        const std::uint32_t primes = static_cast<std::uint32_t>(layout.primes);
+        const std::uint32_t r_polys = static_cast<std::uint32_t>(count * layout.r_terms);
+        const std::uint32_t c_polys = static_cast<std::uint32_t>(count * layout.c_terms);
+
+        if (cudaMemcpyAsync(s.r, s.host_r, r_polys * n * sizeof(std::uint32_t), cudaMemcpyHostToDevice, s.stream) != cudaSuccess) {
+            return false;
+        }
+        forward_kernel<<<dim3(r_polys, primes), THREADS, shared_bytes(), s.stream>>>(s.rt, s.r, roots, constants,
+                                                                                    static_cast<std::uint32_t>(n), size, primes);
+        product_kernel<<<dim3(c_polys, primes), THREADS, shared_bytes(), s.stream>>>(
+            s.ct, x_transforms, s.rt, inverse_roots, products, first, constants, size, primes,
+            static_cast<std::uint32_t>(layout.r_terms), static_cast<std::uint32_t>(layout.c_terms));
+        crt_kernel<<<dim3(static_cast<unsigned>((n + 255) / 256), c_polys), 256, 0, s.stream>>>(
+            s.c, s.ct, constants, static_cast<std::uint32_t>(n), size, primes, layout.q);
+        return cudaGetLastError() == cudaSuccess &&
+               cudaMemcpyAsync(s.host_c, s.c, c_polys * n * sizeof(std::uint32_t), cudaMemcpyDeviceToHost, s.stream) ==
+                   cudaSuccess;
+    }
+};
+
+bool GpuBatchEngine::available() {
+    int devices = 0;
+    return cudaGetDeviceCount(&devices) == cudaSuccess && devices > 0;
+}
+
+GpuBatchEngine::GpuBatchEngine(const GpuLayout& layout, const Fq* x_coefficients, std::size_t batch)
+    : device(std::make_unique<Device>()) {
+    device->layout = layout;
+    device->batch = batch;
+    device->ok = device->setup(x_coefficients);
+}
+
+GpuBatchEngine::~GpuBatchEngine() = default;
+
+bool GpuBatchEngine::ok() const {
+    return device->ok;
+}
+
+std::size_t GpuBatchEngine::batch() const {
+    return device->batch;
+}
+
+std::uint32_t* GpuBatchEngine::blinding(int slot) {
+    return device->slots[slot].host_r;
+}
+
+const std::uint32_t* GpuBatchEngine::products(int slot) const {
+    return device->slots[slot].host_c;
+}
+
+bool GpuBatchEngine::submit(int slot, std::size_t count) {
+    return device->submit(slot, count);
+}
+
+bool GpuBatchEngine::wait(int slot) {
+    return cudaStreamSynchronize(device->slots[slot].stream) == cudaSuccess;
+}
+
+} // namespace giophantus
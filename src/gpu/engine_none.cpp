@@ -0,0 +1,40 @@
+// GpuBatchEngine of a build without CUDA: never available, so GpuEncryptionContext stays on the CPU
+#include "giophantus/gpu.h"
+
+namespace giophantus {
+
+struct GpuBatchEngine::Device {};
+
+bool GpuBatchEngine::available() {
+    return false;
+}
+
+GpuBatchEngine::GpuBatchEngine(const GpuLayout&, const Fq*, std::size_t) {}
+
+GpuBatchEngine::~GpuBatchEngine() = default;
+
+bool GpuBatchEngine::ok() const {
+    return false;
+}
+
+std::size_t GpuBatchEngine::batch() const {
+    return 0;
+}
+
+std::uint32_t* GpuBatchEngine::blinding(int) {
+    return nullptr;
+}
+
+const std::uint32_t* GpuBatchEngine::products(int) const {
+    return nullptr;
+}
+
+bool GpuBatchEngine::submit(int, std::size_t) {
+    return false;
+}
+
+bool GpuBatchEngine::wait(int) {
+    return false;
+}
+
+} // namespace giophantus
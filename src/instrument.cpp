@@ -0,0 +1,188 @@
+// Collection and export of the instrumentation counters
+#include "giophantus/instrument.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace giophantus::instrument {
+
+namespace {
+
+constexpr const char* COUNTER_NAMES[COUNTERS] = {
+    "ring_multiplies", "transforms", "field_reductions", "samples_drawn", "arena_allocations", "arena_bytes", "arena_blocks",
+};
+
+constexpr const char* PHASE_NAMES[PHASES] = {"keygen", "encrypt", "decrypt"};
+
+// Live threads are summed on demand; exited ones are folded into retired
+struct Registry {
+    std::mutex mutex;
+    std::vector<detail::ThreadCounters*> live;
+    Snapshot retired;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+void add(Snapshot& total, const detail::ThreadCounters& c) {
+    for (std::size_t i = 0; i < COUNTERS; ++i) {
+        total.counters[i] += c.counters[i].load(std::memory_order_relaxed);
+    }
+    for (std::size_t p = 0; p < PHASES; ++p) {
+        total.phase_count[p] += c.phase_count[p].load(std::memory_order_relaxed);
+        total.phase_nanoseconds[p] += c.phase_nanoseconds[p].load(std::memory_order_relaxed);
+        for (std::size_t b = 0; b < BUCKETS; ++b) {
+            total.histogram[p][b] += c.histogram[p][b].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void clear(detail::ThreadCounters& c) {
+    for (auto& x : c.counters) {
+        x.store(0, std::memory_order_relaxed);
+    }
+    for (std::size_t p = 0; p < PHASES; ++p) {
+        c.phase_count[p].store(0, std::memory_order_relaxed);
+        c.phase_nanoseconds[p].store(0, std::memory_order_relaxed);
+        for (auto& x : c.histogram[p]) {
+            x.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Owns a thread's counters and hands them to the registry's totals at thread exit
+struct Attachment {
+    detail::ThreadCounters counters;
+
+    Attachment() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(&counters);
+    }
+
+    ~Attachment() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        add(r.retired, counters);
+        r.live.erase(std::find(r.live.begin(), r.live.end(), &counters));
+    }
+};
+
+std::atomic<PhaseCallback> phase_callback{nullptr};
+std::atomic<void*> phase_user{nullptr};
+std::atomic<TraceHook> trace_begin_hook{nullptr};
+std::atomic<TraceHook> trace_end_hook{nullptr};
+
+} // namespace
+
+const char* counter_name(Counter counter) {
+    return COUNTER_NAMES[static_cast<std::size_t>(counter)];
+}
+
+const char* phase_name(Phase phase) {
+    return PHASE_NAMES[static_cast<std::size_t>(phase)];
+}
+
+detail::ThreadCounters* detail::attach_thread() {
+    thread_local Attachment attachment;
+    return &attachment.counters;
+}
+
+void detail::record_phase(Phase phase, std::uint64_t nanoseconds) {
+    ThreadCounters& c = local();
+    const std::size_t p = static_cast<std::size_t>(phase);
+    const std::size_t bits = static_cast<std::size_t>(std::bit_width(nanoseconds));
+    const std::size_t bucket = std::min(bits > FIRST_BUCKET_BITS ? bits - FIRST_BUCKET_BITS : 0, LAST_BUCKET);
+    bump(c.phase_count[p], 1);
+    bump(c.phase_nanoseconds[p], nanoseconds);
+    bump(c.histogram[p][bucket], 1);
+    if (const PhaseCallback callback = phase_callback.load(std::memory_order_acquire)) {
+        callback(phase, nanoseconds, phase_user.load(std::memory_order_relaxed));
+    }
+}
+
+Snapshot snapshot() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Snapshot total = r.retired;
+    for (const detail::ThreadCounters* c : r.live) {
+        add(total, *c);
+    }
+    return total;
+}
+
+void reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.retired = Snapshot();
+    for (detail::ThreadCounters* c : r.live) {
+        clear(*c);
+    }
+}
+
+std::string prometheus_text() {
+    const Snapshot s = snapshot();
+    std::string out;
+    char line[256];
+    for (std::size_t i = 0; i < COUNTERS; ++i) {
+        std::snprintf(line, sizeof(line), "# TYPE giophantus_%s_total counter\ngiophantus_%s_total %llu\n", COUNTER_NAMES[i],
+                      COUNTER_NAMES[i], static_cast<unsigned long long>(s.counters[i]));
+        out += line;
+    }
+    out += "# TYPE giophantus_phase_seconds histogram\n";
+    for (std::size_t p = 0; p < PHASES; ++p) {
+        std::uint64_t cumulative = 0;
+        for (std::size_t b = 0; b < LAST_BUCKET; ++b) {
+            cumulative += s.histogram[p][b];
+            std::snprintf(line, sizeof(line), "giophantus_phase_seconds_bucket{phase=\"%s\",le=\"%g\"} %llu\n", PHASE_NAMES[p],
+                          static_cast<double>(std::uint64_t{1} << (b + FIRST_BUCKET_BITS)) * 1e-9,
+                          static_cast<unsigned long long>(cumulative));
+            out += line;
+        }
+        std::snprintf(line, sizeof(line),
+                      "giophantus_phase_seconds_bucket{phase=\"%s\",le=\"+Inf\"} %llu\n"
+                      "giophantus_phase_seconds_sum{phase=\"%s\"} %.9f\n"
+                      "giophantus_phase_seconds_count{phase=\"%s\"} %llu\n",
+                      PHASE_NAMES[p], static_cast<unsigned long long>(s.phase_count[p]), PHASE_NAMES[p],
+                      static_cast<double>(s.phase_nanoseconds[p]) * 1e-9, PHASE_NAMES[p],
+                      static_cast<unsigned long long>(s.phase_count[p]));
+        out += line;
+    }
+    return out;
+}
+
+void set_phase_callback(PhaseCallback callback, void* user) {
+    phase_user.store(user, std::memory_order_relaxed);
+    phase_callback.store(callback, std::memory_order_release);
+}
+
+void set_trace_hooks(TraceHook begin, TraceHook end) {
+    trace_begin_hook.store(begin, std::memory_order_relaxed);
+    trace_end_hook.store(end, std::memory_order_relaxed);
+}
+
+// Kept out of line, with the name in the first argument register, as uprobe targets
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void trace_begin(const char* name) {
+    if (const TraceHook hook = trace_begin_hook.load(std::memory_order_relaxed)) {
+        hook(name);
+    }
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void trace_end(const char* name) {
+    if (const TraceHook hook = trace_end_hook.load(std::memory_order_relaxed)) {
+        hook(name);
+    }
+}
+
+} // namespace giophantus::instrument
@@ -0,0 +1,170 @@
+// AES-256 key schedule, table-based block encryption and dispatch to AES-NI
+#include "giophantus/random.h"
+#include "aes_backend.h"
+#include "multiversion.h"
+
+#include <cstring>
+
+namespace csprng {
+
+namespace {
+
+// FIPS 197 Fig. 7
+constexpr std::uint8_t SBOX[256] = {
+    0x63,0x7c,0x77,0x7b,0xf2,0x6b,0x6f,0xc5,0x30,0x01,0x67,0x2b,0xfe,0xd7,0xab,0x76,
+    0xca,0x82,0xc9,0x7d,0xfa,0x59,0x47,0xf0,0xad,0xd4,0xa2,0xaf,0x9c,0xa4,0x72,0xc0,
+    0xb7,0xfd,0x93,0x26,0x36,0x3f,0xf7,0xcc,0x34,0xa5,0xe5,0xf1,0x71,0xd8,0x31,0x15,
+    0x04,0xc7,0x23,0xc3,0x18,0x96,0x05,0x9a,0x07,0x12,0x80,0xe2,0xeb,0x27,0xb2,0x75,
+    0x09,0x83,0x2c,0x1a,0x1b,0x6e,0x5a,0xa0,0x52,0x3b,0xd6,0xb3,0x29,0xe3,0x2f,0x84,
+    0x53,0xd1,0x00,0xed,0x20,0xfc,0xb1,0x5b,0x6a,0xcb,0xbe,0x39,0x4a,0x4c,0x58,0xcf,
+    0xd0,0xef,0xaa,0xfb,0x43,0x4d,0x33,0x85,0x45,0xf9,0x02,0x7f,0x50,0x3c,0x9f,0xa8,
+    0x51,0xa3,0x40,0x8f,0x92,0x9d,0x38,0xf5,0xbc,0xb6,0xda,0x21,0x10,0xff,0xf3,0xd2,
+    0xcd,0x0c,0x13,0xec,0x5f,0x97,0x44,0x17,0xc4,0xa7,0x7e,0x3d,0x64,0x5d,0x19,0x73,
+    0x60,0x81,0x4f,0xdc,0x22,0x2a,0x90,0x88,0x46,0xee,0xb8,0x14,0xde,0x5e,0x0b,0xdb,
+    0xe0,0x32,0x3a,0x0a,0x49,0x06,0x24,0x5c,0xc2,0xd3,0xac,0x62,0x91,0x95,0xe4,0x79,
+    0xe7,0xc8,0x37,0x6d,0x8d,0xd5,0x4e,0xa9,0x6c,0x56,0xf4,0xea,0x65,0x7a,0xae,0x08,
+    0xba,0x78,0x25,0x2e,0x1c,0xa6,0xb4,0xc6,0xe8,0xdd,0x74,0x1f,0x4b,0xbd,0x8b,0x8a,
+    0x70,0x3e,0xb5,0x66,0x48,0x03,0xf6,0x0e,0x61,0x35,0x57,0xb9,0x86,0xc1,0x1d,0x9e,
+    0xe1,0xf8,0x98,0x11,0x69,0xd9,0x8e,0x94,0x9b,0x1e,0x87,0xe9,0xce,0x55,0x28,0xdf,
+    0x8c,0xa1,0x89,0x0d,0xbf,0xe6,0x42,0x68,0x41,0x99,0x2d,0x0f,0xb0,0x54,0xbb,0x16,
+};
+
+constexpr std::uint8_t xtime(std::uint8_t x) {
+    return static_cast<std::uint8_t>((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+}
+
+constexpr std::uint32_t rotr(std::uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// Round tables: TE[k][x] is SubBytes, ShiftRows and MixColumns for byte x in row k of a column
+struct Tables {
+    std::uint32_t te[4][256];
+};
+
+constexpr Tables make_tables() {
+    Tables t{};
+    for (int x = 0; x < 256; ++x) {
+        const std::uint8_t s = SBOX[x];
+        const std::uint8_t s2 = xtime(s);
+        const std::uint8_t s3 = static_cast<std::uint8_t>(s2 ^ s);
+        const std::uint32_t w = (std::uint32_t{s2} << 24) | (std::uint32_t{s} << 16) | (std::uint32_t{s} << 8) | s3;
+        t.te[0][x] = w;
+        t.te[1][x] = rotr(w, 8);
+        t.te[2][x] = rotr(w, 16);
+        t.te[3][x] = rotr(w, 24);
+    }
+    return t;
+}
+
+constexpr Tables TABLES = make_tables();
+
+std::uint32_t load_be(const std::uint8_t* p) {
+    return (std::uint32_t{p[0]} << 24) | (std::uint32_t{p[1]} << 16) | (std::uint32_t{p[2]} << 8) | p[3];
+}
+
+void store_be(std::uint8_t* p, std::uint32_t x) {
+    p[0] = static_cast<std::uint8_t>(x >> 24);
+    p[1] = static_cast<std::uint8_t>(x >> 16);
+    p[2] = static_cast<std::uint8_t>(x >> 8);
+    p[3] = static_cast<std::uint8_t>(x);
+}
+
+void encrypt_table(const std::uint8_t* schedule, const std::uint8_t* in, std::uint8_t* out) {
+    const auto& te = TABLES.te;
+    std::uint32_t s[4], t[4];
+    for (int c = 0; c < 4; ++c) {
+        s[c] = load_be(in + 4 * c) ^ load_be(schedule + 4 * c);
+    }
+    for (std::size_t round = 1; round < Aes256::ROUNDS; ++round) {
+        const std::uint8_t* rk = schedule + 16 * round;
+        for (int c = 0; c < 4; ++c) {
+            t[c] = te[0][s[c] >> 24] ^ te[1][(s[(c + 1) & 3] >> 16) & 0xff] ^ te[2][(s[(c + 2) & 3] >> 8) & 0xff] ^
+                   te[3][s[(c + 3) & 3] & 0xff] ^ load_be(rk + 4 * c);
+        }
+        std::memcpy(s, t, sizeof(s));
+    }
+    // Last round: no MixColumns
+    const std::uint8_t* rk = schedule + 16 * Aes256::ROUNDS;
+    for (int c = 0; c < 4; ++c) {
+        const std::uint32_t w = (std::uint32_t{SBOX[s[c] >> 24]} << 24) | (std::uint32_t{SBOX[(s[(c + 1) & 3] >> 16) & 0xff]} << 16) |
+                                (std::uint32_t{SBOX[(s[(c + 2) & 3] >> 8) & 0xff]} << 8) | SBOX[s[(c + 3) & 3] & 0xff];
+        store_be(out + 4 * c, w ^ load_be(rk + 4 * c));
+    }
+}
+
+// Chosen on first use, so static objects elsewhere may already encrypt
+detail::BlockFunction blocks_function() {
+    static const detail::BlockFunction f = [] {
+        const detail::BlockFunction ni = detail::aes_ni_blocks();
+        return ni != nullptr ? ni : &detail::aes_table_blocks;
+    }();
+    return f;
+}
+
+void increment_be(std::uint8_t counter[Aes256::BLOCK_BYTES]) {
+    for (int j = Aes256::BLOCK_BYTES - 1; j >= 0; --j) {
+        if (++counter[j] != 0) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+GIOPHANTUS_CLONES void detail::aes_table_blocks(const std::uint8_t* schedule, const std::uint8_t* in, std::uint8_t* out, std::size_t blocks) {
+    for (std::size_t b = 0; b < blocks; ++b) {
+        encrypt_table(schedule, in + 16 * b, out + 16 * b);
+    }
+}
+
+bool aes_ni_available() {
+    return detail::aes_ni_blocks() != nullptr;
+}
+
+Aes256::Aes256(const std::uint8_t key[KEY_BYTES]) {
+    set_key(key);
+}
+
+// FIPS 197 Fig. 11 with Nk = 8
+void Aes256::set_key(const std::uint8_t key[KEY_BYTES]) {
+    static constexpr std::uint8_t RCON[7] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40};
+    std::memcpy(schedule, key, KEY_BYTES);
+    for (std::size_t i = KEY_BYTES; i < sizeof(schedule); i += 4) {
+        std::uint8_t w[4];
+        std::memcpy(w, schedule + i - 4, 4);
+        const std::size_t word = i / 4;
+        if (word % 8 == 0) {
+            const std::uint8_t first = w[0];
+            w[0] = static_cast<std::uint8_t>(SBOX[w[1]] ^ RCON[word / 8 - 1]);
+            w[1] = SBOX[w[2]];
+            w[2] = SBOX[w[3]];
+            w[3] = SBOX[first];
+        } else if (word % 8 == 4) {
+            for (std::uint8_t& b : w) {
+                b = SBOX[b];
+            }
+        }
+        for (int k = 0; k < 4; ++k) {
+            schedule[i + k] = static_cast<std::uint8_t>(schedule[i + k - KEY_BYTES] ^ w[k]);
+        }
+    }
+}
+
+void Aes256::encrypt_block(const std::uint8_t in[BLOCK_BYTES], std::uint8_t out[BLOCK_BYTES]) const {
+    blocks_function()(schedule, in, out, 1);
+}
+
+void Aes256::encrypt_blocks_portable(const std::uint8_t* in, std::uint8_t* out, std::size_t blocks) const {
+    detail::aes_table_blocks(schedule, in, out, blocks);
+}
+
+void Aes256::ctr_blocks(std::uint8_t counter[BLOCK_BYTES], std::uint8_t* out, std::size_t blocks) const {
+    for (std::size_t b = 0; b < blocks; ++b) {
+        increment_be(counter);
+        std::memcpy(out + BLOCK_BYTES * b, counter, BLOCK_BYTES);
+    }
+    blocks_function()(schedule, out, out, blocks);
+}
+
+} // namespace csprng
@@ -0,0 +1,29 @@
+// Block functions behind csprng::Aes256 and csprng::Aes256Gcm
+#ifndef GIOPHANTUS_AES_BACKEND_H
+#define GIOPHANTUS_AES_BACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace csprng::detail {
+
+// out = E(in) for blocks 16-byte blocks with the FIPS 197 expanded 256-bit key schedule;
+// in and out may be the same buffer
+using BlockFunction = void (*)(const std::uint8_t* schedule, const std::uint8_t* in, std::uint8_t* out, std::size_t blocks);
+
+void aes_table_blocks(const std::uint8_t* schedule, const std::uint8_t* in, std::uint8_t* out, std::size_t blocks);
+
+// nullptr when the translation unit was built without AES-NI support
+BlockFunction aes_ni_blocks();
+
+// GHASH: y = (y ^ block) * h in GF(2^128) for every 16-byte block, in the bit order of SP 800-38D
+using GhashFunction = void (*)(std::uint8_t y[16], const std::uint8_t h[16], const std::uint8_t* blocks, std::size_t count);
+
+void ghash_portable_blocks(std::uint8_t y[16], const std::uint8_t h[16], const std::uint8_t* blocks, std::size_t count);
+
+// nullptr when the translation unit was built without PCLMULQDQ support
+GhashFunction ghash_clmul_blocks();
+
+} // namespace csprng::detail
+
+#endif
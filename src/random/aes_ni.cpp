@@ -0,0 +1,67 @@
+// AES-256 blocks with AES-NI, eight blocks in flight to cover the aesenc latency
+#include "aes_backend.h"
+
+#if defined(__AES__) && defined(__SSE2__)
+#include <immintrin.h>
+
+namespace csprng::detail {
+
+namespace {
+
+void aes_ni_encrypt(const std::uint8_t* schedule, const std::uint8_t* in, std::uint8_t* out, std::size_t blocks) {
+    constexpr std::size_t ROUNDS = 14;
+    constexpr std::size_t WIDTH = 8;
+    __m128i rk[ROUNDS + 1];
+    for (std::size_t r = 0; r <= ROUNDS; ++r) {
+        rk[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(schedule + 16 * r));
+    }
+
+    std::size_t b = 0;
+    for (; b + WIDTH <= blocks; b += WIDTH) {
+        __m128i x[WIDTH];
+        for (std::size_t k = 0; k < WIDTH; ++k) {
+            x[k] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * (b + k))), rk[0]);
+        }
+        for (std::size_t r = 1; r < ROUNDS; ++r) {
+            for (std::size_t k = 0; k < WIDTH; ++k) {
+                x[k] = _mm_aesenc_si128(x[k], rk[r]);
+            }
+        }
+        for (std::size_t k = 0; k < WIDTH; ++k) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * (b + k)), _mm_aesenclast_si128(x[k], rk[ROUNDS]));
+        }
+    }
+    for (; b < blocks; ++b) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * b)), rk[0]);
+        for (std::size_t r = 1; r < ROUNDS; ++r) {
+            x = _mm_aesenc_si128(x, rk[r]);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * b), _mm_aesenclast_si128(x, rk[ROUNDS]));
+    }
+}
+
+} // namespace
+
+BlockFunction aes_ni_blocks() {
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("aes")) {
+        return nullptr;
+    }
+#endif
+    return &aes_ni_encrypt;
+}
+
+} // namespace csprng::detail
+
+#else
+
+namespace csprng::detail {
+
+BlockFunction aes_ni_blocks() {
+    return nullptr;
+}
+
+} // namespace csprng::detail
+
+#endif
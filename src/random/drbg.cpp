@@ -0,0 +1,57 @@
+// NIST AES-256 CTR DRBG (rng.c of the NIST submission package)
+#include "giophantus/random.h"
+
+#include <cstring>
+
+namespace csprng {
+
+CtrDrbg::CtrDrbg(const std::uint8_t entropy[SEED_BYTES], const std::uint8_t* personalization) {
+    std::uint8_t seed_material[SEED_BYTES];
+    std::memcpy(seed_material, entropy, SEED_BYTES);
+    if (personalization != nullptr) {
+        for (std::size_t i = 0; i < SEED_BYTES; ++i) {
+            seed_material[i] ^= personalization[i];
+        }
+    }
+    aes.set_key(key);
+    update(seed_material);
+    reseed_counter = 1;
+}
+
+// Key || V = E(V + 1) || E(V + 2) || E(V + 3), xored with the provided data
+void CtrDrbg::update(const std::uint8_t* provided) {
+    std::uint8_t temp[3 * Aes256::BLOCK_BYTES];
+    aes.ctr_blocks(v, temp, 3);
+    if (provided != nullptr) {
+        for (std::size_t i = 0; i < sizeof(temp); ++i) {
+            temp[i] ^= provided[i];
+        }
+    }
+    std::memcpy(key, temp, sizeof(key));
+    std::memcpy(v, temp + sizeof(key), sizeof(v));
+    aes.set_key(key);
+}
+
+void CtrDrbg::generate(std::uint8_t* out, std::size_t length) {
+    constexpr std::size_t CHUNK = 64;
+    std::uint8_t blocks[CHUNK * Aes256::BLOCK_BYTES];
+
+    while (length > 0) {
+        const std::size_t whole = length / Aes256::BLOCK_BYTES;
+        if (whole > 0) {
+            // Full blocks are encrypted straight into the output
+            const std::size_t count = whole < CHUNK ? whole : CHUNK;
+            aes.ctr_blocks(v, out, count);
+            out += count * Aes256::BLOCK_BYTES;
+            length -= count * Aes256::BLOCK_BYTES;
+        } else {
+            aes.ctr_blocks(v, blocks, 1);
+            std::memcpy(out, blocks, length);
+            length = 0;
+        }
+    }
+    update(nullptr);
+    ++reseed_counter;
+}
+
+} // namespace csprng
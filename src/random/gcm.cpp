@@ -0,0 +1,165 @@
+// AES-256-GCM over csprng::Aes256, with the bitwise GHASH and dispatch to PCLMULQDQ
+#include "giophantus/random.h"
+#include "aes_backend.h"
+#include "multiversion.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace csprng {
+
+namespace {
+
+std::uint64_t load_be64(const std::uint8_t* p) {
+    std::uint64_t x = 0;
+    for (int i = 0; i < 8; ++i) {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+void store_be64(std::uint8_t* p, std::uint64_t x) {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<std::uint8_t>(x);
+        x >>= 8;
+    }
+}
+
+detail::GhashFunction ghash_function() {
+    static const detail::GhashFunction f = [] {
+        const detail::GhashFunction clmul = detail::ghash_clmul_blocks();
+        return clmul != nullptr ? clmul : &detail::ghash_portable_blocks;
+    }();
+    return f;
+}
+
+// Absorbs length bytes, zero-padding the last block
+void ghash(detail::GhashFunction f, std::uint8_t y[16], const std::uint8_t h[16], const std::uint8_t* data, std::size_t length) {
+    const std::size_t whole = length / 16;
+    if (whole > 0) {
+        f(y, h, data, whole);
+    }
+    if (length % 16 != 0) {
+        std::uint8_t last[16] = {};
+        std::memcpy(last, data + 16 * whole, length % 16);
+        f(y, h, last, 1);
+    }
+}
+
+} // namespace
+
+// SP 800-38D Algorithm 1 on two 64-bit halves, x's bits taken most significant first; the
+// conditional xors are masks, so the time depends on neither h nor the data
+GIOPHANTUS_CLONES void detail::ghash_portable_blocks(std::uint8_t y[16], const std::uint8_t h[16], const std::uint8_t* blocks, std::size_t count) {
+    const std::uint64_t h_hi = load_be64(h);
+    const std::uint64_t h_lo = load_be64(h + 8);
+    std::uint64_t y_hi = load_be64(y);
+    std::uint64_t y_lo = load_be64(y + 8);
+
+    for (std::size_t b = 0; b < count; ++b) {
+        const std::uint64_t x[2] = {y_hi ^ load_be64(blocks + 16 * b), y_lo ^ load_be64(blocks + 16 * b + 8)};
+        std::uint64_t z_hi = 0, z_lo = 0;
+        std::uint64_t v_hi = h_hi, v_lo = h_lo;
+        for (int i = 0; i < 128; ++i) {
+            const std::uint64_t bit = 0 - ((x[i / 64] >> (63 - i % 64)) & 1);
+            z_hi ^= v_hi & bit;
+            z_lo ^= v_lo & bit;
+            const std::uint64_t carry = 0 - (v_lo & 1);
+            v_lo = (v_lo >> 1) | (v_hi << 63);
+            v_hi = (v_hi >> 1) ^ (carry & 0xe100000000000000ull);
+        }
+        y_hi = z_hi;
+        y_lo = z_lo;
+    }
+    store_be64(y, y_hi);
+    store_be64(y + 8, y_lo);
+}
+
+bool clmul_available() {
+    return detail::ghash_clmul_blocks() != nullptr;
+}
+
+Aes256Gcm::Aes256Gcm(const std::uint8_t key[KEY_BYTES]) {
+    set_key(key);
+}
+
+void Aes256Gcm::set_key(const std::uint8_t key[KEY_BYTES]) {
+    aes.set_key(key);
+    const std::uint8_t zero[Aes256::BLOCK_BYTES] = {};
+    aes.encrypt_block(zero, h);
+}
+
+// Counter blocks J0 + 1, J0 + 2, ... with J0 = nonce || 0^31 || 1
+void Aes256Gcm::ctr(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* in, std::uint8_t* out, std::size_t length) const {
+    constexpr std::size_t CHUNK = 64;
+    std::uint8_t counter[Aes256::BLOCK_BYTES] = {};
+    std::memcpy(counter, nonce, NONCE_BYTES);
+    counter[15] = 1;
+    std::uint8_t stream[CHUNK * Aes256::BLOCK_BYTES];
+
+    while (length > 0) {
+        const std::size_t needed = (length + Aes256::BLOCK_BYTES - 1) / Aes256::BLOCK_BYTES;
+        const std::size_t blocks = needed < CHUNK ? needed : CHUNK;
+        const std::size_t bytes = blocks * Aes256::BLOCK_BYTES < length ? blocks * Aes256::BLOCK_BYTES : length;
+        aes.ctr_blocks(counter, stream, blocks);
+        for (std::size_t i = 0; i < bytes; ++i) {
+            out[i] = static_cast<std::uint8_t>(in[i] ^ stream[i]);
+        }
+        in += bytes;
+        out += bytes;
+        length -= bytes;
+    }
+}
+
+void Aes256Gcm::compute_tag(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* aad, std::size_t aad_length,
+                            const std::uint8_t* ciphertext, std::size_t length, std::uint8_t tag[TAG_BYTES], bool portable) const {
+    const detail::GhashFunction f = portable ? &detail::ghash_portable_blocks : ghash_function();
+    std::uint8_t y[16] = {};
+    ghash(f, y, h, aad, aad_length);
+    ghash(f, y, h, ciphertext, length);
+    std::uint8_t lengths[16];
+    store_be64(lengths, static_cast<std::uint64_t>(aad_length) * 8);
+    store_be64(lengths + 8, static_cast<std::uint64_t>(length) * 8);
+    f(y, h, lengths, 1);
+
+    std::uint8_t j0[Aes256::BLOCK_BYTES] = {};
+    std::memcpy(j0, nonce, NONCE_BYTES);
+    j0[15] = 1;
+    std::uint8_t mask[Aes256::BLOCK_BYTES];
+    aes.encrypt_block(j0, mask);
+    for (std::size_t i = 0; i < TAG_BYTES; ++i) {
+        tag[i] = static_cast<std::uint8_t>(y[i] ^ mask[i]);
+    }
+}
+
+void Aes256Gcm::seal(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* aad, std::size_t aad_length, const std::uint8_t* in,
+                     std::uint8_t* out, std::size_t length, std::uint8_t tag[TAG_BYTES]) const {
+    assert(length <= MAX_BYTES);
+    ctr(nonce, in, out, length);
+    compute_tag(nonce, aad, aad_length, out, length, tag, false);
+}
+
+bool Aes256Gcm::open(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* aad, std::size_t aad_length, const std::uint8_t* in,
+                     std::uint8_t* out, std::size_t length, const std::uint8_t tag[TAG_BYTES]) const {
+    if (length > MAX_BYTES) {
+        return false;
+    }
+    std::uint8_t expected[TAG_BYTES];
+    compute_tag(nonce, aad, aad_length, in, length, expected, false);
+    std::uint8_t difference = 0;
+    for (std::size_t i = 0; i < TAG_BYTES; ++i) {
+        difference |= static_cast<std::uint8_t>(expected[i] ^ tag[i]);
+    }
+    if (difference != 0) {
+        return false;
+    }
+    ctr(nonce, in, out, length);
+    return true;
+}
+
+void Aes256Gcm::tag_portable(const std::uint8_t nonce[NONCE_BYTES], const std::uint8_t* aad, std::size_t aad_length,
+                             const std::uint8_t* ciphertext, std::size_t length, std::uint8_t tag[TAG_BYTES]) const {
+    compute_tag(nonce, aad, aad_length, ciphertext, length, tag, true);
+}
+
+} // namespace csprng
@@ -0,0 +1,111 @@
+// GHASH with PCLMULQDQ, four blocks per reduction against h^4 .. h
+#include "aes_backend.h"
+
+#if defined(__PCLMUL__) && defined(__SSSE3__)
+#include <immintrin.h>
+
+namespace csprng::detail {
+
+namespace {
+
+// Blocks are byte-reversed into the reflected bit order the carry-less multiply expects
+inline __m128i load(const std::uint8_t* p) {
+    const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), reverse);
+}
+
+inline void store(std::uint8_t* p, __m128i x) {
+    const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_shuffle_epi8(x, reverse));
+}
+
+// 256-bit carry-less product; products of several pairs may be xored before one reduction
+inline void multiply(__m128i a, __m128i b, __m128i& lo, __m128i& hi) {
+    const __m128i low = _mm_clmulepi64_si128(a, b, 0x00);
+    const __m128i high = _mm_clmulepi64_si128(a, b, 0x11);
+    const __m128i middle = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+    lo = _mm_xor_si128(low, _mm_slli_si128(middle, 8));
+    hi = _mm_xor_si128(high, _mm_srli_si128(middle, 8));
+}
+
+// Shift left by one for the reflected order, then reduce modulo x^128 + x^7 + x^2 + x + 1
+// (Gueron and Kounavis, Intel carry-less multiplication white paper, Algorithm 5)
+inline __m128i reduce(__m128i lo, __m128i hi) {
+    __m128i carry_lo = _mm_srli_epi32(lo, 31);
+    __m128i carry_hi = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    const __m128i across = _mm_srli_si128(carry_lo, 12);
+    carry_hi = _mm_slli_si128(carry_hi, 4);
+    carry_lo = _mm_slli_si128(carry_lo, 4);
+    lo = _mm_or_si128(lo, carry_lo);
+    hi = _mm_or_si128(_mm_or_si128(hi, carry_hi), across);
+
+    __m128i a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+    const __m128i b = _mm_srli_si128(a, 4);
+    a = _mm_slli_si128(a, 12);
+    lo = _mm_xor_si128(lo, a);
+    __m128i c = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+    c = _mm_xor_si128(c, b);
+    lo = _mm_xor_si128(lo, c);
+    return _mm_xor_si128(hi, lo);
+}
+
+inline __m128i gf_mul(__m128i a, __m128i b) {
+    __m128i lo, hi;
+    multiply(a, b, lo, hi);
+    return reduce(lo, hi);
+}
+
+void ghash_clmul(std::uint8_t y[16], const std::uint8_t h[16], const std::uint8_t* blocks, std::size_t count) {
+    const __m128i h1 = load(h);
+    __m128i acc = load(y);
+    std::size_t b = 0;
+    if (count >= 4) {
+        const __m128i h2 = gf_mul(h1, h1);
+        const __m128i h3 = gf_mul(h2, h1);
+        const __m128i h4 = gf_mul(h3, h1);
+        for (; b + 4 <= count; b += 4) {
+            __m128i lo, hi, l, u;
+            multiply(_mm_xor_si128(acc, load(blocks + 16 * b)), h4, lo, hi);
+            multiply(load(blocks + 16 * (b + 1)), h3, l, u);
+            lo = _mm_xor_si128(lo, l);
+            hi = _mm_xor_si128(hi, u);
+            multiply(load(blocks + 16 * (b + 2)), h2, l, u);
+            lo = _mm_xor_si128(lo, l);
+            hi = _mm_xor_si128(hi, u);
+            multiply(load(blocks + 16 * (b + 3)), h1, l, u);
+            acc = reduce(_mm_xor_si128(lo, l), _mm_xor_si128(hi, u));
+        }
+    }
+    for (; b < count; ++b) {
+        acc = gf_mul(_mm_xor_si128(acc, load(blocks + 16 * b)), h1);
+    }
+    store(y, acc);
+}
+
+} // namespace
+
+GhashFunction ghash_clmul_blocks() {
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("pclmul") || !__builtin_cpu_supports("ssse3")) {
+        return nullptr;
+    }
+#endif
+    return &ghash_clmul;
+}
+
+} // namespace csprng::detail
+
+#else
+
+namespace csprng::detail {
+
+GhashFunction ghash_clmul_blocks() {
+    return nullptr;
+}
+
+} // namespace csprng::detail
+
+#endif
@@ -0,0 +1,93 @@
+// Keccak-f[1600] and SHAKE256 (sha3.c / seedexpand.c of the reference implementation)
+#include "giophantus/random.h"
+#include "multiversion.h"
+
+namespace csprng {
+
+namespace {
+
+constexpr std::uint64_t ROUND_CONSTANTS[24] = {
+    0x0000000000000001ull, 0x0000000000008082ull, 0x800000000000808aull, 0x8000000080008000ull,
+    0x000000000000808bull, 0x0000000080000001ull, 0x8000000080008081ull, 0x8000000000008009ull,
+    0x000000000000008aull, 0x0000000000000088ull, 0x0000000080008009ull, 0x000000008000000aull,
+    0x000000008000808bull, 0x800000000000008bull, 0x8000000000008089ull, 0x8000000000008003ull,
+    0x8000000000008002ull, 0x8000000000000080ull, 0x000000000000800aull, 0x800000008000000aull,
+    0x8000000080008081ull, 0x8000000000008080ull, 0x0000000080000001ull, 0x8000000080008008ull,
+};
+
+// rho offsets and pi destinations, lane by lane
+constexpr int ROTATIONS[25] = {0, 1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43, 25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14};
+
+constexpr std::uint64_t rol(std::uint64_t x, int n) {
+    return n == 0 ? x : (x << n) | (x >> (64 - n));
+}
+
+} // namespace
+
+GIOPHANTUS_CLONES void keccak_f1600(std::uint64_t a[25]) {
+    std::uint64_t b[25], c[5], d[5];
+
+    for (std::uint64_t rc : ROUND_CONSTANTS) {
+        for (int x = 0; x < 5; ++x) {
+            c[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];
+        }
+        for (int x = 0; x < 5; ++x) {
+            d[x] = c[(x + 4) % 5] ^ rol(c[(x + 1) % 5], 1);
+        }
+        // theta, rho and pi: lane (x, y) moves to (y, 2x + 3y)
+        for (int y = 0; y < 5; ++y) {
+            for (int x = 0; x < 5; ++x) {
+                b[y + 5 * ((2 * x + 3 * y) % 5)] = rol(a[x + 5 * y] ^ d[x], ROTATIONS[x + 5 * y]);
+            }
+        }
+        // chi
+        for (int y = 0; y < 25; y += 5) {
+            for (int x = 0; x < 5; ++x) {
+                a[y + x] = b[y + x] ^ (~b[y + (x + 1) % 5] & b[y + (x + 2) % 5]);
+            }
+        }
+        // iota
+        a[0] ^= rc;
+    }
+}
+
+Shake256::Shake256(const std::uint8_t* seed, std::size_t length) {
+    auto absorb = [this](std::size_t i, std::uint8_t value) { state[i / 8] ^= std::uint64_t{value} << (8 * (i % 8)); };
+
+    while (length >= RATE) {
+        for (std::size_t i = 0; i < RATE; ++i) {
+            absorb(i, seed[i]);
+        }
+        keccak_f1600(state);
+        seed += RATE;
+        length -= RATE;
+    }
+    for (std::size_t i = 0; i < length; ++i) {
+        absorb(i, seed[i]);
+    }
+    absorb(length, 0x1f);
+    absorb(RATE - 1, 0x80);
+    keccak_f1600(state);
+}
+
+void Shake256::squeeze(std::uint8_t* out, std::size_t length) {
+    while (length > 0) {
+        if (position == RATE) {
+            keccak_f1600(state);
+            position = 0;
+        }
+        const std::size_t take = length < RATE - position ? length : RATE - position;
+        for (std::size_t i = 0; i < take; ++i) {
+            out[i] = byte(position + i);
+        }
+        out += take;
+        length -= take;
+        position += take;
+    }
+}
+
+void shake256(std::uint8_t* out, std::size_t out_length, const std::uint8_t* in, std::size_t in_length) {
+    Shake256(in, in_length).squeeze(out, out_length);
+}
+
+} // namespace csprng
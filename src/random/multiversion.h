@@ -0,0 +1,14 @@
+// Function multiversioning for the portable primitives: with GIOPHANTUS_TARGET_CLONES (set by
+// CMake where the toolchain and the loader support it) the compiler emits one clone per x86-64
+// microarchitecture level and an ifunc resolver picks one at load time, so a generic build still
+// runs keccak_f1600 with BMI's andn and rorx on machines that have them.
+#ifndef GIOPHANTUS_RANDOM_MULTIVERSION_H
+#define GIOPHANTUS_RANDOM_MULTIVERSION_H
+
+#if defined(GIOPHANTUS_TARGET_CLONES)
+#define GIOPHANTUS_CLONES __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "arch=x86-64-v2", "default")))
+#else
+#define GIOPHANTUS_CLONES
+#endif
+
+#endif
@@ -0,0 +1,78 @@
+// Storage of ParamRegistry and the built-in IEC entries
+#include "giophantus/registry.h"
+
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+namespace giophantus {
+
+namespace {
+
+// A deque keeps entries in place as it grows
+struct Registry {
+    std::mutex mutex;
+    std::deque<ParameterSetInfo> entries{describe_parameter_set<IEC602>("IEC602"), describe_parameter_set<IEC868>("IEC868"),
+                                         describe_parameter_set<IEC1134>("IEC1134")};
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+template <class Match>
+const ParameterSetInfo* find_if(Match match) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const ParameterSetInfo& info : r.entries) {
+        if (match(info)) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+bool ParamRegistry::add(const ParameterSetInfo& info) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const ParameterSetInfo& existing : r.entries) {
+        if (std::strcmp(existing.name, info.name) == 0) {
+            return false;
+        }
+    }
+    r.entries.push_back(info);
+    return true;
+}
+
+const ParameterSetInfo* ParamRegistry::find(std::string_view name) {
+    return find_if([&](const ParameterSetInfo& info) { return name == info.name; });
+}
+
+const ParameterSetInfo* ParamRegistry::find_by_public_key(std::size_t public_key_bytes) {
+    return find_if([&](const ParameterSetInfo& info) { return info.public_key_bytes == public_key_bytes; });
+}
+
+const ParameterSetInfo* ParamRegistry::find_by_secret_key(std::size_t secret_key_bytes) {
+    return find_if([&](const ParameterSetInfo& info) { return info.secret_key_bytes == secret_key_bytes; });
+}
+
+std::vector<const ParameterSetInfo*> ParamRegistry::all() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<const ParameterSetInfo*> out;
+    for (const ParameterSetInfo& info : r.entries) {
+        out.push_back(&info);
+    }
+    return out;
+}
+
+void ParamRegistry::prepare_all() {
+    for (const ParameterSetInfo* info : all()) {
+        info->prepare();
+    }
+}
+
+} // namespace giophantus
@@ -0,0 +1,53 @@
+// AVX2 kernels (8 lanes); built with -mavx2
+#include "backends.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+struct Ops {
+    static constexpr std::size_t lanes = 8;
+    using vec = __m256i;
+
+    static vec load(const std::uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(std::uint32_t* p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static vec set1(std::uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+    static vec sub(vec a, vec b) { return _mm256_sub_epi32(a, b); }
+    static vec min(vec a, vec b) { return _mm256_min_epu32(a, b); }
+    static vec mullo(vec a, vec b) { return _mm256_mullo_epi32(a, b); }
+
+    // High words of the even-lane products already sit in place once shifted down; the
+    // odd-lane products keep theirs in the upper half of each 64-bit slot.
+    static vec mulhi(vec a, vec b) {
+        const vec even = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+        const vec odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        return _mm256_blend_epi32(even, odd, 0xaa);
+    }
+
+    static constexpr std::size_t wide_lanes = 4;
+    static void mac_wide(std::uint64_t* acc, const std::uint32_t* a, std::uint32_t s) {
+        const __m256i product =
+            _mm256_mul_epu32(_mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a))), _mm256_set1_epi64x(s));
+        const __m256i sum = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc)), product);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), sum);
+    }
+};
+
+#include "kernels.inl"
+
+} // namespace
+
+const simd::Kernels* simd::detail::avx2_kernels() {
+    static const Kernels table = KernelLoops<Ops>::table(Backend::Avx2, "avx2");
+    return &table;
+}
+
+#else
+
+const simd::Kernels* simd::detail::avx2_kernels() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,52 @@
+// AVX-512 kernels (16 lanes); built with -mavx512f
+#include "backends.h"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+namespace {
+
+struct Ops {
+    static constexpr std::size_t lanes = 16;
+    using vec = __m512i;
+
+    static vec load(const std::uint32_t* p) { return _mm512_loadu_si512(p); }
+    static void store(std::uint32_t* p, vec v) { _mm512_storeu_si512(p, v); }
+    static vec set1(std::uint32_t x) { return _mm512_set1_epi32(static_cast<int>(x)); }
+    static vec add(vec a, vec b) { return _mm512_add_epi32(a, b); }
+    static vec sub(vec a, vec b) { return _mm512_sub_epi32(a, b); }
+    static vec min(vec a, vec b) { return _mm512_min_epu32(a, b); }
+    static vec mullo(vec a, vec b) { return _mm512_mullo_epi32(a, b); }
+
+    // High words of the even-lane products already sit in place once shifted down; the
+    // odd-lane products keep theirs in the upper half of each 64-bit slot.
+    static vec mulhi(vec a, vec b) {
+        const vec even = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+        const vec odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+        return _mm512_mask_blend_epi32(0xaaaa, even, odd);
+    }
+
+    static constexpr std::size_t wide_lanes = 8;
+    static void mac_wide(std::uint64_t* acc, const std::uint32_t* a, std::uint32_t s) {
+        const __m512i product =
+            _mm512_mul_epu32(_mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a))), _mm512_set1_epi64(s));
+        _mm512_storeu_si512(acc, _mm512_add_epi64(_mm512_loadu_si512(acc), product));
+    }
+};
+
+#include "kernels.inl"
+
+} // namespace
+
+const simd::Kernels* simd::detail::avx512_kernels() {
+    static const Kernels table = KernelLoops<Ops>::table(Backend::Avx512, "avx512");
+    return &table;
+}
+
+#else
+
+const simd::Kernels* simd::detail::avx512_kernels() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,18 @@
+// Per-instruction-set kernel tables; each returns nullptr when its translation unit was
+// built without the matching compiler support.
+#ifndef GIOPHANTUS_SIMD_BACKENDS_H
+#define GIOPHANTUS_SIMD_BACKENDS_H
+
+#include "giophantus/simd.h"
+
+namespace simd::detail {
+
+const Kernels* scalar_kernels();
+const Kernels* sse42_kernels();
+const Kernels* avx2_kernels();
+const Kernels* avx512_kernels();
+const Kernels* neon_kernels();
+
+} // namespace simd::detail
+
+#endif
@@ -0,0 +1,263 @@
+// Generic kernel loops, instantiated once per instruction set.
+//
+// Each backend translation unit is compiled with its own -m flags, defines its vector
+// operations `struct Ops` and then includes this file, all inside one anonymous namespace:
+// nothing here may have external linkage, or the linker could merge an AVX-512 copy of an
+// inline function into code that runs on a CPU without it. For the same reason only plain
+// loops are used, no standard library templates.
+//
+// Ops provides: lanes, vec, load, store, set1, add, sub, min (unsigned), mullo, mulhi, and
+// wide_lanes with mac_wide, which adds wide_lanes widened products into 64-bit accumulators.
+// Residues stay below 2^31, so x - q or x + q wrapping past 2^32 is picked apart with an
+// unsigned min: exactly one of the two candidates is in [0, q).
+
+struct ScalarOps {
+    static constexpr std::size_t lanes = 1;
+    using vec = std::uint32_t;
+
+    static vec load(const std::uint32_t* p) { return *p; }
+    static void store(std::uint32_t* p, vec v) { *p = v; }
+    static vec set1(std::uint32_t x) { return x; }
+    static vec add(vec a, vec b) { return a + b; }
+    static vec sub(vec a, vec b) { return a - b; }
+#if GIOPHANTUS_CONSTANT_TIME
+    // Selection through a mask the optimizer cannot see into (vector min instructions are branch-free)
+    static vec min(vec a, vec b) {
+        std::uint32_t mask = 0u - static_cast<std::uint32_t>(a < b);
+#if defined(__GNUC__)
+        asm("" : "+r"(mask));
+#endif
+        return b ^ ((a ^ b) & mask);
+    }
+#else
+    static vec min(vec a, vec b) { return a < b ? a : b; }
+#endif
+    static vec mullo(vec a, vec b) { return a * b; }
+    static vec mulhi(vec a, vec b) { return static_cast<std::uint32_t>((static_cast<std::uint64_t>(a) * b) >> 32); }
+
+    static constexpr std::size_t wide_lanes = 1;
+    static void mac_wide(std::uint64_t* acc, const std::uint32_t* a, std::uint32_t s) {
+        *acc += static_cast<std::uint64_t>(*a) * s;
+    }
+};
+
+// floor(s * 2^32 / q) for s < q. The latency of a hardware divide can depend on a secret s, so
+// the constant-time build divides the public q only: x * floor(2^64 / q) / 2^64 undershoots
+// floor(x / q) by at most one, settled with a mask. Without 128-bit products a branch-free
+// restoring division does it.
+inline std::uint32_t shoup_precompute(std::uint32_t s, std::uint32_t q) {
+#if GIOPHANTUS_CONSTANT_TIME && defined(__SIZEOF_INT128__)
+    const std::uint64_t x = static_cast<std::uint64_t>(s) << 32;
+    const std::uint64_t reciprocal = ~std::uint64_t{0} / q;
+    std::uint64_t quotient = static_cast<std::uint64_t>((static_cast<unsigned __int128>(x) * reciprocal) >> 64);
+    const std::uint64_t r = x - quotient * q;
+    quotient += 1 ^ ((r - q) >> 63);
+    return static_cast<std::uint32_t>(quotient);
+#elif GIOPHANTUS_CONSTANT_TIME
+    std::uint64_t r = s;
+    std::uint32_t quotient = 0;
+    for (int bit = 31; bit >= 0; --bit) {
+        r <<= 1;
+        const std::uint64_t t = r - q;
+        const std::uint64_t take = 1 ^ (t >> 63);
+        r = t + (q & (take - 1));
+        quotient |= static_cast<std::uint32_t>(take) << bit;
+    }
+    return quotient;
+#else
+    return static_cast<std::uint32_t>((static_cast<std::uint64_t>(s) << 32) / q);
+#endif
+}
+
+template <class V>
+struct KernelLoops {
+    using vec = typename V::vec;
+
+    static vec add_mod(vec a, vec b, vec q) {
+        const vec s = V::add(a, b);
+        return V::min(s, V::sub(s, q));
+    }
+
+    static vec sub_mod(vec a, vec b, vec q) {
+        const vec d = V::sub(a, b);
+        return V::min(d, V::add(d, q));
+    }
+
+    // Shoup multiplication by a fixed s with sp = floor(s * 2^32 / q): a * s - hi(a * sp) * q < 2q
+    static vec shoup_mul(vec a, vec s, vec sp, vec q) {
+        const vec r = V::sub(V::mullo(a, s), V::mullo(V::mulhi(a, sp), q));
+        return V::min(r, V::sub(r, q));
+    }
+
+    // Signed-difference Montgomery reduction: (a * b - m * q) / 2^32 with m = lo(a * b) * q^-1,
+    // exact because both products agree in the low word; the result lies in (-q, q).
+    static vec mont_mul(vec a, vec b, vec q, vec qinv_pos) {
+        const vec m = V::mullo(V::mullo(a, b), qinv_pos);
+        const vec u = V::sub(V::mulhi(a, b), V::mulhi(m, q));
+        return V::min(u, V::add(u, q));
+    }
+
+    static void add(std::uint32_t* c, const std::uint32_t* a, const std::uint32_t* b, std::size_t n, std::uint32_t q) {
+        const vec vq = V::set1(q);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            V::store(c + i, add_mod(V::load(a + i), V::load(b + i), vq));
+        }
+        for (; i < n; ++i) {
+            c[i] = KernelLoops<ScalarOps>::add_mod(a[i], b[i], q);
+        }
+    }
+
+    static void sub(std::uint32_t* c, const std::uint32_t* a, const std::uint32_t* b, std::size_t n, std::uint32_t q) {
+        const vec vq = V::set1(q);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            V::store(c + i, sub_mod(V::load(a + i), V::load(b + i), vq));
+        }
+        for (; i < n; ++i) {
+            c[i] = KernelLoops<ScalarOps>::sub_mod(a[i], b[i], q);
+        }
+    }
+
+    static void scalar_mul(std::uint32_t* c, const std::uint32_t* a, std::uint32_t s, std::size_t n, std::uint32_t q) {
+        const std::uint32_t sp = shoup_precompute(s, q);
+        const vec vq = V::set1(q), vs = V::set1(s), vsp = V::set1(sp);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            V::store(c + i, shoup_mul(V::load(a + i), vs, vsp, vq));
+        }
+        for (; i < n; ++i) {
+            c[i] = KernelLoops<ScalarOps>::shoup_mul(a[i], s, sp, q);
+        }
+    }
+
+    static void scalar_mul_acc(std::uint32_t* acc, const std::uint32_t* a, std::uint32_t s, std::size_t n, std::uint32_t q) {
+        const std::uint32_t sp = shoup_precompute(s, q);
+        const vec vq = V::set1(q), vs = V::set1(s), vsp = V::set1(sp);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            V::store(acc + i, add_mod(V::load(acc + i), shoup_mul(V::load(a + i), vs, vsp, vq), vq));
+        }
+        for (; i < n; ++i) {
+            acc[i] = KernelLoops<ScalarOps>::add_mod(acc[i], KernelLoops<ScalarOps>::shoup_mul(a[i], s, sp, q), q);
+        }
+    }
+
+    static void mul_acc_wide(std::uint64_t* acc, const std::uint32_t* a, std::uint32_t s, std::size_t n) {
+        std::size_t i = 0;
+        for (; i + V::wide_lanes <= n; i += V::wide_lanes) {
+            V::mac_wide(acc + i, a + i, s);
+        }
+        for (; i < n; ++i) {
+            ScalarOps::mac_wide(acc + i, a + i, s);
+        }
+    }
+
+    // floor(a / l) from hi(a * (floor(2^32 / l) + 1)) is exact or one too large for a < 2^31
+    static void reduce(std::uint32_t* a, std::size_t n, std::uint32_t l) {
+        const std::uint32_t magic = static_cast<std::uint32_t>((std::uint64_t{1} << 32) / l + 1);
+        const vec vl = V::set1(l), vmagic = V::set1(magic);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            const vec x = V::load(a + i);
+            const vec r = V::sub(x, V::mullo(V::mulhi(x, vmagic), vl));
+            V::store(a + i, V::min(r, V::add(r, vl)));
+        }
+        for (; i < n; ++i) {
+            const std::uint32_t r = a[i] - ScalarOps::mulhi(a[i], magic) * l;
+            a[i] = ScalarOps::min(r, r + l);
+        }
+    }
+
+    static void mont_mul_n(std::uint32_t* c, const std::uint32_t* a, const std::uint32_t* b, std::size_t n, simd::Modulus m) {
+        const std::uint32_t qinv_pos = 0u - m.qinv;
+        const vec vq = V::set1(m.q), vqinv = V::set1(qinv_pos);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            V::store(c + i, mont_mul(V::load(a + i), V::load(b + i), vq, vqinv));
+        }
+        for (; i < n; ++i) {
+            c[i] = KernelLoops<ScalarOps>::mont_mul(a[i], b[i], m.q, qinv_pos);
+        }
+    }
+
+    static void mont_mul_acc(std::uint32_t* acc, const std::uint32_t* a, const std::uint32_t* b, std::size_t n, simd::Modulus m) {
+        const std::uint32_t qinv_pos = 0u - m.qinv;
+        const vec vq = V::set1(m.q), vqinv = V::set1(qinv_pos);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            const vec p = mont_mul(V::load(a + i), V::load(b + i), vq, vqinv);
+            V::store(acc + i, add_mod(V::load(acc + i), p, vq));
+        }
+        for (; i < n; ++i) {
+            const std::uint32_t p = KernelLoops<ScalarOps>::mont_mul(a[i], b[i], m.q, qinv_pos);
+            acc[i] = KernelLoops<ScalarOps>::add_mod(acc[i], p, m.q);
+        }
+    }
+
+    static void mont_scale(std::uint32_t* c, const std::uint32_t* a, std::uint32_t s, std::size_t n, simd::Modulus m) {
+        const std::uint32_t qinv_pos = 0u - m.qinv;
+        const vec vq = V::set1(m.q), vqinv = V::set1(qinv_pos), vs = V::set1(s);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            V::store(c + i, mont_mul(V::load(a + i), vs, vq, vqinv));
+        }
+        for (; i < n; ++i) {
+            c[i] = KernelLoops<ScalarOps>::mont_mul(a[i], s, m.q, qinv_pos);
+        }
+    }
+
+    static void dif_butterflies(std::uint32_t* x, std::uint32_t* y, const std::uint32_t* w, std::size_t n, simd::Modulus m) {
+        const std::uint32_t qinv_pos = 0u - m.qinv;
+        const vec vq = V::set1(m.q), vqinv = V::set1(qinv_pos);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            const vec u = V::load(x + i), v = V::load(y + i);
+            V::store(x + i, add_mod(u, v, vq));
+            V::store(y + i, mont_mul(sub_mod(u, v, vq), V::load(w + i), vq, vqinv));
+        }
+        for (; i < n; ++i) {
+            using S = KernelLoops<ScalarOps>;
+            const std::uint32_t u = x[i], v = y[i];
+            x[i] = S::add_mod(u, v, m.q);
+            y[i] = S::mont_mul(S::sub_mod(u, v, m.q), w[i], m.q, qinv_pos);
+        }
+    }
+
+    static void dit_butterflies(std::uint32_t* x, std::uint32_t* y, const std::uint32_t* w, std::size_t n, simd::Modulus m) {
+        const std::uint32_t qinv_pos = 0u - m.qinv;
+        const vec vq = V::set1(m.q), vqinv = V::set1(qinv_pos);
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            const vec u = V::load(x + i);
+            const vec v = mont_mul(V::load(y + i), V::load(w + i), vq, vqinv);
+            V::store(x + i, add_mod(u, v, vq));
+            V::store(y + i, sub_mod(u, v, vq));
+        }
+        for (; i < n; ++i) {
+            using S = KernelLoops<ScalarOps>;
+            const std::uint32_t u = x[i];
+            const std::uint32_t v = S::mont_mul(y[i], w[i], m.q, qinv_pos);
+            x[i] = S::add_mod(u, v, m.q);
+            y[i] = S::sub_mod(u, v, m.q);
+        }
+    }
+
+    static simd::Kernels table(simd::Backend backend, const char* name) {
+        return {
+            backend,
+            name,
+            &add,
+            &sub,
+            &scalar_mul,
+            &scalar_mul_acc,
+            &mul_acc_wide,
+            &reduce,
+            &mont_mul_n,
+            &mont_mul_acc,
+            &mont_scale,
+            &dif_butterflies,
+            &dit_butterflies,
+        };
+    }
+};
@@ -0,0 +1,49 @@
+// NEON kernels (4 lanes) for AArch64, where Advanced SIMD is part of the base ISA
+#include "backends.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+
+namespace {
+
+struct Ops {
+    static constexpr std::size_t lanes = 4;
+    using vec = uint32x4_t;
+
+    static vec load(const std::uint32_t* p) { return vld1q_u32(p); }
+    static void store(std::uint32_t* p, vec v) { vst1q_u32(p, v); }
+    static vec set1(std::uint32_t x) { return vdupq_n_u32(x); }
+    static vec add(vec a, vec b) { return vaddq_u32(a, b); }
+    static vec sub(vec a, vec b) { return vsubq_u32(a, b); }
+    static vec min(vec a, vec b) { return vminq_u32(a, b); }
+    static vec mullo(vec a, vec b) { return vmulq_u32(a, b); }
+
+    // Widening products of the low and high lane pairs, then keep the odd (upper) words
+    static vec mulhi(vec a, vec b) {
+        const uint64x2_t low = vmull_u32(vget_low_u32(a), vget_low_u32(b));
+        const uint64x2_t high = vmull_high_u32(a, b);
+        return vuzp2q_u32(vreinterpretq_u32_u64(low), vreinterpretq_u32_u64(high));
+    }
+
+    static constexpr std::size_t wide_lanes = 2;
+    static void mac_wide(std::uint64_t* acc, const std::uint32_t* a, std::uint32_t s) {
+        vst1q_u64(acc, vmlal_u32(vld1q_u64(acc), vld1_u32(a), vdup_n_u32(s)));
+    }
+};
+
+#include "kernels.inl"
+
+} // namespace
+
+const simd::Kernels* simd::detail::neon_kernels() {
+    static const Kernels table = KernelLoops<Ops>::table(Backend::Neon, "neon");
+    return &table;
+}
+
+#else
+
+const simd::Kernels* simd::detail::neon_kernels() {
+    return nullptr;
+}
+
+#endif
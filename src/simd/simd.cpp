@@ -0,0 +1,95 @@
+// Kernel dispatch and the portable scalar backend
+#include "backends.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+namespace {
+
+#include "kernels.inl"
+
+bool cpu_supports(simd::Backend backend) {
+    switch (backend) {
+    case simd::Backend::Scalar:
+        return true;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    case simd::Backend::Sse42:
+        return __builtin_cpu_supports("sse4.2");
+    case simd::Backend::Avx2:
+        return __builtin_cpu_supports("avx2");
+    case simd::Backend::Avx512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+#if defined(__aarch64__)
+    case simd::Backend::Neon:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+const simd::Kernels* compiled(simd::Backend backend) {
+    switch (backend) {
+    case simd::Backend::Scalar:
+        return simd::detail::scalar_kernels();
+    case simd::Backend::Sse42:
+        return simd::detail::sse42_kernels();
+    case simd::Backend::Avx2:
+        return simd::detail::avx2_kernels();
+    case simd::Backend::Avx512:
+        return simd::detail::avx512_kernels();
+    case simd::Backend::Neon:
+        return simd::detail::neon_kernels();
+    }
+    return nullptr;
+}
+
+const simd::Kernels* startup_kernels() {
+    if (const char* forced = std::getenv("GIOPHANTUS_SIMD")) {
+        for (simd::Backend backend : {simd::Backend::Scalar, simd::Backend::Sse42, simd::Backend::Avx2,
+                                      simd::Backend::Avx512, simd::Backend::Neon}) {
+            const simd::Kernels* table = simd::find(backend);
+            if (table != nullptr && std::strcmp(table->name, forced) == 0) {
+                return table;
+            }
+        }
+    }
+    for (simd::Backend backend : {simd::Backend::Avx512, simd::Backend::Avx2, simd::Backend::Neon, simd::Backend::Sse42}) {
+        if (const simd::Kernels* table = simd::find(backend)) {
+            return table;
+        }
+    }
+    return simd::detail::scalar_kernels();
+}
+
+std::atomic<const simd::Kernels*>& active() {
+    static std::atomic<const simd::Kernels*> table{startup_kernels()};
+    return table;
+}
+
+} // namespace
+
+const simd::Kernels* simd::detail::scalar_kernels() {
+    static const Kernels table = KernelLoops<ScalarOps>::table(Backend::Scalar, "scalar");
+    return &table;
+}
+
+const simd::Kernels& simd::kernels() {
+    return *active().load(std::memory_order_relaxed);
+}
+
+const simd::Kernels* simd::find(Backend backend) {
+    return cpu_supports(backend) ? compiled(backend) : nullptr;
+}
+
+bool simd::select(Backend backend) {
+    const Kernels* table = find(backend);
+    if (table == nullptr) {
+        return false;
+    }
+    active().store(table, std::memory_order_relaxed);
+    return true;
+}
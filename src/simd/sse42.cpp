@@ -0,0 +1,52 @@
+// SSE4.2 kernels (4 lanes); built with -msse4.2
+#include "backends.h"
+
+#if defined(__SSE4_2__)
+#include <immintrin.h>
+
+namespace {
+
+struct Ops {
+    static constexpr std::size_t lanes = 4;
+    using vec = __m128i;
+
+    static vec load(const std::uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(std::uint32_t* p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static vec set1(std::uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+    static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+    static vec sub(vec a, vec b) { return _mm_sub_epi32(a, b); }
+    static vec min(vec a, vec b) { return _mm_min_epu32(a, b); }
+    static vec mullo(vec a, vec b) { return _mm_mullo_epi32(a, b); }
+
+    // High words of the even-lane products already sit in place once shifted down; the
+    // odd-lane products keep theirs in the upper half of each 64-bit slot.
+    static vec mulhi(vec a, vec b) {
+        const vec even = _mm_srli_epi64(_mm_mul_epu32(a, b), 32);
+        const vec odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_blend_epi16(even, odd, 0xcc);
+    }
+
+    static constexpr std::size_t wide_lanes = 2;
+    static void mac_wide(std::uint64_t* acc, const std::uint32_t* a, std::uint32_t s) {
+        const __m128i product = _mm_mul_epu32(_mm_cvtepu32_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a))), _mm_set1_epi64x(s));
+        const __m128i sum = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(acc)), product);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc), sum);
+    }
+};
+
+#include "kernels.inl"
+
+} // namespace
+
+const simd::Kernels* simd::detail::sse42_kernels() {
+    static const Kernels table = KernelLoops<Ops>::table(Backend::Sse42, "sse4.2");
+    return &table;
+}
+
+#else
+
+const simd::Kernels* simd::detail::sse42_kernels() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,284 @@
+// Chunk pipeline and header helpers of the hybrid streams
+#include "giophantus/stream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace giophantus {
+
+namespace {
+
+constexpr std::size_t TAG_BYTES = csprng::Aes256Gcm::TAG_BYTES;
+constexpr std::uint64_t MAX_CHUNKS = std::uint64_t{1} << 32;
+
+void store_le32(std::uint8_t* p, std::uint32_t x) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<std::uint8_t>(x >> (8 * i));
+    }
+}
+
+std::uint32_t load_le32(const std::uint8_t* p) {
+    return std::uint32_t{p[0]} | (std::uint32_t{p[1]} << 8) | (std::uint32_t{p[2]} << 16) | (std::uint32_t{p[3]} << 24);
+}
+
+// Buffer indices handed between stages; close() wakes and fails every pop
+class Channel {
+public:
+    void push(int index) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(index);
+        }
+        ready.notify_one();
+    }
+
+    // -1 once closed
+    int pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&] { return closed || !queue.empty(); });
+        if (closed) {
+            return -1;
+        }
+        const int index = queue.front();
+        queue.pop_front();
+        return index;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<int> queue;
+    bool closed = false;
+};
+
+// free -> reader -> filled -> caller (seal or open in place) -> done -> writer -> free
+class Pipeline {
+public:
+    static constexpr int BUFFERS = 3;
+
+    struct Buffer {
+        std::vector<std::uint8_t> bytes;
+        std::size_t length = 0;
+        bool last = false;
+    };
+
+    // capacity: bytes read per chunk; every buffer holds capacity + TAG_BYTES
+    explicit Pipeline(std::size_t capacity) : capacity(capacity) {
+        for (int i = 0; i < BUFFERS; ++i) {
+            buffers[i].bytes.resize(capacity + TAG_BYTES);
+            free.push(i);
+        }
+    }
+
+    // transform(buffer, chunk index) runs on the calling thread and returns Ok to pass the
+    // buffer on to the writer
+    template <class Transform>
+    StreamStatus run(const StreamReader& in, const StreamWriter& out, Transform transform) {
+        std::thread reader([&] { read_loop(in); });
+        std::thread writer([&] { write_loop(out); });
+        for (std::uint64_t k = 0;; ++k) {
+            const int index = filled.pop();
+            if (index < 0) {
+                break;
+            }
+            Buffer& b = buffers[index];
+            const StreamStatus s = k < MAX_CHUNKS ? transform(b, k) : StreamStatus::TooLong;
+            if (s != StreamStatus::Ok) {
+                fail(s);
+                break;
+            }
+            // Once pushed the buffer belongs to the writer, and then to the reader again
+            const bool last = b.last;
+            done.push(index);
+            if (last) {
+                break;
+            }
+        }
+        reader.join();
+        writer.join();
+        return status.load();
+    }
+
+private:
+    std::size_t capacity;
+    Buffer buffers[BUFFERS];
+    Channel free, filled, done;
+    std::atomic<StreamStatus> status{StreamStatus::Ok};
+
+    // The first failure wins and stops every stage
+    void fail(StreamStatus s) {
+        StreamStatus expected = StreamStatus::Ok;
+        status.compare_exchange_strong(expected, s);
+        free.close();
+        filled.close();
+        done.close();
+    }
+
+    void read_loop(const StreamReader& in) {
+        for (;;) {
+            const int index = free.pop();
+            if (index < 0) {
+                return;
+            }
+            Buffer& b = buffers[index];
+            if (!in(b.bytes.data(), capacity, b.length)) {
+                fail(StreamStatus::ReadError);
+                return;
+            }
+            const bool last = b.length < capacity;
+            b.last = last;
+            filled.push(index);
+            if (last) {
+                return;
+            }
+        }
+    }
+
+    void write_loop(const StreamWriter& out) {
+        for (;;) {
+            const int index = done.pop();
+            if (index < 0) {
+                return;
+            }
+            Buffer& b = buffers[index];
+            if (b.length > 0 && !out(b.bytes.data(), b.length)) {
+                fail(StreamStatus::WriteError);
+                return;
+            }
+            if (b.last) {
+                return;
+            }
+            free.push(index);
+        }
+    }
+};
+
+void chunk_nonce(std::uint8_t nonce[csprng::Aes256Gcm::NONCE_BYTES], const StreamKey& key, std::uint64_t chunk, bool last) {
+    std::memcpy(nonce, key.nonce_prefix, StreamKey::NONCE_PREFIX_BYTES);
+    for (int i = 0; i < 4; ++i) {
+        nonce[StreamKey::NONCE_PREFIX_BYTES + i] = static_cast<std::uint8_t>(chunk >> (24 - 8 * i));
+    }
+    nonce[StreamKey::NONCE_PREFIX_BYTES + 4] = last ? 1 : 0;
+}
+
+} // namespace
+
+const char* stream_status_name(StreamStatus status) {
+    switch (status) {
+    case StreamStatus::Ok:
+        return "ok";
+    case StreamStatus::ReadError:
+        return "read error";
+    case StreamStatus::WriteError:
+        return "write error";
+    case StreamStatus::BadHeader:
+        return "bad header";
+    case StreamStatus::BadKey:
+        return "bad key";
+    case StreamStatus::Corrupt:
+        return "corrupt";
+    case StreamStatus::Truncated:
+        return "truncated";
+    case StreamStatus::TooLong:
+        return "too long";
+    }
+    return "unknown";
+}
+
+StreamReader file_reader(std::FILE* file) {
+    return [file](std::uint8_t* out, std::size_t capacity, std::size_t& length) {
+        length = 0;
+        while (length < capacity) {
+            const std::size_t got = std::fread(out + length, 1, capacity - length, file);
+            length += got;
+            if (got == 0) {
+                return std::ferror(file) == 0;
+            }
+        }
+        return true;
+    };
+}
+
+StreamWriter file_writer(std::FILE* file) {
+    return [file](const std::uint8_t* data, std::size_t length) { return std::fwrite(data, 1, length, file) == length; };
+}
+
+void write_stream_preamble(std::uint8_t* out, std::size_t n, std::size_t chunk_bytes) {
+    std::memcpy(out, STREAM_MAGIC, sizeof(STREAM_MAGIC));
+    store_le32(out + 8, static_cast<std::uint32_t>(n));
+    store_le32(out + 12, static_cast<std::uint32_t>(chunk_bytes));
+}
+
+std::size_t read_stream_preamble(const std::uint8_t* in, std::size_t n) {
+    if (std::memcmp(in, STREAM_MAGIC, sizeof(STREAM_MAGIC)) != 0 || load_le32(in + 8) != n) {
+        return 0;
+    }
+    const std::size_t chunk_bytes = load_le32(in + 12);
+    return chunk_bytes <= STREAM_MAX_CHUNK ? chunk_bytes : 0;
+}
+
+StreamKey derive_stream_key(const std::uint8_t* header, std::size_t header_bytes, const std::uint8_t* seed, std::size_t seed_bytes) {
+    std::vector<std::uint8_t> input(header, header + header_bytes);
+    input.insert(input.end(), seed, seed + seed_bytes);
+    std::uint8_t material[sizeof(StreamKey::key) + StreamKey::NONCE_PREFIX_BYTES];
+    csprng::shake256(material, sizeof(material), input.data(), input.size());
+    std::fill(input.begin(), input.end(), 0);
+
+    StreamKey key;
+    std::memcpy(key.key, material, sizeof(key.key));
+    std::memcpy(key.nonce_prefix, material + sizeof(key.key), sizeof(key.nonce_prefix));
+    std::memset(material, 0, sizeof(material));
+    return key;
+}
+
+StreamStatus seal_chunks(const StreamKey& key, std::size_t chunk_bytes, const StreamReader& in, const StreamWriter& out) {
+    if (chunk_bytes == 0 || chunk_bytes > STREAM_MAX_CHUNK) {
+        return StreamStatus::BadHeader;
+    }
+    const csprng::Aes256Gcm gcm(key.key);
+    Pipeline pipeline(chunk_bytes);
+    return pipeline.run(in, out, [&](Pipeline::Buffer& b, std::uint64_t chunk) {
+        std::uint8_t nonce[csprng::Aes256Gcm::NONCE_BYTES];
+        chunk_nonce(nonce, key, chunk, b.last);
+        gcm.seal(nonce, nullptr, 0, b.bytes.data(), b.bytes.data(), b.length, b.bytes.data() + b.length);
+        b.length += TAG_BYTES;
+        return StreamStatus::Ok;
+    });
+}
+
+StreamStatus open_chunks(const StreamKey& key, std::size_t chunk_bytes, const StreamReader& in, const StreamWriter& out) {
+    if (chunk_bytes == 0 || chunk_bytes > STREAM_MAX_CHUNK) {
+        return StreamStatus::BadHeader;
+    }
+    const csprng::Aes256Gcm gcm(key.key);
+    Pipeline pipeline(chunk_bytes + TAG_BYTES);
+    return pipeline.run(in, out, [&](Pipeline::Buffer& b, std::uint64_t chunk) {
+        // A sealed stream always ends in a short chunk of at least a tag
+        if (b.length < TAG_BYTES) {
+            return StreamStatus::Truncated;
+        }
+        std::uint8_t nonce[csprng::Aes256Gcm::NONCE_BYTES];
+        chunk_nonce(nonce, key, chunk, b.last);
+        b.length -= TAG_BYTES;
+        if (!gcm.open(nonce, nullptr, 0, b.bytes.data(), b.bytes.data(), b.length, b.bytes.data() + b.length)) {
+            return StreamStatus::Corrupt;
+        }
+        return StreamStatus::Ok;
+    });
+}
+
+} // namespace giophantus